@@ -0,0 +1,87 @@
+#include "admissioncontroller.h"
+#include <QDateTime>
+#include <QFile>
+#include <QSettings>
+#include <QThread>
+
+namespace {
+const qint64 SAMPLE_TTL_MS = 1000;
+}
+
+AdmissionController::AdmissionController()
+    : m_sampledAtMs(-1)
+{
+    QSettings settings;
+    settings.beginGroup("admission");
+    m_maxLoadPerCpu = settings.value("maxLoadPerCpu", 1.5).toDouble();
+    m_maxCpuPressure = settings.value("maxCpuPressure", 40.0).toDouble();
+    m_maxMemoryPressure = settings.value("maxMemoryPressure", 20.0).toDouble();
+    m_maxDeferralMs = settings.value("maxDeferralMinutes", 60).toLongLong() * 60000;
+    settings.endGroup();
+}
+
+AdmissionController::Sample AdmissionController::sample()
+{
+    const qint64 nowMs = QDateTime::currentMSecsSinceEpoch();
+    if (m_sampledAtMs < 0 || nowMs - m_sampledAtMs >= SAMPLE_TTL_MS) {
+        m_sample.loadPerCpu = readLoadPerCpu();
+        m_sample.cpuPressure = readPressure("/proc/pressure/cpu");
+        m_sample.memoryPressure = readPressure("/proc/pressure/memory");
+        m_sampledAtMs = nowMs;
+    }
+    return m_sample;
+}
+
+bool AdmissionController::isBusy(QString* reason)
+{
+    const Sample s = sample();
+    QString why;
+    if (m_maxLoadPerCpu > 0 && s.loadPerCpu > m_maxLoadPerCpu) {
+        why = QString("load %1 per CPU").arg(s.loadPerCpu, 0, 'f', 2);
+    } else if (m_maxCpuPressure > 0 && s.cpuPressure > m_maxCpuPressure) {
+        why = QString("CPU pressure %1%").arg(s.cpuPressure, 0, 'f', 1);
+    } else if (m_maxMemoryPressure > 0 && s.memoryPressure > m_maxMemoryPressure) {
+        why = QString("memory pressure %1%").arg(s.memoryPressure, 0, 'f', 1);
+    }
+    if (reason) {
+        *reason = why;
+    }
+    return !why.isEmpty();
+}
+
+double AdmissionController::readLoadPerCpu()
+{
+    // "0.52 0.58 0.59 1/467 12345": the first field is the 1-minute average
+    QFile file("/proc/loadavg");
+    if (!file.open(QIODevice::ReadOnly)) {
+        return -1;
+    }
+    bool ok = false;
+    double load = file.readLine().split(' ').value(0).toDouble(&ok);
+    if (!ok) {
+        return -1;
+    }
+    return load / qMax(1, QThread::idealThreadCount());
+}
+
+double AdmissionController::readPressure(const QString& path)
+{
+    // "some avg10=1.23 avg60=0.80 avg300=0.41 total=123456"
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return -1;
+    }
+    const QByteArray line = file.readLine();
+    if (!line.startsWith("some ")) {
+        return -1;
+    }
+    const QList<QByteArray> fields = line.split(' ');
+    for (const QByteArray& field : fields) {
+        if (field.startsWith("avg10=")) {
+            bool ok = false;
+            double value = field.mid(6).toDouble(&ok);
+            return ok ? value : -1;
+        }
+    }
+    return -1;
+}
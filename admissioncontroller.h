@@ -0,0 +1,42 @@
+#ifndef ADMISSIONCONTROLLER_H
+#define ADMISSIONCONTROLLER_H
+
+#include <QString>
+#include <QtGlobal>
+
+// Decides whether low-priority jobs may start now, from how busy the host
+// is: the 1-minute load average per CPU (/proc/loadavg) and the share of
+// time tasks stalled on CPU and memory (Linux PSI, /proc/pressure/*, the
+// "some avg10" figure). Readings are cached briefly so a burst of due
+// jobs costs one read. Where the files don't exist the host never counts
+// as busy. Limits come from the [admission] group of the app settings.
+class AdmissionController
+{
+public:
+    struct Sample {
+        double loadPerCpu = -1;        // -1 where not available
+        double cpuPressure = -1;       // Percent of the last 10 s
+        double memoryPressure = -1;
+    };
+
+    AdmissionController();
+
+    // True if the host is over a limit; reason says which one
+    bool isBusy(QString* reason = nullptr);
+    Sample sample();
+
+    qint64 maxDeferralMs() const { return m_maxDeferralMs; }
+
+private:
+    static double readLoadPerCpu();
+    static double readPressure(const QString& path);
+
+    double m_maxLoadPerCpu;
+    double m_maxCpuPressure;
+    double m_maxMemoryPressure;
+    qint64 m_maxDeferralMs;
+    Sample m_sample;
+    qint64 m_sampledAtMs;
+};
+
+#endif // ADMISSIONCONTROLLER_H
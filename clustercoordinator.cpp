@@ -0,0 +1,249 @@
+#include "clustercoordinator.h"
+#include "controlprotocol.h"
+#include "schedulerclock.h"
+#include <QCoreApplication>
+#include <QCryptographicHash>
+#include <QDir>
+#include <QFile>
+#include <QSaveFile>
+#include <QSet>
+#include <QSysInfo>
+#include <QtEndian>
+#include <algorithm>
+
+namespace {
+const int HEARTBEAT_INTERVAL_MS = 5000;
+const qint64 NODE_TTL_MS = 20000;          // A node is gone after missing ~4 heartbeats
+const qint64 CLOCK_SKEW_MS = 60000;        // How far apart node clocks may be for lease expiry
+const int VIRTUAL_NODES = 64;              // Ring points per node, evens out the split
+const int LEASE_SWEEP_EVERY = 12;          // Heartbeats between lease sweeps (~1 minute)
+const QString NODE_SUFFIX = ".node";
+const QString LEASE_SUFFIX = ".lease";
+}
+
+ClusterCoordinator::ClusterCoordinator(const QString& directory, const QString& nodeId, QObject *parent)
+    : QObject(parent)
+    , m_nodesDir(QDir(directory).filePath("nodes"))
+    , m_leasesDir(QDir(directory).filePath("leases"))
+    , m_nodeId(sanitizeNodeId(nodeId))
+    , m_clock(SchedulerClock::system())
+    , m_heartbeatTimer(new QTimer(this))
+    , m_heartbeatCount(0)
+{
+    QDir().mkpath(m_nodesDir);
+    QDir().mkpath(m_leasesDir);
+
+    connect(m_heartbeatTimer, &QTimer::timeout, this, &ClusterCoordinator::heartbeat);
+    m_heartbeatTimer->start(HEARTBEAT_INTERVAL_MS);
+    heartbeat();
+}
+
+ClusterCoordinator::~ClusterCoordinator()
+{
+    // Leave the ring right away instead of waiting for the TTL
+    QFile::remove(QDir(m_nodesDir).filePath(m_nodeId + NODE_SUFFIX));
+}
+
+void ClusterCoordinator::setClock(const SchedulerClock* clock)
+{
+    m_clock = clock ? clock : SchedulerClock::system();
+}
+
+QString ClusterCoordinator::defaultNodeId()
+{
+    return QString("%1-%2").arg(QSysInfo::machineHostName()).arg(QCoreApplication::applicationPid());
+}
+
+quint64 ClusterCoordinator::ringHash(const QString& key)
+{
+    // Must agree across processes and hosts, so qHash (seeded per process) won't do
+    QByteArray digest = QCryptographicHash::hash(key.toUtf8(), QCryptographicHash::Md5);
+    return qFromBigEndian<quint64>(reinterpret_cast<const uchar*>(digest.constData()));
+}
+
+bool ClusterCoordinator::ownsJob(const QString& jobId) const
+{
+    if (m_ring.isEmpty()) {
+        return true;
+    }
+    auto it = m_ring.lowerBound(ringHash(jobId));
+    if (it == m_ring.constEnd()) {
+        it = m_ring.constBegin();
+    }
+    return it.value() == m_nodeId;
+}
+
+QString ClusterCoordinator::leasePath(const QString& jobId, qint64 slot) const
+{
+    // Named by a hash, so any job id makes a distinct, valid file name; the
+    // id itself is kept inside the file
+    const QByteArray digest = QCryptographicHash::hash(jobId.toUtf8(), QCryptographicHash::Sha1).toHex();
+    return QDir(m_leasesDir).filePath(QString("%1.%2%3").arg(QString::fromLatin1(digest)).arg(slot).arg(LEASE_SUFFIX));
+}
+
+bool ClusterCoordinator::tryAcquireLease(const QString& jobId, qint64 slot, qint64 ttlMs)
+{
+    // O_EXCL create is atomic on local file systems and NFSv3+. The content
+    // follows in the same small write; a reader that finds the file still
+    // empty treats the lease as held.
+    QFile lease(leasePath(jobId, slot));
+    if (!lease.open(QIODevice::WriteOnly | QIODevice::NewOnly)) {
+        return false;
+    }
+    const qint64 expires = m_clock->nowMs() + ttlMs;
+    lease.write(QString("%1 %2\n%3\n").arg(m_nodeId).arg(expires).arg(jobId).toUtf8());
+    lease.close();
+    return true;
+}
+
+bool ClusterCoordinator::writeLease(const QString& path, const QString& jobId, qint64 expiresMs, bool done)
+{
+    // Replaced by rename, so readers see the old or the new content whole.
+    // First line: holder, expiry and "done"; second line: the job id.
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly)) {
+        return false;
+    }
+    file.write(QString("%1 %2%3\n%4\n").arg(m_nodeId).arg(expiresMs).arg(QString(done ? " done" : ""), jobId).toUtf8());
+    return file.commit();
+}
+
+void ClusterCoordinator::finishLease(const QString& jobId, qint64 slot)
+{
+    const QString path = leasePath(jobId, slot);
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return;   // Already swept
+    }
+    const QList<QByteArray> fields = file.readAll().split('\n').value(0).trimmed().split(' ');
+    file.close();
+    if (fields.size() >= 2 && fields[0] == m_nodeId.toUtf8()) {
+        writeLease(path, jobId, fields[1].toLongLong(), true);
+    }
+}
+
+void ClusterCoordinator::heartbeat()
+{
+    const qint64 now = m_clock->nowMs();
+
+    QSaveFile self(QDir(m_nodesDir).filePath(m_nodeId + NODE_SUFFIX));
+    if (self.open(QIODevice::WriteOnly)) {
+        self.write(QByteArray::number(now));
+        self.commit();
+    }
+
+    QStringList nodes;
+    QSet<QString> present;
+    const QStringList entries = QDir(m_nodesDir).entryList(QStringList() << "*" + NODE_SUFFIX, QDir::Files);
+    for (const QString& entry : entries) {
+        const QString node = entry.left(entry.size() - NODE_SUFFIX.size());
+        if (node == m_nodeId) {
+            nodes.append(node);
+            continue;
+        }
+        QFile file(QDir(m_nodesDir).filePath(entry));
+        if (!file.open(QIODevice::ReadOnly)) {
+            continue;
+        }
+        const qint64 beat = file.readAll().trimmed().toLongLong();
+        present.insert(node);
+
+        auto peer = m_peers.find(node);
+        if (peer == m_peers.end()) {
+            // First sight: only the writer's clock to go by, so allow for skew.
+            // A stale file stays dead until its heartbeat moves.
+            Peer first;
+            first.beat = beat;
+            first.changedMs = qAbs(now - beat) < NODE_TTL_MS + CLOCK_SKEW_MS ? now : now - NODE_TTL_MS;
+            peer = m_peers.insert(node, first);
+        } else if (beat != peer->beat) {
+            peer->beat = beat;
+            peer->changedMs = now;
+        }
+        if (now - peer->changedMs < NODE_TTL_MS) {
+            nodes.append(node);
+        }
+    }
+    for (auto it = m_peers.begin(); it != m_peers.end();) {
+        if (present.contains(it.key())) {
+            ++it;
+        } else {
+            it = m_peers.erase(it);
+        }
+    }
+    nodes.sort();
+
+    const bool nodeLeft = nodes.size() < m_nodes.size()
+        || std::any_of(m_nodes.cbegin(), m_nodes.cend(), [&nodes](const QString& n) { return !nodes.contains(n); });
+    if (nodes != m_nodes) {
+        m_nodes = nodes;
+        rebuildRing();
+        emit membershipChanged(m_nodes);
+    }
+
+    // Right away when someone left, so their slots are picked up promptly
+    if (nodeLeft || ++m_heartbeatCount % LEASE_SWEEP_EVERY == 0) {
+        sweepLeases();
+    }
+}
+
+void ClusterCoordinator::rebuildRing()
+{
+    m_ring.clear();
+    for (const QString& node : m_nodes) {
+        for (int i = 0; i < VIRTUAL_NODES; ++i) {
+            m_ring.insert(ringHash(QString("%1#%2").arg(node).arg(i)), node);
+        }
+    }
+}
+
+void ClusterCoordinator::sweepLeases()
+{
+    const qint64 now = m_clock->nowMs();
+    QDir dir(m_leasesDir);
+    const QStringList leases = dir.entryList(QStringList() << "*" + LEASE_SUFFIX, QDir::Files);
+    for (const QString& name : leases) {
+        const QString path = dir.filePath(name);
+        QFile file(path);
+        if (!file.open(QIODevice::ReadOnly)) {
+            continue;
+        }
+        const QList<QByteArray> lines = file.readAll().split('\n');
+        file.close();
+        const QList<QByteArray> fields = lines.value(0).trimmed().split(' ');
+        const QString jobId = QString::fromUtf8(lines.value(1));
+        if (fields.size() < 2 || jobId.isEmpty()) {
+            continue;   // Still being written
+        }
+        const QString holder = QString::fromUtf8(fields[0]);
+        const qint64 expires = fields[1].toLongLong();
+        const bool done = fields.size() > 2 && fields[2] == "done";
+        if (expires + CLOCK_SKEW_MS < now) {
+            file.remove();
+            continue;
+        }
+        if (done || holder == m_nodeId || m_nodes.contains(holder)) {
+            continue;
+        }
+
+        // The holder left before its run finished. The job's new owner takes
+        // the slot over; renaming the lease aside is atomic, so of several
+        // nodes sweeping at once only one gets it.
+        const QString base = name.left(name.size() - LEASE_SUFFIX.size());
+        const int dot = base.lastIndexOf('.');
+        if (dot <= 0) {
+            continue;
+        }
+        const qint64 slot = base.mid(dot + 1).toLongLong();
+        if (!ownsJob(jobId)) {
+            continue;
+        }
+        const QString claimed = path + "." + m_nodeId;
+        if (!QFile::rename(path, claimed)) {
+            continue;
+        }
+        writeLease(path, jobId, expires, false);
+        QFile::remove(claimed);
+        emit slotOrphaned(jobId, slot, holder);
+    }
+}
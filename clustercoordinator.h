@@ -0,0 +1,76 @@
+#ifndef CLUSTERCOORDINATOR_H
+#define CLUSTERCOORDINATOR_H
+
+#include <QObject>
+#include <QHash>
+#include <QList>
+#include <QMap>
+#include <QStringList>
+#include <QTimer>
+
+class SchedulerClock;
+
+// Coordinates several scheduler instances that share one config directory
+// (local disk or NFS). Each instance publishes a heartbeat file; the live
+// nodes form a consistent-hash ring that assigns every job to one owner.
+// Before a run the owner claims a lease file for that job's time slot with
+// an exclusive create, so a slot is executed at most once even while
+// membership is changing. A lease is marked done when its run ends; if the
+// holder leaves the cluster first, the job's new owner takes the lease over
+// and runs the slot late (slotOrphaned) rather than losing it.
+//
+// Files are only ever created exclusively or replaced by rename, so no
+// reader sees one half-written. Clocks are never compared across nodes for
+// liveness: a peer is alive while its heartbeat keeps changing as seen by
+// this node's clock. Lease expiry does use the writer's clock, with a
+// margin for skew.
+class ClusterCoordinator : public QObject
+{
+    Q_OBJECT
+
+public:
+    ClusterCoordinator(const QString& directory, const QString& nodeId, QObject *parent = nullptr);
+    ~ClusterCoordinator();
+
+    QString nodeId() const { return m_nodeId; }
+    QStringList liveNodes() const { return m_nodes; }
+    void setClock(const SchedulerClock* clock);   // Lease expiry and heartbeats use scheduler time
+
+    bool ownsJob(const QString& jobId) const;
+    bool tryAcquireLease(const QString& jobId, qint64 slot, qint64 ttlMs);
+    void finishLease(const QString& jobId, qint64 slot);   // The run holding this lease is over
+
+    static QString defaultNodeId();
+
+signals:
+    void membershipChanged(const QStringList& nodes);
+    void slotOrphaned(const QString& jobId, qint64 slot, const QString& formerHolder);   // Taken over; run it now
+
+private slots:
+    void heartbeat();
+
+private:
+    // A peer's last heartbeat value, and when it last changed on our clock
+    struct Peer {
+        qint64 beat = 0;
+        qint64 changedMs = 0;
+    };
+
+    static quint64 ringHash(const QString& key);
+    QString leasePath(const QString& jobId, qint64 slot) const;
+    bool writeLease(const QString& path, const QString& jobId, qint64 expiresMs, bool done);
+    void rebuildRing();
+    void sweepLeases();
+
+    QString m_nodesDir;
+    QString m_leasesDir;
+    QString m_nodeId;
+    const SchedulerClock* m_clock;
+    QTimer* m_heartbeatTimer;
+    QStringList m_nodes;
+    QHash<QString, Peer> m_peers;
+    QMap<quint64, QString> m_ring;   // Ring position -> node id
+    int m_heartbeatCount;
+};
+
+#endif // CLUSTERCOORDINATOR_H
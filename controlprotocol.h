@@ -0,0 +1,69 @@
+#ifndef CONTROLPROTOCOL_H
+#define CONTROLPROTOCOL_H
+
+#include <QString>
+#include <QByteArray>
+
+// Line-based protocol spoken over the local socket by cron-gui and cron-gui-ctl.
+//
+// The client sends a single command line:
+//   show            - bring the main window to the front (no reply)
+//   export          - reply with one JSON job object per line, then "."
+//   import          - followed by one JSON job object per line and a final "."
+//                     line; the whole stream is applied as one batch and the
+//                     reply is "ok <jobs> <errors>", any "error ..." lines, then "."
+//   metrics         - reply with one JSON object of scheduler metrics, then "."
+//   stall-gui <ms>  - block the GUI thread for a while (diagnostics: the
+//                     scheduler must keep firing on time meanwhile); refused
+//                     unless diagnostics/allowStallGui is set
+//   bench-scan [n]  - time n scheduler scans both ways; reply with one JSON
+//                     object of per-job timings and sizes, then "."
+//   bench-spawn [n] - launch a no-op program n times through each process
+//                     launcher backend; reply with one JSON object of
+//                     spawns per second and start latency, then "."
+//   trace <file|off> - start recording job runs as Chrome trace events to an
+//                     absolute file path, or stop; reply with one JSON object
+//                     of the recording state (or an "error ..." line), then "."
+//   search <from> <to> <limit> <text>
+//                   - find runs whose output has every word of text and that
+//                     finished between two epoch-ms times (0 = open); reply
+//                     with one JSON object per run, newest first, then "."
+//   output <run>    - reply with one JSON object holding a stored run's
+//                     details and full output (run numbers come from search),
+//                     or an "error ..." line, then "."
+const QString CONTROL_SERVER_NAME = "CronGUI_LocalServer";
+
+// Node ids end up in file and socket names; anything but letters, digits,
+// '-', '_' and inner dots becomes '_'
+inline QString sanitizeNodeId(const QString& nodeId)
+{
+    QString id = nodeId.left(64);
+    for (int i = 0; i < id.size(); ++i) {
+        const QChar c = id.at(i);
+        const bool plain = (c.unicode() < 128 && c.isLetterOrNumber()) || c == '-' || c == '_' || (c == '.' && i > 0);
+        if (!plain) {
+            id[i] = '_';
+        }
+    }
+    return id;
+}
+
+// Clustered instances on one host each listen under their node id
+inline QString controlServerName(const QString& nodeId)
+{
+    return nodeId.isEmpty() ? CONTROL_SERVER_NAME : CONTROL_SERVER_NAME + "_" + nodeId;
+}
+
+const QByteArray CONTROL_CMD_SHOW = "show";
+const QByteArray CONTROL_CMD_EXPORT = "export";
+const QByteArray CONTROL_CMD_IMPORT = "import";
+const QByteArray CONTROL_CMD_METRICS = "metrics";
+const QByteArray CONTROL_CMD_STALL_GUI = "stall-gui";
+const QByteArray CONTROL_CMD_BENCH_SCAN = "bench-scan";
+const QByteArray CONTROL_CMD_BENCH_SPAWN = "bench-spawn";
+const QByteArray CONTROL_CMD_TRACE = "trace";
+const QByteArray CONTROL_CMD_SEARCH = "search";
+const QByteArray CONTROL_CMD_OUTPUT = "output";
+const QByteArray CONTROL_END_OF_DATA = ".";
+
+#endif // CONTROLPROTOCOL_H
@@ -0,0 +1,310 @@
+#include "controlserver.h"
+#include "controlprotocol.h"
+#include "processstats.h"
+#include "cronmanager.h"
+#include "cronimporter.h"
+#include "outputindex.h"
+#include "spawnbenchmark.h"
+#include "loopwatchdog.h"
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QPointer>
+#include <QSettings>
+
+namespace {
+const int MAX_REPORTED_ERRORS = 100;
+const int SPAWN_BENCH_CONCURRENCY = 8;   // Runs in flight at once, like a busy minute
+const int MAX_LINE_BYTES = 1024 * 1024;  // Longest line a client may send; one job record fits easily
+}
+
+ControlServer::ControlServer(CronManager* manager, QObject *parent)
+    : QObject(parent)
+    , m_manager(manager)
+    , m_server(new QLocalServer(this))
+{
+    connect(m_server, &QLocalServer::newConnection, this, &ControlServer::onNewConnection);
+}
+
+bool ControlServer::listen(const QString& name)
+{
+    QLocalServer::removeServer(name);  // Clean up any stale server
+    return m_server->listen(name);
+}
+
+void ControlServer::onNewConnection()
+{
+    while (QLocalSocket* socket = m_server->nextPendingConnection()) {
+        m_sessions.insert(socket, Session());
+
+        connect(socket, &QLocalSocket::readyRead, this, [this, socket]() {
+            readLines(socket);
+        });
+        connect(socket, &QLocalSocket::disconnected, this, [this, socket]() {
+            // Older instances send "show" without a trailing newline
+            Session session = m_sessions.take(socket);
+            if (session.command.isEmpty() && session.buffer.trimmed() == CONTROL_CMD_SHOW) {
+                emit showRequested();
+            }
+            socket->deleteLater();
+        });
+
+        readLines(socket);
+    }
+}
+
+void ControlServer::readLines(QLocalSocket* socket)
+{
+    auto it = m_sessions.find(socket);
+    if (it == m_sessions.end()) {
+        return;
+    }
+
+    Session& session = it.value();
+    if (session.discarding) {
+        socket->readAll();
+        return;
+    }
+    session.buffer.append(socket->readAll());
+
+    int start = 0;
+    int newline;
+    while ((newline = session.buffer.indexOf('\n', start)) >= 0) {
+        QByteArray line = session.buffer.mid(start, newline - start);
+        if (line.endsWith('\r')) {
+            line.chop(1);
+        }
+        start = newline + 1;
+        handleLine(socket, session, line);
+        if (!m_sessions.contains(socket)) {
+            return;
+        }
+    }
+    session.buffer.remove(0, start);
+    
+    // A client that never ends its line would otherwise grow the buffer forever
+    if (session.buffer.size() > MAX_LINE_BYTES) {
+        session.buffer.clear();
+        session.discarding = true;
+        socket->write("error Line longer than " + QByteArray::number(MAX_LINE_BYTES) + " bytes\n"
+                      + CONTROL_END_OF_DATA + "\n");
+        socket->disconnectFromServer();
+    }
+}
+
+void ControlServer::handleLine(QLocalSocket* socket, Session& session, const QByteArray& line)
+{
+    LoopWatchdog::Scope scope("ControlServer::handleLine");
+    if (session.command.isEmpty()) {
+        QList<QByteArray> words = line.trimmed().split(' ');
+        session.command = words.first();
+        if (session.command == CONTROL_CMD_SHOW) {
+            emit showRequested();
+            socket->disconnectFromServer();
+        } else if (session.command == CONTROL_CMD_EXPORT) {
+            sendExport(socket);
+        } else if (session.command == CONTROL_CMD_METRICS) {
+            sendMetrics(socket);
+        } else if (session.command == CONTROL_CMD_BENCH_SCAN) {
+            // Sliced between real work; the reply goes out when it is done
+            QPointer<QLocalSocket> client = socket;
+            m_manager->benchmarkScan(words.value(1, "100").toInt(), [client](const QJsonObject& result) {
+                if (client) {
+                    client->write(QJsonDocument(result).toJson(QJsonDocument::Compact));
+                    client->write("\n" + CONTROL_END_OF_DATA + "\n");
+                    client->disconnectFromServer();
+                }
+            });
+        } else if (session.command == CONTROL_CMD_BENCH_SPAWN) {
+            sendSpawnBenchmark(socket, words.value(1, "500").toInt());
+        } else if (session.command == CONTROL_CMD_TRACE) {
+            // The path is the rest of the line; it may contain spaces
+            QString path = QString::fromUtf8(line.trimmed().mid(CONTROL_CMD_TRACE.size())).trimmed();
+            if (path == "off") {
+                path.clear();
+            }
+            if (m_manager->setTraceFile(path)) {
+                QJsonObject state;
+                state["tracing"] = !m_manager->traceFile().isEmpty();
+                state["file"] = m_manager->traceFile();
+                socket->write(QJsonDocument(state).toJson(QJsonDocument::Compact) + "\n");
+            } else {
+                socket->write("error Cannot write " + path.toUtf8() + "\n");
+            }
+            socket->write(CONTROL_END_OF_DATA + "\n");
+            socket->disconnectFromServer();
+        } else if (session.command == CONTROL_CMD_SEARCH) {
+            sendSearch(socket, line.trimmed());
+        } else if (session.command == CONTROL_CMD_OUTPUT) {
+            sendRunOutput(socket, words.value(1).toUInt());
+        } else if (session.command == CONTROL_CMD_STALL_GUI) {
+            // Opt-in only: anyone who can reach the socket could freeze the window
+            if (QSettings().value("diagnostics/allowStallGui", false).toBool()) {
+                emit stallGuiRequested(words.value(1).toInt());
+            } else {
+                socket->write("error stall-gui is disabled; set allowStallGui=true in the "
+                              "[diagnostics] section of the settings file\n");
+            }
+            socket->write(CONTROL_END_OF_DATA + "\n");
+            socket->disconnectFromServer();
+        } else if (session.command != CONTROL_CMD_IMPORT) {
+            socket->write("error Unknown command: " + session.command + "\n" + CONTROL_END_OF_DATA + "\n");
+            socket->disconnectFromServer();
+        }
+        return;
+    }
+
+    if (session.command == CONTROL_CMD_IMPORT) {
+        if (line == CONTROL_END_OF_DATA) {
+            finishImport(socket, session);
+        } else {
+            handleImportRecord(session, line);
+        }
+    }
+}
+
+void ControlServer::handleImportRecord(Session& session, const QByteArray& line)
+{
+    ++session.record;
+    if (line.trimmed().isEmpty()) {
+        return;
+    }
+
+    CronJob job;
+    QString error;
+    if (CronImporter::parseJsonJob(line, job, error)) {
+        session.jobs.append(job);
+        return;
+    }
+
+    ++session.errorCount;
+    if (session.errors.size() < MAX_REPORTED_ERRORS) {
+        session.errors.append(QString("error %1: %2").arg(session.record).arg(error));
+    }
+}
+
+void ControlServer::finishImport(QLocalSocket* socket, Session& session)
+{
+    m_manager->importJobs(session.jobs);
+
+    QByteArray reply = QString("ok %1 %2\n").arg(session.jobs.size()).arg(session.errorCount).toUtf8();
+    for (const QString& error : session.errors) {
+        reply += error.toUtf8() + "\n";
+    }
+    reply += CONTROL_END_OF_DATA + "\n";
+
+    session.jobs.clear();
+    session.errors.clear();
+
+    // May drop the session synchronously; nothing below may touch it
+    socket->write(reply);
+    socket->disconnectFromServer();
+}
+
+void ControlServer::sendExport(QLocalSocket* socket)
+{
+    const QVector<CronJob>& jobs = m_manager->getJobs();
+    for (int i : m_manager->jobOrder()) {
+        socket->write(QJsonDocument(jobs[i].toJson()).toJson(QJsonDocument::Compact));
+        socket->write("\n");
+    }
+    socket->write(CONTROL_END_OF_DATA + "\n");
+    socket->disconnectFromServer();
+}
+
+void ControlServer::sendMetrics(QLocalSocket* socket)
+{
+    QJsonObject metrics = m_manager->stats().toJson();
+    metrics["residentBytes"] = ProcessStats::residentBytes();
+    socket->write(QJsonDocument(metrics).toJson(QJsonDocument::Compact));
+    socket->write("\n" + CONTROL_END_OF_DATA + "\n");
+    socket->disconnectFromServer();
+}
+
+void ControlServer::sendSpawnBenchmark(QLocalSocket* socket, int runs)
+{
+    // Runs on this thread's event loop next to real jobs; the reply goes
+    // out when the last backend is done, if the client is still there
+    QPointer<QLocalSocket> client = socket;
+    SpawnBenchmark* benchmark = new SpawnBenchmark(runs, SPAWN_BENCH_CONCURRENCY, this);
+    connect(benchmark, &SpawnBenchmark::finished, this, [client, benchmark](const QJsonObject& result) {
+        benchmark->deleteLater();
+        if (client) {
+            client->write(QJsonDocument(result).toJson(QJsonDocument::Compact));
+            client->write("\n" + CONTROL_END_OF_DATA + "\n");
+            client->disconnectFromServer();
+        }
+    });
+    benchmark->start();
+}
+
+void ControlServer::sendSearch(QLocalSocket* socket, const QByteArray& line)
+{
+    // search <from> <to> <limit> <text>; the text may contain spaces
+    const QList<QByteArray> words = line.split(' ');
+    const qint64 fromMs = words.value(1).toLongLong();
+    const qint64 toMs = words.value(2).toLongLong();
+    const int limit = words.value(3).toInt();
+    const QString text = QString::fromUtf8(words.mid(4).join(' ')).trimmed();
+    if (text.isEmpty() || limit <= 0) {
+        socket->write("error search needs a limit and some text\n" + CONTROL_END_OF_DATA + "\n");
+        socket->disconnectFromServer();
+        return;
+    }
+
+    // Answered once the index thread is done; the client may be gone by then
+    QPointer<QLocalSocket> client = socket;
+    OutputIndex* index = m_manager->outputIndex();
+    QMetaObject::invokeMethod(index, [this, index, client, text, fromMs, toMs, limit]() {
+        const QVector<OutputIndex::Hit> hits = index->search(text, fromMs, toMs, limit);
+        QMetaObject::invokeMethod(this, [this, client, hits]() {
+            if (!client) {
+                return;
+            }
+            for (const OutputIndex::Hit& hit : hits) {
+                const CronJob* job = m_manager->getJob(hit.jobId);
+                QJsonObject obj;
+                obj["run"] = qint64(hit.run);
+                obj["job"] = hit.jobId;
+                obj["name"] = job ? job->name : QString();
+                obj["finishedMs"] = hit.finishedMs;
+                obj["success"] = hit.success;
+                obj["snippet"] = hit.snippet;
+                client->write(QJsonDocument(obj).toJson(QJsonDocument::Compact) + "\n");
+            }
+            client->write(CONTROL_END_OF_DATA + "\n");
+            client->disconnectFromServer();
+        }, Qt::QueuedConnection);
+    }, Qt::QueuedConnection);
+}
+
+void ControlServer::sendRunOutput(QLocalSocket* socket, quint32 run)
+{
+    // Read on the index thread; only the block holding the run is inflated
+    QPointer<QLocalSocket> client = socket;
+    OutputIndex* index = m_manager->outputIndex();
+    QMetaObject::invokeMethod(index, [this, index, client, run]() {
+        OutputIndex::Hit info;
+        QString output;
+        const bool found = index->runOutput(run, info, output);
+        QMetaObject::invokeMethod(this, [this, client, run, found, info, output]() {
+            if (!client) {
+                return;
+            }
+            if (found) {
+                const CronJob* job = m_manager->getJob(info.jobId);
+                QJsonObject obj;
+                obj["run"] = qint64(run);
+                obj["job"] = info.jobId;
+                obj["name"] = job ? job->name : QString();
+                obj["finishedMs"] = info.finishedMs;
+                obj["success"] = info.success;
+                obj["output"] = output;
+                client->write(QJsonDocument(obj).toJson(QJsonDocument::Compact) + "\n");
+            } else {
+                client->write("error No stored output for run " + QByteArray::number(run) + "\n");
+            }
+            client->write(CONTROL_END_OF_DATA + "\n");
+            client->disconnectFromServer();
+        }, Qt::QueuedConnection);
+    }, Qt::QueuedConnection);
+}
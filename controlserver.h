@@ -0,0 +1,61 @@
+#ifndef CONTROLSERVER_H
+#define CONTROLSERVER_H
+
+#include <QObject>
+#include <QHash>
+#include <QVector>
+#include <QStringList>
+#include <QLocalServer>
+#include <QLocalSocket>
+#include "cronjob.h"
+
+class CronManager;
+
+// Serves the local-socket control protocol (see controlprotocol.h) for
+// second instances and cron-gui-ctl. Input is handled as it arrives, so a
+// large import never blocks the event loop waiting for data. Lives on the
+// scheduler thread next to CronManager, so it keeps answering while the
+// GUI is busy.
+class ControlServer : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit ControlServer(CronManager* manager, QObject *parent = nullptr);
+
+    bool listen(const QString& name);
+
+signals:
+    void showRequested();
+    void stallGuiRequested(int milliseconds);
+
+private slots:
+    void onNewConnection();
+
+private:
+    struct Session {
+        QByteArray buffer;
+        QByteArray command;
+        QVector<CronJob> jobs;
+        QStringList errors;
+        int errorCount = 0;
+        int record = 0;
+        bool discarding = false;   // Gave up on the client; its input is thrown away
+    };
+
+    void readLines(QLocalSocket* socket);
+    void handleLine(QLocalSocket* socket, Session& session, const QByteArray& line);
+    void handleImportRecord(Session& session, const QByteArray& line);
+    void finishImport(QLocalSocket* socket, Session& session);
+    void sendExport(QLocalSocket* socket);
+    void sendMetrics(QLocalSocket* socket);
+    void sendSpawnBenchmark(QLocalSocket* socket, int runs);
+    void sendSearch(QLocalSocket* socket, const QByteArray& line);
+    void sendRunOutput(QLocalSocket* socket, quint32 run);
+
+    CronManager* m_manager;
+    QLocalServer* m_server;
+    QHash<QLocalSocket*, Session> m_sessions;
+};
+
+#endif // CONTROLSERVER_H
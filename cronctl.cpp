@@ -0,0 +1,302 @@
+// cron-gui-ctl: scripted job management against a running Cron Job Manager.
+//
+//   cron-gui-ctl show
+//   cron-gui-ctl export [--format jsonl|crontab] [FILE]
+//   cron-gui-ctl import [--format auto|jsonl|json|crontab|system-crontab] [FILE]
+//   cron-gui-ctl metrics
+//   cron-gui-ctl stall-gui MILLISECONDS
+//   cron-gui-ctl bench-scan [ROUNDS]
+//   cron-gui-ctl bench-spawn [RUNS]
+//   cron-gui-ctl trace FILE|off
+//   cron-gui-ctl search [--from MS] [--to MS] [--limit N] TEXT...
+//   cron-gui-ctl output RUN
+//
+// Imports are streamed to the running instance and applied there as one batch,
+// so thousands of jobs cost a single save and a single table refresh.
+
+#include "controlprotocol.h"
+#include "crontabformat.h"
+#include "cronimporter.h"
+
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QLocalSocket>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QTextStream>
+
+namespace {
+
+const int TIMEOUT_MS = 30000;
+const qint64 MAX_PENDING_WRITE = 1 << 20;
+
+QTextStream& err()
+{
+    static QTextStream stream(stderr);
+    return stream;
+}
+
+bool openOutput(QFile& file, const QString& path)
+{
+    if (path.isEmpty() || path == "-") {
+        return file.open(stdout, QIODevice::WriteOnly);
+    }
+    file.setFileName(path);
+    return file.open(QIODevice::WriteOnly | QIODevice::Truncate);
+}
+
+bool readReplyLine(QLocalSocket& socket, QByteArray& line)
+{
+    while (!socket.canReadLine()) {
+        if (socket.state() != QLocalSocket::ConnectedState && socket.bytesAvailable() == 0) {
+            return false;
+        }
+        if (!socket.waitForReadyRead(TIMEOUT_MS)) {
+            if (!socket.canReadLine()) {
+                return false;
+            }
+        }
+    }
+    line = socket.readLine();
+    line.chop(1);
+    return true;
+}
+
+int runExport(QLocalSocket& socket, const QString& path, bool crontab)
+{
+    QFile output;
+    if (!openOutput(output, path)) {
+        err() << "Cannot open " << path << " for writing\n";
+        return 1;
+    }
+
+    socket.write(CONTROL_CMD_EXPORT + "\n");
+    QByteArray line;
+    int count = 0;
+    while (readReplyLine(socket, line)) {
+        if (line == CONTROL_END_OF_DATA) {
+            err() << "Exported " << count << " job(s)\n";
+            return 0;
+        }
+        if (crontab) {
+            CronJob job = CronJob::fromJson(QJsonDocument::fromJson(line).object());
+            output.write(CrontabFormat::formatJob(job).toUtf8());
+        } else {
+            output.write(line);
+        }
+        output.write("\n");
+        ++count;
+    }
+    err() << "Connection closed before the export finished\n";
+    return 1;
+}
+
+int runImport(QLocalSocket& socket, const QString& path, CronImporter::Format format)
+{
+    socket.write(CONTROL_CMD_IMPORT + "\n");
+
+    // Parsed jobs are forwarded one JSON line at a time as the file is read
+    CronImporter importer(format);
+    bool sendFailed = false;
+    bool readOk = importer.importFile(path, [&](const CronJob& job) {
+        if (sendFailed) {
+            return;
+        }
+        socket.write(QJsonDocument(job.toJson()).toJson(QJsonDocument::Compact));
+        socket.write("\n");
+
+        // Keep memory flat for large inputs by letting the socket drain
+        if (socket.bytesToWrite() > MAX_PENDING_WRITE && !socket.waitForBytesWritten(TIMEOUT_MS)) {
+            sendFailed = true;
+        }
+    }, [](qint64 line, const QString& message) {
+        err() << "line " << line << ": " << message << "\n";
+    });
+
+    if (sendFailed) {
+        err() << "Timed out sending jobs\n";
+        return 1;
+    }
+    if (!readOk) {
+        // Still terminate the stream so the jobs read so far are applied together
+        err() << importer.errorString() << "\n";
+    }
+    socket.write(CONTROL_END_OF_DATA + "\n");
+    socket.flush();
+
+    QByteArray reply;
+    bool ok = false;
+    while (readReplyLine(socket, reply)) {
+        if (reply == CONTROL_END_OF_DATA) {
+            ok = true;
+            break;
+        }
+        if (reply.startsWith("ok ")) {
+            QList<QByteArray> parts = reply.split(' ');
+            err() << "Imported " << parts.value(1).constData() << " job(s) from "
+                  << importer.linesRead() << " line(s), "
+                  << parts.value(2).toLongLong() + importer.errorCount() << " error(s)\n";
+        } else {
+            err() << reply << "\n";
+        }
+    }
+    if (!ok) {
+        err() << "Connection closed before the import finished\n";
+        return 1;
+    }
+    return (importer.errorCount() > 0 || !readOk) ? 2 : 0;
+}
+
+// Sends a command whose reply is JSON lines ending with "." and prints them
+int runQuery(QLocalSocket& socket, const QByteArray& command)
+{
+    socket.write(command + "\n");
+    QByteArray line;
+    int result = 0;
+    while (readReplyLine(socket, line)) {
+        if (line == CONTROL_END_OF_DATA) {
+            return result;
+        }
+        if (line.startsWith("error ")) {
+            err() << line.mid(6) << "\n";
+            result = 1;
+            continue;
+        }
+        QTextStream(stdout) << line << "\n";
+    }
+    err() << "Connection closed before the reply arrived\n";
+    return 1;
+}
+
+int runStallGui(QLocalSocket& socket, const QString& milliseconds)
+{
+    bool ok = false;
+    int ms = milliseconds.toInt(&ok);
+    if (!ok || ms < 0) {
+        err() << "stall-gui needs a duration in milliseconds\n";
+        return 1;
+    }
+    socket.write(CONTROL_CMD_STALL_GUI + " " + QByteArray::number(ms) + "\n");
+    QByteArray line;
+    if (!readReplyLine(socket, line))
+        return 1;
+    if (line.startsWith("error ")) {
+        err() << QString::fromUtf8(line.mid(6)) << "\n";
+        return 1;
+    }
+    return line == CONTROL_END_OF_DATA ? 0 : 1;
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("cron-gui-ctl");
+    QCoreApplication::setApplicationVersion("1.0");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Manage the jobs of a running Cron Job Manager.");
+    parser.addHelpOption();
+    parser.addVersionOption();
+    parser.addPositionalArgument("command", "show, export, import, metrics, stall-gui, bench-scan, bench-spawn, trace, search or output");
+    parser.addPositionalArgument("file", "Input or output file (default: stdin/stdout)", "[file]");
+    QCommandLineOption formatOption("format",
+        "Job format: jsonl or crontab for export; auto (default), jsonl, json, crontab "
+        "or system-crontab for import.", "format", "auto");
+    QCommandLineOption nodeOption("node", "Talk to the clustered instance with this node id.", "id");
+    QCommandLineOption fromOption("from", "search: only runs that finished at or after this time (epoch ms).", "ms", "0");
+    QCommandLineOption toOption("to", "search: only runs that finished at or before this time (epoch ms).", "ms", "0");
+    QCommandLineOption limitOption("limit", "search: at most this many runs (default 20).", "n", "20");
+    parser.addOption(formatOption);
+    parser.addOption(nodeOption);
+    parser.addOption(fromOption);
+    parser.addOption(toOption);
+    parser.addOption(limitOption);
+    parser.process(app);
+
+    const QStringList args = parser.positionalArguments();
+    if (args.isEmpty()) {
+        parser.showHelp(1);
+    }
+
+    const QString command = args.first();
+    const QString path = args.value(1);
+    const QString format = parser.value(formatOption);
+    const CronImporter::Format importFormat = CronImporter::formatFromName(format);
+    if (importFormat == CronImporter::AutoDetect && format != "auto") {
+        err() << "Unknown format: " << format << "\n";
+        return 1;
+    }
+
+    // Export writes JSON lines or a user crontab, nothing else
+    if (command == "export" && format != "auto" && format != "jsonl" && format != "crontab") {
+        err() << "export supports the jsonl and crontab formats, not " << format << "\n";
+        return 1;
+    }
+
+    QLocalSocket socket;
+    socket.connectToServer(controlServerName(sanitizeNodeId(parser.value(nodeOption))));
+    if (!socket.waitForConnected(TIMEOUT_MS)) {
+        err() << "Cron Job Manager is not running (" << socket.errorString() << ")\n";
+        return 1;
+    }
+
+    int result;
+    if (command == "show") {
+        socket.write(CONTROL_CMD_SHOW + "\n");
+        socket.waitForBytesWritten(TIMEOUT_MS);
+        result = 0;
+    } else if (command == "export") {
+        result = runExport(socket, path, format == "crontab");
+    } else if (command == "import") {
+        result = runImport(socket, path, importFormat);
+    } else if (command == "metrics") {
+        result = runQuery(socket, CONTROL_CMD_METRICS);
+    } else if (command == "bench-scan") {
+        QByteArray rounds = path.isEmpty() ? QByteArray() : " " + QByteArray::number(path.toInt());
+        result = runQuery(socket, CONTROL_CMD_BENCH_SCAN + rounds);
+    } else if (command == "bench-spawn") {
+        QByteArray runs = path.isEmpty() ? QByteArray() : " " + QByteArray::number(path.toInt());
+        result = runQuery(socket, CONTROL_CMD_BENCH_SPAWN + runs);
+    } else if (command == "stall-gui") {
+        result = runStallGui(socket, path);
+    } else if (command == "trace") {
+        if (path.isEmpty()) {
+            err() << "trace needs an output file, or off\n";
+            result = 1;
+        } else {
+            // The instance may have another working directory
+            QString target = path == "off" ? path : QFileInfo(path).absoluteFilePath();
+            result = runQuery(socket, CONTROL_CMD_TRACE + " " + target.toUtf8());
+        }
+    } else if (command == "search") {
+        const QString text = args.mid(1).join(' ').simplified();
+        if (text.isEmpty()) {
+            err() << "search needs some text to look for\n";
+            result = 1;
+        } else {
+            result = runQuery(socket, CONTROL_CMD_SEARCH + " "
+                + QByteArray::number(parser.value(fromOption).toLongLong()) + " "
+                + QByteArray::number(parser.value(toOption).toLongLong()) + " "
+                + QByteArray::number(parser.value(limitOption).toInt()) + " " + text.toUtf8());
+        }
+    } else if (command == "output") {
+        bool ok = false;
+        const uint run = path.toUInt(&ok);
+        if (!ok) {
+            err() << "output needs a run number, as printed by search\n";
+            result = 1;
+        } else {
+            result = runQuery(socket, CONTROL_CMD_OUTPUT + " " + QByteArray::number(run));
+        }
+    } else {
+        err() << "Unknown command: " << command << "\n";
+        result = 1;
+    }
+
+    socket.disconnectFromServer();
+    return result;
+}
@@ -0,0 +1,299 @@
+#include "cronimporter.h"
+#include "crontabformat.h"
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QJsonParseError>
+
+namespace {
+const qint64 CHUNK_SIZE = 256 * 1024;
+const int MAX_RECORD_SIZE = 1024 * 1024;  // Longest accepted line or JSON object
+}
+
+CronImporter::CronImporter(Format format)
+    : m_format(format)
+    , m_linesRead(0)
+    , m_jobCount(0)
+    , m_errorCount(0)
+{
+}
+
+CronImporter::Format CronImporter::formatFromName(const QString& name)
+{
+    if (name == "crontab") return Crontab;
+    if (name == "system-crontab") return SystemCrontab;
+    if (name == "jsonl") return JsonLines;
+    if (name == "json") return JsonArray;
+    return AutoDetect;
+}
+
+CronImporter::Format CronImporter::detectFormat(const QString& fileName, const QByteArray& head)
+{
+    QString suffix = QFileInfo(fileName).suffix().toLower();
+    if (suffix == "jsonl" || suffix == "ndjson") {
+        return JsonLines;
+    }
+
+    QByteArray start = head.trimmed();
+    if (start.startsWith('[')) {
+        return JsonArray;
+    }
+    if (start.startsWith('{')) {
+        return JsonLines;
+    }
+
+    QString absolute = QFileInfo(fileName).absoluteFilePath();
+    if (absolute == "/etc/crontab" || absolute.startsWith("/etc/cron.d/")) {
+        return SystemCrontab;
+    }
+    return Crontab;
+}
+
+bool CronImporter::validateJob(CronJob& job, QString& error)
+{
+    if (job.scriptPath.isEmpty()) {
+        error = "Missing scriptPath";
+        return false;
+    }
+    if (job.intervalMinutes < 1) {
+        error = "intervalMinutes must be at least 1";
+        return false;
+    }
+    if (job.intervalSeconds < 0 || job.intervalSeconds > 59) {
+        error = "intervalSeconds must be between 1 and 59, or 0 to use intervalMinutes";
+        return false;
+    }
+    if (job.intervalSeconds > 0 && !job.runInProcess) {
+        // Starting a process every few seconds costs more than the job itself
+        error = "intervalSeconds is only for in-process jobs";
+        return false;
+    }
+    if (job.name.isEmpty()) {
+        job.name = job.scriptPath;
+    }
+    return true;
+}
+
+bool CronImporter::parseJsonJob(const QByteArray& data, CronJob& job, QString& error)
+{
+    QJsonParseError parseError;
+    QJsonDocument doc = QJsonDocument::fromJson(data, &parseError);
+    if (parseError.error != QJsonParseError::NoError) {
+        error = parseError.errorString();
+        return false;
+    }
+    if (!doc.isObject()) {
+        error = "Expected a JSON object";
+        return false;
+    }
+    job = CronJob::fromJson(doc.object());
+    return validateJob(job, error);
+}
+
+bool CronImporter::importFile(const QString& path, const JobHandler& onJob, const ErrorHandler& onError)
+{
+    QFile file(path);
+    bool opened = (path.isEmpty() || path == "-") ? file.open(stdin, QIODevice::ReadOnly)
+                                                  : file.open(QIODevice::ReadOnly);
+    if (!opened) {
+        m_errorString = QString("Cannot open %1: %2").arg(path, file.errorString());
+        return false;
+    }
+
+    if (m_format == AutoDetect) {
+        m_format = detectFormat(path, file.peek(4096));
+    }
+    return importDevice(&file, onJob, onError);
+}
+
+bool CronImporter::importDevice(QIODevice* device, const JobHandler& onJob, const ErrorHandler& onError)
+{
+    if (m_format == AutoDetect) {
+        m_format = detectFormat(QString(), device->peek(4096));
+    }
+
+    if (m_format == JsonArray) {
+        readJsonArray(device, onJob, onError);
+    } else {
+        readLines(device, onJob, onError);
+    }
+    return m_errorString.isEmpty();
+}
+
+void CronImporter::readLines(QIODevice* device, const JobHandler& onJob, const ErrorHandler& onError)
+{
+    QByteArray pending;
+    bool skippingLongLine = false;
+
+    for (;;) {
+        QByteArray chunk = device->read(CHUNK_SIZE);
+        if (chunk.isEmpty()) {
+            break;
+        }
+        pending.append(chunk);
+
+        int start = 0;
+        int newline;
+        while ((newline = pending.indexOf('\n', start)) >= 0) {
+            if (skippingLongLine) {
+                skippingLongLine = false;
+            } else {
+                handleLine(QByteArray::fromRawData(pending.constData() + start, newline - start), onJob, onError);
+            }
+            start = newline + 1;
+        }
+        pending.remove(0, start);
+
+        if (pending.size() > MAX_RECORD_SIZE) {
+            ++m_linesRead;
+            ++m_errorCount;
+            onError(m_linesRead, "Line too long");
+            pending.clear();
+            skippingLongLine = true;
+        }
+    }
+
+    if (!pending.isEmpty() && !skippingLongLine) {
+        handleLine(pending, onJob, onError);
+    }
+}
+
+void CronImporter::handleLine(const QByteArray& line, const JobHandler& onJob, const ErrorHandler& onError)
+{
+    ++m_linesRead;
+
+    CronJob job;
+    QString error;
+    if (m_format == JsonLines) {
+        QByteArray trimmed = line.trimmed();
+        if (trimmed.isEmpty()) {
+            return;
+        }
+        if (!parseJsonJob(trimmed, job, error)) {
+            ++m_errorCount;
+            onError(m_linesRead, error);
+            return;
+        }
+    } else {
+        CrontabFormat::LineResult result = CrontabFormat::parseLine(QString::fromUtf8(line), job, error,
+                                                                    m_format == SystemCrontab, m_now);
+        if (result == CrontabFormat::SkippedLine) {
+            return;
+        }
+        if (result == CrontabFormat::InvalidLine) {
+            ++m_errorCount;
+            onError(m_linesRead, error);
+            return;
+        }
+    }
+
+    ++m_jobCount;
+    onJob(job);
+}
+
+void CronImporter::readJsonArray(QIODevice* device, const JobHandler& onJob, const ErrorHandler& onError)
+{
+    // Splits the top-level array into its element objects without building a
+    // document for the whole file; each object is parsed on its own.
+    QByteArray object;
+    qint64 line = 1;
+    qint64 objectLine = 0;
+    int depth = 0;
+    bool inString = false;
+    bool escape = false;
+    bool oversized = false;
+
+    for (;;) {
+        QByteArray chunk = device->read(CHUNK_SIZE);
+        if (chunk.isEmpty()) {
+            break;
+        }
+
+        const char* data = chunk.constData();
+        const int size = chunk.size();
+        int objectStart = (depth >= 2) ? 0 : -1;
+
+        for (int i = 0; i < size; ++i) {
+            const char c = data[i];
+            if (c == '\n') {
+                ++line;
+            }
+            if (inString) {
+                if (escape) {
+                    escape = false;
+                } else if (c == '\\') {
+                    escape = true;
+                } else if (c == '"') {
+                    inString = false;
+                }
+                continue;
+            }
+
+            switch (c) {
+            case '"':
+                inString = true;
+                break;
+            case '[':
+            case '{':
+                if (depth == 0 && c != '[') {
+                    m_errorString = "Expected a JSON array of jobs";
+                    return;
+                }
+                if (depth == 1 && c == '{') {
+                    objectStart = i;
+                    objectLine = line;
+                }
+                ++depth;
+                break;
+            case ']':
+            case '}':
+                --depth;
+                if (depth == 1 && c == '}' && objectStart >= 0) {
+                    if (!oversized) {
+                        object.append(data + objectStart, i + 1 - objectStart);
+                        handleJsonObject(object, objectLine, onJob, onError);
+                    } else {
+                        ++m_errorCount;
+                        onError(objectLine, "Job object too large");
+                    }
+                    object.clear();
+                    oversized = false;
+                    objectStart = -1;
+                } else if (depth <= 0) {
+                    m_linesRead = line;
+                    return;
+                }
+                break;
+            default:
+                break;
+            }
+        }
+
+        if (objectStart >= 0 && !oversized) {
+            object.append(data + objectStart, size - objectStart);
+            if (object.size() > MAX_RECORD_SIZE) {
+                object.clear();
+                oversized = true;
+            }
+        }
+    }
+
+    m_linesRead = line;
+    if (depth != 0) {
+        m_errorString = "Unexpected end of JSON array";
+    }
+}
+
+void CronImporter::handleJsonObject(const QByteArray& data, qint64 line, const JobHandler& onJob, const ErrorHandler& onError)
+{
+    CronJob job;
+    QString error;
+    if (!parseJsonJob(data, job, error)) {
+        ++m_errorCount;
+        onError(line, error);
+        return;
+    }
+    ++m_jobCount;
+    onJob(job);
+}
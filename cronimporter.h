@@ -0,0 +1,68 @@
+#ifndef CRONIMPORTER_H
+#define CRONIMPORTER_H
+
+#include <QString>
+#include <QByteArray>
+#include <QDateTime>
+#include <functional>
+#include "cronjob.h"
+
+class QIODevice;
+
+// Streaming reader for job files. Input is consumed in fixed-size chunks and
+// every job is handed to a callback as soon as it is parsed, so memory use
+// does not depend on the size of the file.
+//
+// Supported formats: user crontab, system crontab (with a user column),
+// JSON lines (one job object per line) and a JSON array of job objects
+// (the cronjobs.json layout).
+class CronImporter
+{
+public:
+    enum Format {
+        AutoDetect,
+        Crontab,
+        SystemCrontab,
+        JsonLines,
+        JsonArray
+    };
+
+    using JobHandler = std::function<void(const CronJob& job)>;
+    using ErrorHandler = std::function<void(qint64 line, const QString& message)>;
+
+    explicit CronImporter(Format format = AutoDetect);
+
+    bool importFile(const QString& path, const JobHandler& onJob, const ErrorHandler& onError);
+    bool importDevice(QIODevice* device, const JobHandler& onJob, const ErrorHandler& onError);
+
+    Format format() const { return m_format; }
+    qint64 linesRead() const { return m_linesRead; }
+    qint64 jobCount() const { return m_jobCount; }
+    qint64 errorCount() const { return m_errorCount; }
+    QString errorString() const { return m_errorString; }
+
+    // Crontab first runs are the next match after this (default: the time of the import)
+    void setNow(const QDateTime& now) { m_now = now; }
+
+    static Format formatFromName(const QString& name);
+    static Format detectFormat(const QString& fileName, const QByteArray& head);
+
+    // Parses and validates a single JSON job object
+    static bool parseJsonJob(const QByteArray& data, CronJob& job, QString& error);
+    static bool validateJob(CronJob& job, QString& error);
+
+private:
+    void readLines(QIODevice* device, const JobHandler& onJob, const ErrorHandler& onError);
+    void readJsonArray(QIODevice* device, const JobHandler& onJob, const ErrorHandler& onError);
+    void handleLine(const QByteArray& line, const JobHandler& onJob, const ErrorHandler& onError);
+    void handleJsonObject(const QByteArray& data, qint64 line, const JobHandler& onJob, const ErrorHandler& onError);
+
+    Format m_format;
+    qint64 m_linesRead;
+    qint64 m_jobCount;
+    qint64 m_errorCount;
+    QString m_errorString;
+    QDateTime m_now;
+};
+
+#endif // CRONIMPORTER_H
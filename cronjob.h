@@ -5,20 +5,60 @@
 #include <QDateTime>
 #include <QJsonObject>
 #include <QUuid>
+#include <QMetaType>
 
 struct CronJob {
+    enum TriggerType {
+        IntervalTrigger,      // Run every intervalMinutes (or intervalSeconds)
+        FileChangeTrigger     // Run when files under watchPath change
+    };
+
     QString id;
     QString name;
+    QString group;            // Job group sharing a concurrency limit, empty = none
     QString scriptPath;
     QString arguments;
     QString customCommand;    // Custom runtime/command (e.g., "ruby", "perl", "C:\\path\\to\\runtime.exe")
     bool useCustomCommand;    // If true, use customCommand instead of auto-detection
     int intervalMinutes;      // Run every X minutes
+    int intervalSeconds;      // In-process jobs: run every X seconds (1-59) instead, 0 = use intervalMinutes
     bool enabled;
+    TriggerType triggerType;
+    QString watchPath;        // File or folder watched by file-change triggers
+    QString watchFilter;      // Glob patterns separated by ';' (e.g. "*.csv;*.txt"), empty = any file
+    int debounceMs;           // Quiet period after the last change before the job fires
+    int maxRetries;           // Extra attempts after a failed run, 0 = none
+    int retryDelaySeconds;    // Delay before the first retry; doubles for each further one
+    int breakerThreshold;     // Pause the job after this many failures in a row, 0 = never
+    int breakerCooldownMinutes;  // How long a paused job waits before a probe run
+    bool alertImmediately;    // Notify on every run instead of in the periodic summary
+    bool lowPriority;         // May be held back while the host is busy
+    bool runInProcess;        // scriptPath is a CronTask plugin, called on a thread instead of started
+    int timeoutSeconds;       // Time limit for in-process runs, 0 = none
+    int keepOutputDays;       // Stored run output older than this is dropped, 0 = keep it
+    int deadlineMinutes;      // Interval runs should finish this long after their due time, 0 = no deadline
     QDateTime lastRun;
     QDateTime nextRun;
+    int runCount;             // Finished runs, for the failure rate
+    int failureCount;
+    int averageDurationMs;    // Recent run time, 0 until the first run finishes
+    int durationDeviationMs;  // How far run times stray from the average
+    qint64 lastCpuMs;         // What the last run used, -1 where unknown
+    qint64 lastPeakRssBytes;
+    qint64 lastReadBytes;
+    qint64 lastWriteBytes;
+    int consecutiveFailures;
+    int retryAttempt;         // Retries used on the current failure (not saved)
+    QDateTime pausedUntil;    // Set while the circuit breaker is open
 
-    CronJob() : useCustomCommand(false), intervalMinutes(60), enabled(true) {
+    CronJob() : useCustomCommand(false), intervalMinutes(60), intervalSeconds(0), enabled(true),
+                triggerType(IntervalTrigger), debounceMs(500), maxRetries(0),
+                retryDelaySeconds(30), breakerThreshold(0), breakerCooldownMinutes(15),
+                alertImmediately(false), lowPriority(false),
+                runInProcess(false), timeoutSeconds(60), keepOutputDays(0), deadlineMinutes(0), runCount(0), failureCount(0),
+                averageDurationMs(0), durationDeviationMs(0),
+                lastCpuMs(-1), lastPeakRssBytes(-1), lastReadBytes(-1), lastWriteBytes(-1),
+                consecutiveFailures(0), retryAttempt(0) {
         id = QUuid::createUuid().toString(QUuid::WithoutBraces);
     }
 
@@ -26,43 +66,214 @@ struct CronJob {
         QJsonObject obj;
         obj["id"] = id;
         obj["name"] = name;
+        if (!group.isEmpty()) {
+            obj["group"] = group;
+        }
         obj["scriptPath"] = scriptPath;
         obj["arguments"] = arguments;
         obj["customCommand"] = customCommand;
         obj["useCustomCommand"] = useCustomCommand;
         obj["intervalMinutes"] = intervalMinutes;
+        if (intervalSeconds > 0) {
+            obj["intervalSeconds"] = intervalSeconds;
+        }
         obj["enabled"] = enabled;
+        if (triggerType == FileChangeTrigger) {
+            obj["triggerType"] = "fileChange";
+            obj["watchPath"] = watchPath;
+            obj["watchFilter"] = watchFilter;
+            obj["debounceMs"] = debounceMs;
+        }
+        obj["maxRetries"] = maxRetries;
+        obj["retryDelaySeconds"] = retryDelaySeconds;
+        obj["breakerThreshold"] = breakerThreshold;
+        obj["breakerCooldownMinutes"] = breakerCooldownMinutes;
+        obj["alertImmediately"] = alertImmediately;
+        obj["lowPriority"] = lowPriority;
+        if (runInProcess) {
+            obj["runInProcess"] = true;
+            obj["timeoutSeconds"] = timeoutSeconds;
+        }
+        if (keepOutputDays > 0) {
+            obj["keepOutputDays"] = keepOutputDays;
+        }
+        if (deadlineMinutes > 0) {
+            obj["deadlineMinutes"] = deadlineMinutes;
+        }
         obj["lastRun"] = lastRun.toString(Qt::ISODate);
         obj["nextRun"] = nextRun.toString(Qt::ISODate);
+        obj["runCount"] = runCount;
+        obj["failureCount"] = failureCount;
+        obj["averageDurationMs"] = averageDurationMs;
+        obj["durationDeviationMs"] = durationDeviationMs;
+        obj["lastCpuMs"] = lastCpuMs;
+        obj["lastPeakRssBytes"] = lastPeakRssBytes;
+        obj["lastReadBytes"] = lastReadBytes;
+        obj["lastWriteBytes"] = lastWriteBytes;
+        obj["consecutiveFailures"] = consecutiveFailures;
+        obj["pausedUntil"] = pausedUntil.toString(Qt::ISODate);
         return obj;
     }
 
     static CronJob fromJson(const QJsonObject& obj) {
         CronJob job;
-        job.id = obj["id"].toString();
+        job.id = obj["id"].toString(job.id);  // Keep the generated id for imported jobs without one
         job.name = obj["name"].toString();
+        job.group = obj["group"].toString();
         job.scriptPath = obj["scriptPath"].toString();
         job.arguments = obj["arguments"].toString();
         job.customCommand = obj["customCommand"].toString();
         job.useCustomCommand = obj["useCustomCommand"].toBool(false);
         job.intervalMinutes = obj["intervalMinutes"].toInt(60);
+        job.intervalSeconds = obj["intervalSeconds"].toInt(0);
         job.enabled = obj["enabled"].toBool(true);
+        job.triggerType = obj["triggerType"].toString() == "fileChange" ? FileChangeTrigger : IntervalTrigger;
+        job.watchPath = obj["watchPath"].toString();
+        job.watchFilter = obj["watchFilter"].toString();
+        job.debounceMs = obj["debounceMs"].toInt(500);
+        job.maxRetries = obj["maxRetries"].toInt(0);
+        job.retryDelaySeconds = obj["retryDelaySeconds"].toInt(30);
+        job.breakerThreshold = obj["breakerThreshold"].toInt(0);
+        job.breakerCooldownMinutes = obj["breakerCooldownMinutes"].toInt(15);
+        job.alertImmediately = obj["alertImmediately"].toBool(false);
+        job.lowPriority = obj["lowPriority"].toBool(false);
+        job.runInProcess = obj["runInProcess"].toBool(false);
+        job.timeoutSeconds = obj["timeoutSeconds"].toInt(60);
+        job.keepOutputDays = qMax(0, obj["keepOutputDays"].toInt(0));
+        job.deadlineMinutes = qMax(0, obj["deadlineMinutes"].toInt(0));
         job.lastRun = QDateTime::fromString(obj["lastRun"].toString(), Qt::ISODate);
         job.nextRun = QDateTime::fromString(obj["nextRun"].toString(), Qt::ISODate);
+        job.runCount = obj["runCount"].toInt(0);
+        job.failureCount = obj["failureCount"].toInt(0);
+        job.averageDurationMs = obj["averageDurationMs"].toInt(0);
+        job.durationDeviationMs = qMax(0, obj["durationDeviationMs"].toInt(0));
+        job.lastCpuMs = qint64(obj["lastCpuMs"].toDouble(-1));
+        job.lastPeakRssBytes = qint64(obj["lastPeakRssBytes"].toDouble(-1));
+        job.lastReadBytes = qint64(obj["lastReadBytes"].toDouble(-1));
+        job.lastWriteBytes = qint64(obj["lastWriteBytes"].toDouble(-1));
+        job.consecutiveFailures = obj["consecutiveFailures"].toInt(0);
+        job.pausedUntil = QDateTime::fromString(obj["pausedUntil"].toString(), Qt::ISODate);
         return job;
     }
 
-    void calculateNextRun() {
-        if (lastRun.isValid()) {
-            nextRun = lastRun.addSecs(intervalMinutes * 60);
-        } else {
-            nextRun = QDateTime::currentDateTime();
+    // True if the user-editable settings match; runtime state is ignored
+    bool sameConfig(const CronJob& other) const {
+        return id == other.id
+            && name == other.name
+            && group == other.group
+            && scriptPath == other.scriptPath
+            && arguments == other.arguments
+            && customCommand == other.customCommand
+            && useCustomCommand == other.useCustomCommand
+            && intervalMinutes == other.intervalMinutes
+            && intervalSeconds == other.intervalSeconds
+            && enabled == other.enabled
+            && triggerType == other.triggerType
+            && watchPath == other.watchPath
+            && watchFilter == other.watchFilter
+            && debounceMs == other.debounceMs
+            && maxRetries == other.maxRetries
+            && retryDelaySeconds == other.retryDelaySeconds
+            && breakerThreshold == other.breakerThreshold
+            && breakerCooldownMinutes == other.breakerCooldownMinutes
+            && alertImmediately == other.alertImmediately
+            && lowPriority == other.lowPriority
+            && runInProcess == other.runInProcess
+            && timeoutSeconds == other.timeoutSeconds
+            && keepOutputDays == other.keepOutputDays
+            && deadlineMinutes == other.deadlineMinutes;
+    }
+
+    // Run history survives edits to the job's settings
+    void copyRunHistory(const CronJob& other) {
+        runCount = other.runCount;
+        failureCount = other.failureCount;
+        averageDurationMs = other.averageDurationMs;
+        durationDeviationMs = other.durationDeviationMs;
+        lastCpuMs = other.lastCpuMs;
+        lastPeakRssBytes = other.lastPeakRssBytes;
+        lastReadBytes = other.lastReadBytes;
+        lastWriteBytes = other.lastWriteBytes;
+    }
+
+    // As seen at a given time, which is always the caller's clock: the
+    // scheduler's (virtual under replay) or the forecast's simulated one
+    void calculateNextRun(const QDateTime& now) {
+        if (triggerType != IntervalTrigger) {
+            nextRun = QDateTime();  // Fired by events, never by the clock
+        } else if (lastRun.isValid()) {
+            nextRun = lastRun.addMSecs(intervalMs());
+        } else if (!nextRun.isValid()) {
+            nextRun = now;          // A first run set up front (a crontab time of day) is kept
+        }
+        if (nextRun.isValid() && isPaused(now) && nextRun < pausedUntil) {
+            nextRun = pausedUntil;  // The next run is the breaker's probe
+        }
+    }
+
+    qint64 intervalMs() const {
+        return intervalSeconds > 0 ? intervalSeconds * 1000LL : intervalMinutes * 60000LL;
+    }
+
+    bool hasDeadline() const {
+        return deadlineMinutes > 0 && triggerType == IntervalTrigger;
+    }
+
+    // Run time to plan for: the average plus two deviations, 0 if unknown
+    qint64 expectedDurationMs() const {
+        return averageDurationMs > 0 ? averageDurationMs + 2LL * durationDeviationMs : 0;
+    }
+
+    // How far ahead of nextRun to start so the run is expected to meet its
+    // deadline; at most half an interval, and never for retries or probes
+    qint64 startLeadMs() const {
+        if (!hasDeadline() || retryAttempt > 0 || pausedUntil.isValid()) {
+            return 0;
         }
+        const qint64 lateMs = expectedDurationMs() - deadlineMinutes * 60000LL;
+        return qBound<qint64>(0, lateMs, intervalMs() / 2);
+    }
+
+    // Interval jobs, and file-change jobs waiting to retry, are run by the clock
+    bool runsOnTimer() const {
+        return triggerType == IntervalTrigger || retryAttempt > 0;
+    }
+
+    bool isPaused(const QDateTime& now) const {
+        return pausedUntil.isValid() && now < pausedUntil;
+    }
+
+    bool isDue(const QDateTime& now) const {
+        return enabled && runsOnTimer() && nextRun.isValid() && now >= nextRun;
+    }
+};
+
+Q_DECLARE_METATYPE(CronJob)
+
+// Settings shared by the jobs naming the group, kept in groups.json
+struct JobGroup {
+    QString name;
+    int maxConcurrent;        // Runs of the group's jobs at a time, 0 = no limit
+    int priority;             // Higher goes first when jobs of several groups are due together
+
+    JobGroup() : maxConcurrent(0), priority(0) {}
+
+    QJsonObject toJson() const {
+        QJsonObject obj;
+        obj["name"] = name;
+        obj["maxConcurrent"] = maxConcurrent;
+        obj["priority"] = priority;
+        return obj;
     }
 
-    bool isDue() const {
-        return enabled && nextRun.isValid() && QDateTime::currentDateTime() >= nextRun;
+    static JobGroup fromJson(const QJsonObject& obj) {
+        JobGroup group;
+        group.name = obj["name"].toString();
+        group.maxConcurrent = qMax(0, obj["maxConcurrent"].toInt(0));
+        group.priority = obj["priority"].toInt(0);
+        return group;
     }
 };
+Q_DECLARE_METATYPE(JobGroup)
 
 #endif // CRONJOB_H
@@ -1,4 +1,12 @@
 #include "cronmanager.h"
+#include "filetrigger.h"
+#include "clustercoordinator.h"
+#include "tracerecorder.h"
+#include "pluginexecutor.h"
+#include "runjournal.h"
+#include "outputindex.h"
+#include "loopwatchdog.h"
+#include "cronimporter.h"
 #include <QJsonDocument>
 #include <QJsonArray>
 #include <QFile>
@@ -6,173 +14,1467 @@
 #include <QStandardPaths>
 #include <QCoreApplication>
 #include <QFileInfo>
+#include <QHash>
+#include <QSet>
+#include <QCryptographicHash>
+#include <QRandomGenerator>
+#include <QPointer>
+#include <QSaveFile>
+#include <algorithm>
+#include <climits>
+#include <memory>
 
-CronManager::CronManager(QObject *parent)
+namespace {
+const qint64 DEFER_RECHECK_MS = 30000;   // How often a deferred run looks at the host again
+const int USAGE_SAMPLE_MS = 1000;        // How often running job processes are measured
+const int SAVE_DELAY_MS = 2000;          // Run state changes within this window share one save
+const int OUTPUT_BATCH_MS = 100;         // Live output is passed on at most this often per job
+const int OUTPUT_TAIL_BYTES = 64 * 1024; // Live output held per batch; only a screenful is shown anyway
+const int MAX_RUN_OUTPUT_BYTES = 1 << 20; // Output kept per run; the output index stores no more anyway
+const int BENCH_SLICE_MS = 5;            // Longest a scan benchmark holds the scheduler thread at once
+}
+
+CronManager::CronManager(const QString& configDir, const QString& clusterNodeId, QObject *parent)
     : QObject(parent)
     , m_timer(new QTimer(this))
     , m_running(false)
+    , m_fileTrigger(new FileTrigger(this))
+    , m_environment(buildEnvironment())
+    , m_configWatcher(new QFileSystemWatcher(this))
+    , m_reloadTimer(new QTimer(this))
+    , m_configDir(configDir)
+    , m_cluster(nullptr)
+    , m_trace(nullptr)
+    , m_plugins(new PluginExecutor(this))
+    , m_journal(nullptr)
+    , m_indexThread(new QThread(this))
+    , m_outputIndex(nullptr)
+    , m_watchdog(new LoopWatchdog(this))
+    , m_saveTimer(new QTimer(this))
+    , m_usageTimer(new QTimer(this))
+    , m_outputTimer(new QTimer(this))
+    , m_launcher(JobProcess::defaultBackend())
+    , m_clock(SchedulerClock::system())
+    , m_dryRun(false)
+    , m_jitter(QRandomGenerator::global()->generate())
+    , m_bulk(false)
+    , m_lastCheckMs(-1)
 {
+    qRegisterMetaType<CronJob>("CronJob");
+    qRegisterMetaType<QVector<CronJob>>("QVector<CronJob>");
+    qRegisterMetaType<SchedulerStats>("SchedulerStats");
+    qRegisterMetaType<QVector<JobGroup>>("QVector<JobGroup>");
+    
+    // Armed for the earliest due job rather than polling on a fixed period
+    m_timer->setSingleShot(true);
     connect(m_timer, &QTimer::timeout, this, &CronManager::checkAndRunJobs);
+    m_saveTimer->setSingleShot(true);
+    m_saveTimer->setInterval(SAVE_DELAY_MS);
+    connect(m_saveTimer, &QTimer::timeout, this, &CronManager::saveJobs);
+    connect(m_plugins, &PluginExecutor::finished, this, [this](const QString& jobId, bool success, const QString& output) {
+        emit logMessage(QString("In-process job %1").arg(success ? "succeeded" : "failed"));
+        // A call that timed out still occupies a thread; its group slot stays
+        // taken until released()
+        const QPair<QPointer<TraceRecorder>, int> trace = m_pluginTraces.take(jobId);
+        if (trace.first) {
+            trace.first->finished(trace.second, success, success ? 0 : 1);
+        }
+        finishRun(jobId, success, output, m_pluginRuns.take(jobId), RunUsage(), !m_plugins->isRunning(jobId));
+    });
+    connect(m_plugins, &PluginExecutor::released, this, [this](const QString& jobId) {
+        startQueued(endGroupRun(jobId));
+    });
+    m_usageTimer->setInterval(USAGE_SAMPLE_MS);
+    connect(m_usageTimer, &QTimer::timeout, this, &CronManager::sampleUsage);
+    m_outputTimer->setSingleShot(true);
+    m_outputTimer->setInterval(OUTPUT_BATCH_MS);
+    connect(m_outputTimer, &QTimer::timeout, this, &CronManager::emitOutput);
+    connect(m_watchdog, &LoopWatchdog::stalled, this, [this](const LoopWatchdog::Stall& stall) {
+        ++m_stats.loopStalls;
+        m_stats.longestStallMs = qMax(m_stats.longestStallMs, stall.durationMs);
+        m_stats.lastStallHandler = stall.handler;
+        emit statsChanged(m_stats);
+        emit logMessage(QString("Scheduler thread was blocked for %1 ms in %2").arg(stall.durationMs).arg(stall.handler));
+    });
+    connect(m_fileTrigger, &FileTrigger::triggered, this, &CronManager::onFileTriggered);
+    connect(m_fileTrigger, &FileTrigger::scriptChanged, this, [this](const QString& jobId) {
+        m_launchCache.remove(jobId);
+    });
+    
+    // Pick up edits made to cronjobs.json by other tools; writers often touch
+    // the file several times, so wait for it to settle before reloading
+    m_reloadTimer->setSingleShot(true);
+    m_reloadTimer->setInterval(250);
+    connect(m_reloadTimer, &QTimer::timeout, this, &CronManager::reloadJobs);
+    connect(m_configWatcher, &QFileSystemWatcher::fileChanged, this, &CronManager::onConfigChanged);
+    connect(m_configWatcher, &QFileSystemWatcher::directoryChanged, this, &CronManager::onConfigDirChanged);
+    
+    if (!clusterNodeId.isEmpty()) {
+        m_cluster = new ClusterCoordinator(QFileInfo(getConfigPath()).absolutePath(), clusterNodeId, this);
+        m_stats.clusterNode = clusterNodeId;
+        m_schedule.setEarlyStarts(false);   // Nodes agree on slot boundaries, not on run times
+        connect(m_cluster, &ClusterCoordinator::membershipChanged, this, [this](const QStringList& nodes) {
+            m_stats.clusterSize = nodes.size();
+            emit statsChanged(m_stats);
+            emit logMessage(QString("Cluster members (%1): %2").arg(nodes.size()).arg(nodes.join(", ")));
+        });
+        connect(m_cluster, &ClusterCoordinator::slotOrphaned, this, &CronManager::onSlotOrphaned);
+    }
+    
     loadJobs();
+    migrateState();
+    loadGroups();
+    watchConfig();
+    
+    // Per node in a cluster: each node only knows its own processes
+    const QString journalName = clusterNodeId.isEmpty()
+        ? QString("inflight.jsonl") : QString("inflight-%1.jsonl").arg(clusterNodeId);
+    m_journal = new RunJournal(stateDir() + "/" + journalName, this);
+    connect(m_journal, &RunJournal::orphanEnded, this, [this](const QString& jobId, qint64 pid) {
+        CronJob* job = getJob(jobId);
+        emit logMessage(QString("Run of %1 left over from the last session (pid %2) has ended; its result is unknown")
+            .arg(job ? job->name : jobId).arg(pid));
+    });
+    recoverRuns();
+    
+    // Indexing and searching run output stays off the scheduler thread
+    const QString outputDir = stateDir()
+        + (clusterNodeId.isEmpty() ? QString("/output") : QString("/output-%1").arg(clusterNodeId));
+    m_outputIndex = new OutputIndex(outputDir);
+    m_outputIndex->moveToThread(m_indexThread);
+    m_indexThread->setObjectName("Output index");
+    connect(m_indexThread, &QThread::finished, m_outputIndex, &QObject::deleteLater);
+    m_indexThread->start(QThread::LowPriority);
+    QMetaObject::invokeMethod(m_outputIndex, &OutputIndex::open, Qt::QueuedConnection);
+    syncRetention();
 }
 
 CronManager::~CronManager()
 {
     stop();
     saveJobs();
+    m_indexThread->quit();   // The index writes out what it holds as it goes
+    m_indexThread->wait();
 }
 
 void CronManager::addJob(const CronJob& job)
 {
     CronJob newJob = job;
-    newJob.calculateNextRun();
+    newJob.calculateNextRun(currentTime());
+    m_jobIndex.insert(newJob.id, m_jobs.size());
+    m_jobOrder.insert(newJob.id, m_nextOrder++);
     m_jobs.append(newJob);
+    m_schedule.append(newJob);
+    m_fileTrigger->updateJobs(m_jobs);
     saveJobs();
-    emit jobsChanged();
+    armTimer();
+    emit jobAdded(newJob);
     emit logMessage(QString("Added job: %1").arg(newJob.name));
 }
 
 void CronManager::updateJob(const CronJob& job)
 {
+    int i = m_jobIndex.value(job.id, -1);
+    if (i < 0) {
+        return;
+    }
+    
+    // Run history is not part of the edit
+    CronJob updated = job;
+    updated.copyRunHistory(m_jobs[i]);
+    m_jobs[i] = updated;
+    m_jobs[i].calculateNextRun(currentTime());
+    m_schedule.set(i, m_jobs[i]);
+    m_launchCache.remove(job.id);
+    m_deferredSince.remove(job.id);   // The edit starts a fresh schedule
+    m_stats.deferredJobs = m_deferredSince.size();
+    unqueue(job.id);
+    m_fileTrigger->updateJobs(m_jobs);
+    saveJobs();
+    armTimer();
+    emit jobUpdated(m_jobs[i]);
+    emit logMessage(QString("Updated job: %1").arg(job.name));
+}
+
+void CronManager::removeJob(const QString& id)
+{
+    int i = m_jobIndex.value(id, -1);
+    if (i < 0) {
+        return;
+    }
+    
+    // The last job takes its place, so no other handle changes; saves
+    // still follow m_jobOrder, so the file keeps its order
+    QString name = m_jobs[i].name;
+    const int last = m_jobs.size() - 1;
+    if (i != last) {
+        m_jobs[i] = std::move(m_jobs[last]);
+        m_jobIndex[m_jobs[i].id] = i;
+    }
+    m_jobs.removeLast();
+    m_schedule.removeSwap(i);
+    m_jobIndex.remove(id);
+    m_jobOrder.remove(id);
+    m_launchCache.remove(id);
+    m_retryFiles.remove(id);
+    unqueue(id);
+    if (m_deferredSince.remove(id) > 0) {
+        m_stats.deferredJobs = m_deferredSince.size();
+        emit statsChanged(m_stats);
+    }
+    m_fileTrigger->updateJobs(m_jobs);
+    saveJobs();
+    emit jobRemoved(id);
+    emit logMessage(QString("Removed job: %1").arg(name));
+}
+
+void CronManager::importJobs(const QVector<CronJob>& jobs)
+{
+    LoopWatchdog::Scope scope("CronManager::importJobs");
+    if (jobs.isEmpty()) {
+        return;
+    }
+
+    int added = 0;
+    int updated = 0;
+    QSet<QString> pool;
+    m_jobs.reserve(m_jobs.size() + jobs.size());
+    m_jobIndex.reserve(m_jobs.size() + jobs.size());
+    const int deferredBefore = m_deferredSince.size();
+    for (const CronJob& job : jobs) {
+        CronJob newJob = job;
+        internStrings(newJob, pool);
+        auto it = m_jobIndex.constFind(newJob.id);
+        if (it != m_jobIndex.constEnd()) {
+            // Like an edit: the settings are replaced, the run history and
+            // the breaker's state are kept
+            const CronJob& current = m_jobs[it.value()];
+            newJob.copyRunHistory(current);
+            newJob.lastRun = current.lastRun;
+            newJob.consecutiveFailures = current.consecutiveFailures;
+            newJob.pausedUntil = current.pausedUntil;
+            newJob.calculateNextRun(currentTime());
+            m_jobs[it.value()] = newJob;
+            m_launchCache.remove(newJob.id);
+            m_deferredSince.remove(newJob.id);
+            m_retryFiles.remove(newJob.id);
+            unqueue(newJob.id);
+            ++updated;
+        } else {
+            newJob.calculateNextRun(currentTime());
+            m_jobIndex.insert(newJob.id, m_jobs.size());
+            m_jobOrder.insert(newJob.id, m_nextOrder++);
+            m_jobs.append(newJob);
+            ++added;
+        }
+    }
+    m_schedule.rebuild(m_jobs);
+    if (m_deferredSince.size() != deferredBefore) {
+        m_stats.deferredJobs = m_deferredSince.size();
+        emit statsChanged(m_stats);
+    }
+
+    // One write and one refresh for the whole batch
+    m_fileTrigger->updateJobs(m_jobs);
+    saveJobs();
+    armTimer();
+    emit jobsChanged(m_jobs);
+    emit logMessage(QString("Imported %1 job(s): %2 added, %3 updated").arg(jobs.size()).arg(added).arg(updated));
+}
+
+CronJob* CronManager::getJob(const QString& id)
+{
+    int i = m_jobIndex.value(id, -1);
+    return i >= 0 ? &m_jobs[i] : nullptr;
+}
+
+const QVector<CronJob>& CronManager::getJobs() const
+{
+    return m_jobs;
+}
+
+QVector<int> CronManager::jobOrder() const
+{
+    QVector<int> order(m_jobs.size());
+    for (int i = 0; i < order.size(); ++i) {
+        order[i] = i;
+    }
+    std::sort(order.begin(), order.end(), [this](int a, int b) {
+        return m_jobOrder.value(m_jobs[a].id) < m_jobOrder.value(m_jobs[b].id);
+    });
+    return order;
+}
+
+void CronManager::renumberJobs()
+{
+    // m_jobs was just read from the file, so its order is the file's
+    m_jobOrder.clear();
+    m_jobOrder.reserve(m_jobs.size());
+    for (const CronJob& job : qAsConst(m_jobs)) {
+        m_jobOrder.insert(job.id, m_nextOrder++);
+    }
+}
+
+SchedulerStats CronManager::stats() const
+{
+    SchedulerStats stats = m_stats;
+    stats.loopLatency = m_watchdog->toJson();
+    return stats;
+}
+
+void CronManager::runJobNow(const QString& id)
+{
+    CronJob* job = getJob(id);
+    if (job) {
+        emit logMessage(QString("Manually running job: %1").arg(job->name));
+        if (groupFull(job->group)) {
+            waitForGroup(*job, m_jobIndex.value(id));
+            emit statsChanged(m_stats);
+            return;
+        }
+        executeJob(*job);
+        return;
+    }
+    emit logMessage(QString("Job not found: %1").arg(id));
+}
+
+void CronManager::setJobsEnabled(const QStringList& ids, bool enabled)
+{
+    LoopWatchdog::Scope scope("CronManager::setJobsEnabled");
+    int changed = 0;
+    for (const QString& id : ids) {
+        CronJob* job = getJob(id);
+        if (!job || job->enabled == enabled) {
+            continue;
+        }
+        job->enabled = enabled;
+        job->calculateNextRun(currentTime());
+        m_deferredSince.remove(id);
+        unqueue(id);
+        ++changed;
+    }
+    if (changed == 0) {
+        return;
+    }
+    
+    // One write and one refresh for the whole batch
+    rebuildSchedule();
+    m_fileTrigger->updateJobs(m_jobs);
+    saveJobs();
+    armTimer();
+    emit jobsChanged(m_jobs);
+    emit statsChanged(m_stats);
+    emit logMessage(QString("%1 %2 job(s)").arg(enabled ? "Enabled" : "Disabled").arg(changed));
+}
+
+void CronManager::removeJobs(const QStringList& ids)
+{
+    LoopWatchdog::Scope scope("CronManager::removeJobs");
+    QSet<QString> doomed;
+    for (const QString& id : ids) {
+        if (m_jobIndex.contains(id)) {
+            doomed.insert(id);
+        }
+    }
+    if (doomed.isEmpty()) {
+        return;
+    }
+    
+    // One pass over the list instead of shifting it once per job
+    m_jobs.erase(std::remove_if(m_jobs.begin(), m_jobs.end(), [&doomed](const CronJob& job) {
+        return doomed.contains(job.id);
+    }), m_jobs.end());
+    for (const QString& id : qAsConst(doomed)) {
+        m_jobOrder.remove(id);
+        m_launchCache.remove(id);
+        m_retryFiles.remove(id);
+        m_deferredSince.remove(id);
+        unqueue(id);
+    }
+    rebuildSchedule();
+    m_fileTrigger->updateJobs(m_jobs);
+    saveJobs();
+    armTimer();
+    emit jobsChanged(m_jobs);
+    emit statsChanged(m_stats);
+    emit logMessage(QString("Removed %1 job(s)").arg(doomed.size()));
+}
+
+void CronManager::runJobs(const QStringList& ids)
+{
+    // Group limits still apply; the rest wait for a free slot
+    int started = 0;
+    int waiting = 0;
+    m_bulk = true;
+    for (const QString& id : ids) {
+        const int handle = m_jobIndex.value(id, -1);
+        if (handle < 0) {
+            continue;
+        }
+        CronJob& job = m_jobs[handle];
+        if (groupFull(job.group)) {
+            waitForGroup(job, handle);
+            ++waiting;
+        } else {
+            executeJob(job);
+            ++started;
+        }
+    }
+    m_bulk = false;
+    if (started + waiting == 0) {
+        return;
+    }
+    
+    armTimer();
+    emit jobsChanged(m_jobs);
+    emit statsChanged(m_stats);
+    emit logMessage(QString("Manually running %1 job(s), %2 waiting for a group slot").arg(started + waiting).arg(waiting));
+}
+
+void CronManager::setGroup(const JobGroup& group)
+{
+    if (group.name.isEmpty()) {
+        return;
+    }
+    m_groups.insert(group.name, group);
+    saveGroups();
+    emit groupsChanged(QVector<JobGroup>(m_groups.cbegin(), m_groups.cend()));
+    emit logMessage(QString("Group %1: %2, priority %3").arg(group.name)
+        .arg(group.maxConcurrent > 0 ? QString("at most %1 at a time").arg(group.maxConcurrent) : QString("no limit"))
+        .arg(group.priority));
+    startQueued(group.name);   // A raised limit frees slots right away
+    armTimer();
+}
+
+void CronManager::start()
+{
+    if (!m_running) {
+        m_running = true;
+        if (!m_clock->isVirtual()) {
+            m_watchdog->start();   // On the scheduler thread, which is the one it watches
+        }
+        
+        // Give views their first snapshot from the scheduler thread
+        emit jobsChanged(m_jobs);
+        emit groupsChanged(QVector<JobGroup>(m_groups.cbegin(), m_groups.cend()));
+        emit statsChanged(m_stats);
+        emit logMessage("Cron scheduler started");
+        emit logMessage(QString("Starting job processes with %1").arg(JobProcess::backendName(m_launcher)));
+        // Run initial check
+        checkAndRunJobs();
+    }
+}
+
+void CronManager::stop()
+{
+    if (m_running) {
+        m_running = false;
+        m_timer->stop();
+        m_watchdog->stop();
+        emit logMessage("Cron scheduler stopped");
+    }
+}
+
+void CronManager::checkAndRunJobs()
+{
+    LoopWatchdog::Scope scope("CronManager::checkAndRunJobs");
+    const qint64 nowMs = m_clock->nowMs();
+    bool statsUpdated = false;
+    const qint64 deferralsBefore = m_stats.deferrals + m_stats.forcedRuns;
+    const int deferredJobsBefore = m_stats.deferredJobs;
+    
+    // Only the dense next-fire array is scanned; whole jobs are touched
+    // just for the ones that are due
+    m_schedule.collectDue(nowMs, m_dueScratch);
+    bool anyDeadline = false;
+    for (int handle : qAsConst(m_dueScratch)) {
+        anyDeadline |= runDeadline(m_jobs[handle]) != ScheduleTable::NEVER;
+    }
+    if (!m_groups.isEmpty() || anyDeadline) {
+        // Jobs of higher-priority groups take the first slots; within a
+        // priority the earliest deadline goes first
+        std::stable_sort(m_dueScratch.begin(), m_dueScratch.end(), [this](int a, int b) {
+            const int priorityA = m_groups.value(m_jobs[a].group).priority;
+            const int priorityB = m_groups.value(m_jobs[b].group).priority;
+            if (priorityA != priorityB) {
+                return priorityA > priorityB;
+            }
+            return m_pendingDeadlines.value(m_jobs[a].id, ScheduleTable::NEVER)
+                < m_pendingDeadlines.value(m_jobs[b].id, ScheduleTable::NEVER);
+        });
+    }
+    for (int handle : qAsConst(m_dueScratch)) {
+        CronJob& job = m_jobs[handle];
+        const qint64 fireMs = m_schedule.nextFireMs(handle);
+        
+        // Firing lag, for jobs that fell due while we were running (not ones
+        // overdue from before startup)
+        if (m_lastCheckMs >= 0 && fireMs > m_lastCheckMs) {
+            qint64 lag = nowMs - fireMs;
+            m_stats.lastLagMs = lag;
+            m_stats.maxLagMs = qMax(m_stats.maxLagMs, lag);
+            m_stats.totalLagMs += lag;
+            ++m_stats.lagSamples;
+            statsUpdated = true;
+        }
+        
+        // Only the job's owner decides about holding its run back
+        if (job.lowPriority && !m_dryRun && (!m_cluster || m_cluster->ownsJob(job.id)) && deferRun(job, handle, nowMs)) {
+            continue;
+        }
+        
+        if (m_cluster && job.retryAttempt == 0) {
+            // Runs are keyed by a time slot every node computes the same way;
+            // whichever node creates the slot's lease first runs it. Retries
+            // stay with the node whose run failed.
+            const qint64 intervalMs = qMax<qint64>(1000, job.intervalMs());
+            const qint64 slot = nowMs / intervalMs;
+            scheduleNextRun(job);
+            m_schedule.set(handle, job);
+            if (!m_cluster->ownsJob(job.id) || !m_cluster->tryAcquireLease(job.id, slot, 2 * intervalMs)) {
+                m_pendingDeadlines.remove(job.id);   // Another node's run
+                continue;
+            }
+            m_pendingLeases.insert(job.id, slot);
+        }
+        if (groupFull(job.group)) {
+            waitForGroup(job, handle);
+            statsUpdated = true;
+            continue;
+        }
+        executeJob(job, m_retryFiles.value(job.id), fireMs);
+        ++m_stats.firedRuns;
+        if (m_stats.firstRunMs < 0 && m_launchTimer.isValid()) {
+            m_stats.firstRunMs = m_launchTimer.elapsed();
+            statsUpdated = true;
+            emit logMessage(QString("First scheduled run started %1 ms after launch").arg(m_stats.firstRunMs));
+        }
+    }
+    
+    m_lastCheckMs = nowMs;
+    if (m_stats.deferrals + m_stats.forcedRuns != deferralsBefore || m_stats.deferredJobs != deferredJobsBefore) {
+        statsUpdated = true;
+    }
+    if (statsUpdated) {
+        emit statsChanged(m_stats);
+    }
+    armTimer();
+}
+
+bool CronManager::deferRun(CronJob& job, int handle, qint64 nowMs)
+{
+    auto since = m_deferredSince.find(job.id);
+    QString reason;
+    if (!m_admission.isBusy(&reason)) {
+        if (since != m_deferredSince.end()) {
+            emit logMessage(QString("Host is quiet again, running deferred job %1 after %2 s")
+                .arg(job.name).arg((nowMs - since.value()) / 1000));
+            m_deferredSince.erase(since);
+            m_stats.deferredJobs = m_deferredSince.size();
+        }
+        return false;
+    }
+    
+    // Not when the wait would cost the deadline; a run starting early would
+    // also fire again right away at its recheck time
+    const qint64 deadlineMs = m_pendingDeadlines.value(job.id, ScheduleTable::NEVER);
+    if (deadlineMs != ScheduleTable::NEVER
+        && (job.startLeadMs() > 0 || nowMs + job.expectedDurationMs() + DEFER_RECHECK_MS > deadlineMs)) {
+        emit logMessage(QString("Running %1 although the host is busy (%2): waiting would miss its deadline")
+            .arg(job.name).arg(reason));
+        if (since != m_deferredSince.end()) {
+            m_deferredSince.erase(since);
+            m_stats.deferredJobs = m_deferredSince.size();
+        }
+        return false;
+    }
+    
+    if (since == m_deferredSince.end()) {
+        since = m_deferredSince.insert(job.id, nowMs);
+        ++m_stats.deferrals;
+        m_stats.deferredJobs = m_deferredSince.size();
+        emit logMessage(QString("Deferring %1: host is busy (%2)").arg(job.name).arg(reason));
+    } else if (nowMs - since.value() >= m_admission.maxDeferralMs()) {
+        // Bounded wait, so a constantly busy host doesn't starve the job
+        emit logMessage(QString("Running %1 although the host is busy (%2): deferred for %3 minute(s)")
+            .arg(job.name).arg(reason).arg((nowMs - since.value()) / 60000));
+        m_deferredSince.erase(since);
+        m_stats.deferredJobs = m_deferredSince.size();
+        ++m_stats.forcedRuns;
+        return false;
+    }
+    
+    // Look again shortly; lastRun is untouched, so the regular schedule
+    // carries on from the original slot once the run happens
+    qint64 recheckMs = qMin(nowMs + DEFER_RECHECK_MS, since.value() + m_admission.maxDeferralMs());
+    job.nextRun = QDateTime::fromMSecsSinceEpoch(recheckMs);
+    m_schedule.set(handle, job);
+    emit jobUpdated(job);
+    return true;
+}
+
+void CronManager::beginGroupRun(const CronJob& job)
+{
+    if (!job.group.isEmpty()) {
+        ++m_groupRunning[job.group];
+        m_runGroups.insert(job.id, job.group);
+    }
+}
+
+QString CronManager::endGroupRun(const QString& jobId)
+{
+    // The group the run started under, even if the job has moved since
+    auto it = m_runGroups.find(jobId);
+    if (it == m_runGroups.end()) {
+        return QString();
+    }
+    const QString group = it.value();
+    m_runGroups.erase(it);
+    if (--m_groupRunning[group] <= 0) {
+        m_groupRunning.remove(group);
+    }
+    return group;
+}
+
+bool CronManager::groupFull(const QString& group) const
+{
+    if (group.isEmpty()) {
+        return false;
+    }
+    const int limit = m_groups.value(group).maxConcurrent;
+    return limit > 0 && m_groupRunning.value(group) >= limit;
+}
+
+void CronManager::waitForGroup(CronJob& job, int handle)
+{
+    QStringList& queue = m_groupQueues[job.group];
+    if (!queue.contains(job.id)) {
+        // Earliest deadline first; runs without one keep their order at the back
+        const qint64 deadlineMs = m_pendingDeadlines.value(job.id, ScheduleTable::NEVER);
+        int at = 0;
+        while (at < queue.size() && m_pendingDeadlines.value(queue.at(at), ScheduleTable::NEVER) <= deadlineMs) {
+            ++at;
+        }
+        queue.insert(at, job.id);
+        ++m_stats.groupWaiting;
+        emit logMessage(QString("%1 is waiting: group %2 already runs %3 job(s)")
+            .arg(job.name, job.group).arg(m_groupRunning.value(job.group)));
+    }
+    // Off the timer until a slot frees up; startQueued() runs it then
+    job.nextRun = QDateTime();
+    m_schedule.set(handle, job);
+    notifyJobUpdated(job);
+}
+
+void CronManager::unqueue(const QString& jobId)
+{
+    m_pendingDeadlines.remove(jobId);   // Whatever was due is rescheduled by the caller
+    releaseLease(jobId);
+    for (auto it = m_groupQueues.begin(); it != m_groupQueues.end();) {
+        m_stats.groupWaiting -= it.value().removeAll(jobId);
+        if (it.value().isEmpty()) {
+            it = m_groupQueues.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+void CronManager::releaseLease(const QString& jobId)
+{
+    // A slot that won't run after all is closed, so nobody takes it over
+    auto it = m_pendingLeases.find(jobId);
+    if (it == m_pendingLeases.end()) {
+        return;
+    }
+    if (m_cluster) {
+        m_cluster->finishLease(jobId, it.value());
+    }
+    m_pendingLeases.erase(it);
+}
+
+void CronManager::startQueued(const QString& group)
+{
+    const int waitingBefore = m_stats.groupWaiting;
+    for (;;) {
+        // Looked up each time: a run that fails to start comes back here
+        auto it = m_groupQueues.find(group);
+        if (it == m_groupQueues.end()) {
+            break;
+        }
+        if (it.value().isEmpty()) {
+            m_groupQueues.erase(it);
+            break;
+        }
+        if (groupFull(group)) {
+            break;
+        }
+        const QString jobId = it.value().takeFirst();
+        --m_stats.groupWaiting;
+        CronJob* job = getJob(jobId);
+        if (job && job->enabled) {
+            executeJob(*job, m_retryFiles.value(jobId));
+        } else {
+            m_pendingDeadlines.remove(jobId);
+            releaseLease(jobId);
+        }
+    }
+    if (m_stats.groupWaiting != waitingBefore) {
+        emit statsChanged(m_stats);
+    }
+}
+
+void CronManager::notifyJobUpdated(const CronJob& job)
+{
+    if (!m_bulk) {
+        emit jobUpdated(job);
+    }
+}
+
+qint64 CronManager::nextEventMs() const
+{
+    qint64 next = m_schedule.earliestFireMs();
+    if (!m_stubRuns.isEmpty()) {
+        next = qMin(next, m_stubRuns.firstKey());
+    }
+    return next;
+}
+
+void CronManager::processDue()
+{
+    // Runs ending now go first, as their exit would be handled before the timer
+    const qint64 nowMs = m_clock->nowMs();
+    while (!m_stubRuns.isEmpty() && m_stubRuns.firstKey() <= nowMs) {
+        auto first = m_stubRuns.begin();
+        const StubRun run = first.value();
+        m_stubRuns.erase(first);
+        finishRun(run.jobId, !m_failingJobs.contains(run.jobId), QString(), run.timing);
+    }
+    checkAndRunJobs();
+}
+
+void CronManager::armTimer()
+{
+    if (!m_running || m_clock->isVirtual()) {
+        return;
+    }
+    
+    // Sleep until the earliest due job, but wake at least every 30 seconds
+    // so clock changes and suspend/resume are noticed
+    const qint64 maxSleepMs = 30000;
+    qint64 earliest = m_schedule.earliestFireMs();
+    qint64 sleepMs = maxSleepMs;
+    if (earliest != ScheduleTable::NEVER) {
+        sleepMs = qBound<qint64>(0, earliest - m_clock->nowMs(), maxSleepMs);
+    }
+    m_timer->start(static_cast<int>(sleepMs));
+}
+
+void CronManager::rebuildSchedule()
+{
+    m_jobIndex.clear();
+    m_jobIndex.reserve(m_jobs.size());
     for (int i = 0; i < m_jobs.size(); ++i) {
-        if (m_jobs[i].id == job.id) {
-            m_jobs[i] = job;
-            m_jobs[i].calculateNextRun();
-            saveJobs();
-            emit jobsChanged();
-            emit logMessage(QString("Updated job: %1").arg(job.name));
+        m_jobIndex.insert(m_jobs[i].id, i);
+    }
+    m_schedule.rebuild(m_jobs);
+    
+    for (auto it = m_deferredSince.begin(); it != m_deferredSince.end();) {
+        if (m_jobIndex.contains(it.key())) {
+            ++it;
+        } else {
+            it = m_deferredSince.erase(it);
+        }
+    }
+    m_stats.deferredJobs = m_deferredSince.size();
+}
+
+void CronManager::syncSchedule(const CronJob& job)
+{
+    int handle = m_jobIndex.value(job.id, -1);
+    if (handle >= 0) {
+        m_schedule.set(handle, job);
+    }
+}
+
+void CronManager::internStrings(CronJob& job, QSet<QString>& pool)
+{
+    // Many jobs share a runtime, a script folder or arguments; let equal
+    // strings share one buffer instead of one copy per job
+    for (QString* field : {&job.scriptPath, &job.arguments, &job.customCommand, &job.watchPath, &job.watchFilter}) {
+        auto it = pool.constFind(*field);
+        if (it != pool.constEnd()) {
+            *field = *it;
+        } else {
+            pool.insert(*field);
+        }
+    }
+}
+
+struct CronManager::ScanBenchmark {
+    int rounds = 0;
+    int round = 0;           // Rounds done so far; the object scan comes first
+    qint64 objectNs = 0;
+    qint64 denseNs = 0;
+    qint64 objectDue = 0;
+    qint64 denseDue = 0;
+    qint64 scanned = 0;      // Jobs looked at per method; the list may change between slices
+    std::function<void(const QJsonObject&)> done;
+};
+
+void CronManager::benchmarkScan(int rounds, const std::function<void(const QJsonObject&)>& done)
+{
+    auto bench = std::make_shared<ScanBenchmark>();
+    bench->rounds = qBound(1, rounds, 100000);
+    bench->done = done;
+    benchmarkSlice(bench);
+}
+
+void CronManager::benchmarkSlice(const std::shared_ptr<ScanBenchmark>& bench)
+{
+    // Rounds until BENCH_SLICE_MS have passed, then due jobs fire before the next slice
+    LoopWatchdog::Scope scope("CronManager::benchmarkScan");
+    QElapsedTimer timer;
+    timer.start();
+    QVector<int> due;
+    while (bench->round < 2 * bench->rounds && timer.elapsed() < BENCH_SLICE_MS) {
+        const qint64 startNs = timer.nsecsElapsed();
+        if (bench->round < bench->rounds) {
+            // The old way: every job object, its QDateTime, and the clock per job
+            QDateTime earliest;
+            for (const CronJob& job : m_jobs) {
+                if (job.isDue(currentTime())) {
+                    ++bench->objectDue;
+                }
+                if (job.enabled && job.runsOnTimer() && job.nextRun.isValid()
+                    && (!earliest.isValid() || job.nextRun < earliest)) {
+                    earliest = job.nextRun;
+                }
+            }
+            bench->objectNs += timer.nsecsElapsed() - startNs;
+            bench->scanned += m_jobs.size();
+        } else {
+            m_schedule.collectDue(m_clock->nowMs(), due);
+            bench->denseDue += due.size();
+            (void)m_schedule.earliestFireMs();
+            bench->denseNs += timer.nsecsElapsed() - startNs;
+        }
+        ++bench->round;
+    }
+    if (bench->round < 2 * bench->rounds) {
+        QTimer::singleShot(0, this, [this, bench]() { benchmarkSlice(bench); });
+        return;
+    }
+    bench->done(scanResult(bench->rounds, bench->objectNs, bench->denseNs,
+                           bench->scanned, qMax(bench->objectDue, bench->denseDue)));
+}
+
+QJsonObject CronManager::scanResult(int rounds, qint64 objectNs, qint64 denseNs, qint64 scanned, qint64 dueJobs) const
+{
+    // Heap use of the job objects, counting shared string buffers once
+    QSet<const void*> buffers;
+    qint64 stringBytes = 0;
+    for (const CronJob& job : m_jobs) {
+        for (const QString* field : {&job.id, &job.name, &job.scriptPath, &job.arguments,
+                                     &job.customCommand, &job.watchPath, &job.watchFilter}) {
+            if (!field->isEmpty() && !buffers.contains(field->constData())) {
+                buffers.insert(field->constData());
+                stringBytes += field->capacity() * qint64(sizeof(QChar));
+            }
+        }
+    }
+    
+    scanned = qMax<qint64>(1, scanned);
+    QJsonObject obj;
+    obj["jobs"] = m_jobs.size();
+    obj["rounds"] = rounds;
+    obj["objectScanNsPerJob"] = double(objectNs) / scanned;
+    obj["denseScanNsPerJob"] = double(denseNs) / scanned;
+    obj["objectBytesPerJob"] = double(sizeof(CronJob)) + (m_jobs.isEmpty() ? 0.0 : double(stringBytes) / m_jobs.size());
+    obj["denseBytesPerJob"] = double(ScheduleTable::bytesPerJob());
+    obj["dueJobs"] = double(dueJobs) / rounds;
+    return obj;
+}
+
+bool CronManager::setTraceFile(const QString& path)
+{
+    if (m_trace) {
+        emit logMessage(QString("Stopped recording job runs to %1").arg(m_trace->fileName()));
+        delete m_trace;   // Writes out what is buffered
+        m_trace = nullptr;
+    }
+    if (path.isEmpty()) {
+        return true;
+    }
+    
+    TraceRecorder* trace = new TraceRecorder(this);
+    if (!trace->open(path)) {
+        emit logMessage(QString("Cannot record job runs to %1: %2").arg(path, trace->errorString()));
+        delete trace;
+        return false;
+    }
+    m_trace = trace;
+    emit logMessage(QString("Recording job runs to %1").arg(path));
+    return true;
+}
+
+void CronManager::setClock(SchedulerClock* clock)
+{
+    m_clock = clock ? clock : SchedulerClock::system();
+    if (m_cluster) {
+        m_cluster->setClock(m_clock);
+    }
+    // Retention is judged on scheduler time too
+    OutputIndex* index = m_outputIndex;
+    const SchedulerClock* indexClock = m_clock;
+    QMetaObject::invokeMethod(index, [index, indexClock]() { index->setClock(indexClock); }, Qt::QueuedConnection);
+}
+
+QString CronManager::traceFile() const
+{
+    return m_trace ? m_trace->fileName() : QString();
+}
+
+void CronManager::noteStarted(CronJob& job, qint64 slotMs)
+{
+    // A retry leaves lastRun on the failed run's slot, so the regular runs
+    // keep their cadence instead of moving to wherever the retry landed
+    if (job.retryAttempt == 0 || job.triggerType != CronJob::IntervalTrigger) {
+        job.lastRun = currentTime();
+    }
+    scheduleNextRun(job, slotMs);
+}
+
+void CronManager::scheduleNextRun(CronJob& job, qint64 slotMs)
+{
+    ScheduleTable::scheduleNextRun(job, currentTime(), slotMs, m_cluster != nullptr);
+}
+
+qint64 CronManager::runDeadline(const CronJob& job)
+{
+    // Fixed when the run first comes due, so holding it back (deferral, a
+    // full group) doesn't move it along with nextRun
+    auto it = m_pendingDeadlines.constFind(job.id);
+    if (it != m_pendingDeadlines.constEnd()) {
+        return it.value();
+    }
+    if (!job.hasDeadline() || job.retryAttempt > 0 || !job.nextRun.isValid()) {
+        return ScheduleTable::NEVER;
+    }
+    const qint64 deadlineMs = job.nextRun.toMSecsSinceEpoch() + job.deadlineMinutes * 60000LL;
+    m_pendingDeadlines.insert(job.id, deadlineMs);
+    return deadlineMs;
+}
+
+qint64 CronManager::startDeadline(const CronJob& job, RunTiming& timing)
+{
+    // Fills in the run's start and deadline. Returns the run's slot if it is
+    // starting ahead of it, else -1.
+    const qint64 nowMs = m_clock->nowMs();
+    timing.startedMs = nowMs;
+    auto it = m_pendingDeadlines.find(job.id);
+    if (it == m_pendingDeadlines.end()) {
+        return -1;
+    }
+    const qint64 deadlineMs = it.value();
+    m_pendingDeadlines.erase(it);
+    timing.deadlineMs = deadlineMs;
+    
+    const qint64 slotMs = deadlineMs - job.deadlineMinutes * 60000LL;
+    const qint64 expectedMs = job.expectedDurationMs();
+    bool counted = false;
+    if (slotMs > nowMs) {
+        ++m_stats.earlyStarts;
+        counted = true;
+        emit logMessage(QString("Starting %1 %2 s early: it takes up to %3 s and should finish by %4")
+            .arg(job.name).arg((slotMs - nowMs) / 1000).arg(expectedMs / 1000)
+            .arg(QDateTime::fromMSecsSinceEpoch(deadlineMs).toString("hh:mm:ss")));
+    }
+    if (expectedMs > 0 && nowMs + expectedMs > deadlineMs) {
+        ++m_stats.predictedMisses;
+        counted = true;
+        const QString message = QString("%1 is likely to miss its deadline: expected to finish at %2, due by %3")
+            .arg(job.name, QDateTime::fromMSecsSinceEpoch(nowMs + expectedMs).toString("hh:mm:ss"),
+                 QDateTime::fromMSecsSinceEpoch(deadlineMs).toString("hh:mm:ss"));
+        emit logMessage(message);
+        emit deadlineAlert(job.id, message);
+    }
+    if (counted) {
+        emit statsChanged(m_stats);
+    }
+    return slotMs > nowMs ? slotMs : -1;
+}
+
+void CronManager::onFileTriggered(const QString& jobId, const QStringList& changedFiles)
+{
+    if (!m_running) {
+        return;
+    }
+
+    // With a shared drop folder every node sees the change; only the owner runs it
+    if (m_cluster && !m_cluster->ownsJob(jobId)) {
+        return;
+    }
+    
+    CronJob* job = getJob(jobId);
+    if (job && job->enabled) {
+        if (job->isPaused(currentTime())) {
+            emit logMessage(QString("File change ignored for %1: paused after repeated failures until %2")
+                .arg(job->name, job->pausedUntil.toString("hh:mm:ss")));
             return;
         }
+        emit logMessage(QString("File change detected for %1: %2").arg(job->name, changedFiles.join(", ")));
+        executeJob(*job, changedFiles);
     }
 }
 
-void CronManager::removeJob(const QString& id)
+void CronManager::onSlotOrphaned(const QString& jobId, qint64 slot, const QString& formerHolder)
 {
-    for (int i = 0; i < m_jobs.size(); ++i) {
-        if (m_jobs[i].id == id) {
-            QString name = m_jobs[i].name;
-            m_jobs.removeAt(i);
-            saveJobs();
-            emit jobsChanged();
-            emit logMessage(QString("Removed job: %1").arg(name));
-            return;
-        }
+    CronJob* job = getJob(jobId);
+    if (!m_running || !job || !job->enabled) {
+        m_cluster->finishLease(jobId, slot);   // Nothing to run; release the slot
+        return;
+    }
+    m_pendingLeases.insert(jobId, slot);
+    emit logMessage(QString("Taking over %1 from %2, which left the cluster before finishing it")
+        .arg(job->name, formerHolder));
+    const int handle = m_jobIndex.value(jobId);
+    if (groupFull(job->group)) {
+        waitForGroup(*job, handle);
+        return;
     }
+    executeJob(*job);
 }
 
-CronJob* CronManager::getJob(const QString& id)
+void CronManager::executeJob(CronJob& job, const QStringList& changedFiles, qint64 dueMs)
 {
-    for (int i = 0; i < m_jobs.size(); ++i) {
-        if (m_jobs[i].id == id) {
-            return &m_jobs[i];
+    LoopWatchdog::Scope scope("CronManager::executeJob");
+    if (!m_dryRun && job.runInProcess && m_plugins->isRunning(job.id)) {
+        // Skip this slot rather than queue calls behind a slow one
+        emit logMessage(QString("Skipping %1: its previous run has not finished").arg(job.name));
+        job.nextRun = job.triggerType == CronJob::IntervalTrigger
+            ? currentTime().addMSecs(job.intervalMs()) : QDateTime();
+        job.retryAttempt = 0;
+        m_pendingDeadlines.remove(job.id);
+        releaseLease(job.id);
+        syncSchedule(job);
+        notifyJobUpdated(job);
+        return;
+    }
+    
+    RunTiming timing;
+    const qint64 slotMs = startDeadline(job, timing);
+    if (m_pendingLeases.contains(job.id)) {
+        timing.leaseSlot = m_pendingLeases.take(job.id);
+    }
+    if (m_dryRun) {
+        noteStarted(job, slotMs);
+        syncSchedule(job);
+        beginGroupRun(job);
+        const StubRun run = { job.id, timing };
+        m_stubRuns.insert(timing.startedMs + (job.averageDurationMs > 0 ? job.averageDurationMs : 60000), run);
+        return;
+    }
+    
+    if (job.runInProcess) {
+        emit logMessage(QString("Running in-process: %1 (%2)").arg(job.name, job.scriptPath));
+        m_plugins->start(job);
+        m_pluginRuns.insert(job.id, timing);
+        if (m_trace) {
+            // No spawn step: the call is running as soon as it is handed over
+            const int traceSlot = m_trace->beginRun(job.id, job.name, dueMs);
+            m_trace->started(traceSlot);
+            m_pluginTraces.insert(job.id, qMakePair(QPointer<TraceRecorder>(m_trace), traceSlot));
+        }
+        beginGroupRun(job);
+        noteStarted(job, slotMs);
+        syncSchedule(job);
+        if (!m_cluster) {
+            scheduleSave();
+        }
+        notifyJobUpdated(job);
+        return;
+    }
+    
+    emit logMessage(QString("Executing job: %1").arg(job.name));
+    emit logMessage(QString("Script path: %1").arg(job.scriptPath));
+    
+    const LaunchInfo launch = launchInfo(job);
+    if (job.useCustomCommand && !job.customCommand.isEmpty()) {
+        emit logMessage(QString("Using custom command: %1").arg(job.customCommand));
+    }
+    
+    // Log the full command being executed
+    emit logMessage(QString("Running: %1 %2").arg(launch.program, launch.arguments.join(" ")));
+    
+    JobProcess* process = JobProcess::create(m_launcher, this);
+    if (!launch.workingDirectory.isEmpty()) {
+        emit logMessage(QString("Working directory: %1").arg(launch.workingDirectory));
+    }
+    
+    QProcessEnvironment env = m_environment;
+    if (!changedFiles.isEmpty()) {
+        // Tell file-triggered jobs which files changed
+        env.insert("CRONGUI_CHANGED_FILES", changedFiles.join("\n"));
+    }
+    
+    QString jobId = job.id;
+    // On disk before the process exists, so a crash at any point leaves a
+    // record saying whether this slot ran
+    const QString runId = m_journal->launch(jobId, job.lastRun.isValid() ? job.lastRun.toMSecsSinceEpoch() : -1,
+                                            m_clock->nowMs());
+    connect(process, &JobProcess::started, this, [this, process, runId]() {
+        m_journal->started(runId, process->processId());
+    });
+    if (job.triggerType == CronJob::FileChangeTrigger && job.maxRetries > 0 && !changedFiles.isEmpty()) {
+        m_retryFiles.insert(jobId, changedFiles);
+    }
+    
+    // A recorder replaced mid-run is gone by the time the run ends; skip it then
+    QPointer<TraceRecorder> trace = m_trace;
+    const int traceSlot = trace ? trace->beginRun(jobId, job.name, dueMs) : -1;
+    if (trace) {
+        connect(process, &JobProcess::started, this, [trace, traceSlot]() {
+            if (trace) {
+                trace->started(traceSlot);
+            }
+        });
+    }
+    
+    // Read output as it comes, so it can be shown live
+    auto onOutput = [this, process, trace, traceSlot](QProcess::ProcessChannel channel) {
+        if (readOutput(process, channel) && trace) {
+            trace->firstOutput(traceSlot);
+        }
+    };
+    connect(process, &JobProcess::readyReadStandardOutput, this, [onOutput]() { onOutput(QProcess::StandardOutput); });
+    connect(process, &JobProcess::readyReadStandardError, this, [onOutput]() { onOutput(QProcess::StandardError); });
+    
+    connect(process, &JobProcess::finished, this, [this, process, jobId, runId, trace, traceSlot](int exitCode, bool crashed) {
+        readOutput(process, QProcess::StandardOutput);
+        readOutput(process, QProcess::StandardError);
+        RunningProcess& running = m_processes[process];
+        const RunTiming timing = running.timing;
+        QString output = QString::fromUtf8(running.output);
+        QString error = QString::fromUtf8(running.errors);
+        bool success = (exitCode == 0 && !crashed);
+        
+        // Whatever the live view hasn't had yet, including unfinished lines;
+        // each channel's last line goes out on its own so they don't run together
+        for (const QByteArray* rest : {&running.tail, &running.partialOutput, &running.partialError}) {
+            if (!rest->isEmpty()) {
+                emit jobOutput(jobId, QString::fromUtf8(*rest));
+            }
+        }
+        
+        QString fullOutput = output;
+        if (!error.isEmpty()) {
+            fullOutput += "\nErrors:\n" + error;
+        }
+        if (running.droppedBytes > 0) {
+            fullOutput += QString("\n[%1 more bytes of output were not kept]").arg(running.droppedBytes);
+        }
+        
+        if (crashed) {
+            emit logMessage("Job error: Process crashed");
+        }
+        emit logMessage(QString("Job completed with exit code: %1").arg(exitCode));
+        const RunUsage usage = takeUsage(process);
+        if (trace) {
+            trace->finished(traceSlot, success, exitCode);
+        }
+        m_journal->ended(runId);
+        finishRun(jobId, success, fullOutput, timing, usage);
+        
+        process->deleteLater();
+    });
+    
+    connect(process, &JobProcess::failedToStart, this, [this, process, jobId, runId, trace, traceSlot](const QString& error) {
+        emit logMessage(QString("Job error: %1").arg(error));
+        if (trace) {
+            trace->failedToStart(traceSlot, error);
         }
+        const RunTiming timing = m_processes.value(process).timing;
+        takeUsage(process);
+        m_journal->ended(runId);
+        finishRun(jobId, false, error, timing);
+        process->deleteLater();
+    });
+    
+    // Update job timing
+    noteStarted(job, slotMs);
+    syncSchedule(job);
+    if (!m_cluster) {
+        // Run times are per node in a cluster; keep them out of the shared file
+        scheduleSave();
+    }
+    notifyJobUpdated(job);
+    
+    RunningProcess running;
+    running.jobId = jobId;
+    running.timing = timing;
+    m_processes.insert(process, running);
+    beginGroupRun(job);
+    if (m_launcher != JobProcess::SpawnBackend && !m_usageTimer->isActive()) {
+        // Only the spawn backend gets exact figures at exit
+        m_usageTimer->start();
+    }
+    
+    process->start(launch.program, launch.arguments, launch.workingDirectory, env);
+    if (process->processId() > 0) {
+        // The spawn backend knows the pid as soon as start() returns; journal
+        // it now, so a crash before the queued started() can't run the slot twice
+        m_journal->started(runId, process->processId());
     }
-    return nullptr;
 }
 
-QVector<CronJob>& CronManager::getJobs()
+void CronManager::sampleUsage()
 {
-    return m_jobs;
+    LoopWatchdog::Scope scope("CronManager::sampleUsage");
+    for (auto it = m_processes.begin(); it != m_processes.end(); ++it) {
+        it.value().sampled.merge(ProcessStats::processUsage(it.key()->processId()));
+    }
 }
 
-void CronManager::runJobNow(const QString& id)
+bool CronManager::readOutput(JobProcess* process, QProcess::ProcessChannel channel)
 {
-    for (int i = 0; i < m_jobs.size(); ++i) {
-        if (m_jobs[i].id == id) {
-            emit logMessage(QString("Manually running job: %1").arg(m_jobs[i].name));
-            executeJob(m_jobs[i]);
-            return;
+    LoopWatchdog::Scope scope("CronManager::readOutput");
+    auto it = m_processes.find(process);
+    if (it == m_processes.end()) {
+        return false;
+    }
+    const bool isError = channel == QProcess::StandardError;
+    const QByteArray data = isError ? process->readAllStandardError() : process->readAllStandardOutput();
+    if (data.isEmpty()) {
+        return false;
+    }
+    
+    RunningProcess& running = it.value();
+    const bool first = running.output.isEmpty() && running.errors.isEmpty();
+    const int room = qMax(0, MAX_RUN_OUTPUT_BYTES - running.output.size() - running.errors.size());
+    (isError ? running.errors : running.output) += data.left(room);
+    running.droppedBytes += qMax(0, data.size() - room);
+    
+    // Only whole lines go out live, so a batch never splits a character.
+    // A line that never ends goes out in pieces rather than piling up.
+    QByteArray& partial = isError ? running.partialError : running.partialOutput;
+    partial += data;
+    const int end = partial.lastIndexOf('\n');
+    if (end < 0 && partial.size() < OUTPUT_TAIL_BYTES) {
+        return first;
+    }
+    const int length = end >= 0 ? end + 1 : partial.size();
+    running.tail += partial.left(length);
+    partial.remove(0, length);
+    if (running.tail.size() > OUTPUT_TAIL_BYTES) {
+        // The view keeps the last screenful; drop older lines here already
+        running.tail = running.tail.right(OUTPUT_TAIL_BYTES);
+        const int lineStart = running.tail.indexOf('\n');
+        if (lineStart >= 0 && lineStart < running.tail.size() - 1) {
+            running.tail.remove(0, lineStart + 1);
         }
     }
-    emit logMessage(QString("Job not found: %1").arg(id));
+    if (!m_outputTimer->isActive()) {
+        m_outputTimer->start();
+    }
+    return first;
 }
 
-void CronManager::start()
+void CronManager::emitOutput()
 {
-    if (!m_running) {
-        m_running = true;
-        m_timer->start(30000); // Check every 30 seconds
-        emit logMessage("Cron scheduler started");
-        // Run initial check
-        checkAndRunJobs();
+    for (auto it = m_processes.begin(); it != m_processes.end(); ++it) {
+        if (!it.value().tail.isEmpty()) {
+            emit jobOutput(it.value().jobId, QString::fromUtf8(it.value().tail));
+            it.value().tail.clear();
+        }
     }
 }
 
-void CronManager::stop()
+RunUsage CronManager::takeUsage(JobProcess* process)
 {
-    if (m_running) {
-        m_running = false;
-        m_timer->stop();
-        emit logMessage("Cron scheduler stopped");
+    const RunningProcess running = m_processes.take(process);
+    if (m_processes.isEmpty()) {
+        m_usageTimer->stop();
     }
+    
+    // Exact totals from the backend where it has them; samples otherwise,
+    // which miss the process's last moments
+    RunUsage usage = running.sampled;
+    usage.merge(process->usage());
+    return usage;
 }
 
-void CronManager::checkAndRunJobs()
+void CronManager::finishRun(const QString& jobId, bool success, const QString& output, const RunTiming& timing,
+                            const RunUsage& usage, bool freeGroupSlot)
 {
-    QDateTime now = QDateTime::currentDateTime();
+    LoopWatchdog::Scope scope("CronManager::finishRun");
+    emit jobExecuted(jobId, success, output);
+    if (!m_dryRun) {
+        OutputIndex* index = m_outputIndex;
+        const qint64 finishedMs = m_clock->nowMs();
+        QMetaObject::invokeMethod(index, [index, jobId, finishedMs, success, output]() {
+            index->addRun(jobId, finishedMs, success, output);
+        }, Qt::QueuedConnection);
+    }
     
-    for (int i = 0; i < m_jobs.size(); ++i) {
-        if (m_jobs[i].isDue()) {
-            executeJob(m_jobs[i]);
+    if (m_cluster && timing.leaseSlot >= 0) {
+        m_cluster->finishLease(jobId, timing.leaseSlot);
+    }
+    
+    // Its group slot is free; hand it on once this run is recorded
+    const QString freedGroup = freeGroupSlot ? endGroupRun(jobId) : QString();
+    CronJob* job = getJob(jobId);
+    if (!job) {
+        startQueued(freedGroup);
+        return;  // Removed while it was running
+    }
+    
+    ++job->runCount;
+    job->lastCpuMs = usage.cpuMs;
+    job->lastPeakRssBytes = usage.peakRssBytes;
+    job->lastReadBytes = usage.readBytes;
+    job->lastWriteBytes = usage.writeBytes;
+    const qint64 finishedMs = m_clock->nowMs();
+    if (timing.startedMs >= 0) {
+        // Smoothed, so one slow run doesn't skew the forecast. The spread is
+        // tracked alongside (as TCP does for round trips) so deadlines can
+        // allow for runs that vary a lot. Measured from this run's own start:
+        // lastRun may already belong to a later, overlapping run.
+        qint64 durationMs = qMin<qint64>(finishedMs - timing.startedMs, INT_MAX);
+        if (job->averageDurationMs == 0) {
+            job->averageDurationMs = int(durationMs);
+            job->durationDeviationMs = int(durationMs / 2);
+        } else {
+            const qint64 deviationMs = qAbs(durationMs - job->averageDurationMs);
+            job->durationDeviationMs = int((3LL * job->durationDeviationMs + deviationMs) / 4);
+            job->averageDurationMs = int((3LL * job->averageDurationMs + durationMs) / 4);
+        }
+    }
+    const qint64 deadlineMs = timing.deadlineMs;
+    if (deadlineMs != ScheduleTable::NEVER && finishedMs > deadlineMs) {
+        ++m_stats.deadlineMisses;
+        const QString message = QString("%1 missed its deadline of %2 by %3 s")
+            .arg(job->name, QDateTime::fromMSecsSinceEpoch(deadlineMs).toString("hh:mm:ss"))
+            .arg((finishedMs - deadlineMs) / 1000);
+        emit logMessage(message);
+        emit deadlineAlert(jobId, message);
+        emit statsChanged(m_stats);
+    }
+    if (success) {
+        if (job->pausedUntil.isValid()) {
+            emit logMessage(QString("%1 succeeded again; resuming its schedule").arg(job->name));
+        }
+        job->consecutiveFailures = 0;
+        job->retryAttempt = 0;
+        job->pausedUntil = QDateTime();
+        m_retryFiles.remove(jobId);
+    } else {
+        ++job->failureCount;
+        ++job->consecutiveFailures;
+        if (job->breakerThreshold > 0 && job->consecutiveFailures >= job->breakerThreshold) {
+            // Open the circuit: stop hammering whatever is broken and probe
+            // with a single run once the cooldown is over
+            job->retryAttempt = 0;
+            job->pausedUntil = currentTime().addSecs(job->breakerCooldownMinutes * 60);
+            job->calculateNextRun(currentTime());
+            m_retryFiles.remove(jobId);
+            emit logMessage(QString("%1 failed %2 time(s) in a row; paused until %3")
+                .arg(job->name).arg(job->consecutiveFailures).arg(job->pausedUntil.toString("yyyy-MM-dd hh:mm:ss")));
+        } else if (job->retryAttempt < job->maxRetries) {
+            // Retries are ordinary timer entries, so they queue with everything else
+            QDateTime retryAt = currentTime().addMSecs(retryDelayMs(*job));
+            if (job->triggerType == CronJob::IntervalTrigger && job->nextRun.isValid() && job->nextRun <= retryAt) {
+                job->retryAttempt = 0;  // The regular run comes first anyway
+            } else {
+                ++job->retryAttempt;
+                job->nextRun = retryAt;
+                emit logMessage(QString("Retrying %1 at %2 (attempt %3 of %4)")
+                    .arg(job->name, retryAt.toString("hh:mm:ss")).arg(job->retryAttempt).arg(job->maxRetries));
+            }
+        } else {
+            if (job->retryAttempt > 0) {
+                emit logMessage(QString("%1 still failing after %2 retries").arg(job->name).arg(job->retryAttempt));
+            }
+            job->retryAttempt = 0;
+            job->calculateNextRun(currentTime());
+            m_retryFiles.remove(jobId);
         }
     }
+    
+    syncSchedule(*job);
+    if (!m_cluster) {
+        scheduleSave();
+    }
+    emit jobUpdated(*job);
+    startQueued(freedGroup);
+    armTimer();
 }
 
-void CronManager::executeJob(CronJob& job)
+qint64 CronManager::retryDelayMs(const CronJob& job)
 {
-    emit logMessage(QString("Executing job: %1").arg(job.name));
-    emit logMessage(QString("Script path: %1").arg(job.scriptPath));
+    // Exponential backoff capped at an hour, with "equal jitter": half of the
+    // delay is fixed and half random, so jobs that failed together on a shared
+    // dependency don't all retry at the same moment
+    const qint64 maxDelayMs = 3600000;
+    qint64 delayMs = qMin(qMax(job.retryDelaySeconds, 1) * 1000LL << qMin(job.retryAttempt, 16), maxDelayMs);
+    return delayMs / 2 + m_jitter.bounded(static_cast<int>(delayMs / 2) + 1);
+}
+
+const CronManager::LaunchInfo& CronManager::launchInfo(const CronJob& job)
+{
+    auto cached = m_launchCache.constFind(job.id);
+    if (cached != m_launchCache.constEnd()) {
+        return cached.value();
+    }
     
-    QProcess* process = new QProcess(this);
-    QString program;
-    QStringList args;
+    LaunchInfo launch;
+    QStringList& args = launch.arguments;
     
     // Check if user specified a custom command
     if (job.useCustomCommand && !job.customCommand.isEmpty()) {
         // Parse custom command - it might contain arguments like "python -u" or "java -jar"
         QStringList cmdParts = job.customCommand.trimmed().split(" ", Qt::SkipEmptyParts);
         if (!cmdParts.isEmpty()) {
-            program = cmdParts.takeFirst();  // First part is the program
-            args = cmdParts;                  // Rest are arguments to the program
+            launch.program = cmdParts.takeFirst();  // First part is the program
+            args = cmdParts;                         // Rest are arguments to the program
         }
         args.append(job.scriptPath);  // Add script path
-        emit logMessage(QString("Using custom command: %1").arg(job.customCommand));
     } else {
         // Auto-detect based on file extension
         QFileInfo fileInfo(job.scriptPath);
         QString ext = fileInfo.suffix().toLower();
         
         if (ext == "py") {
-            program = "python";
+            launch.program = "python";
             args.append(job.scriptPath);
         } else if (ext == "ps1") {
-            program = "powershell";
+            launch.program = "powershell";
             args.append("-ExecutionPolicy");
             args.append("Bypass");
             args.append("-File");
             args.append(job.scriptPath);
         } else if (ext == "bat" || ext == "cmd") {
-            program = "cmd";
+            launch.program = "cmd";
             args.append("/c");
             args.append(job.scriptPath);
         } else if (ext == "js") {
-            program = "node";
+            launch.program = "node";
             args.append(job.scriptPath);
         } else if (ext == "rb") {
-            program = "ruby";
+            launch.program = "ruby";
             args.append(job.scriptPath);
         } else if (ext == "pl") {
-            program = "perl";
+            launch.program = "perl";
             args.append(job.scriptPath);
         } else if (ext == "php") {
-            program = "php";
+            launch.program = "php";
             args.append(job.scriptPath);
         } else if (ext == "sh") {
-            program = "bash";
+            launch.program = "bash";
             args.append(job.scriptPath);
         } else {
             // For .exe and unknown extensions, run directly
-            program = job.scriptPath;
+            launch.program = job.scriptPath;
         }
     }
     
@@ -181,16 +1483,17 @@ void CronManager::executeJob(CronJob& job)
         args.append(job.arguments.split(" ", Qt::SkipEmptyParts));
     }
     
-    // Log the full command being executed
-    emit logMessage(QString("Running: %1 %2").arg(program, args.join(" ")));
-    
     // Set working directory to the script's folder
     QFileInfo scriptInfo(job.scriptPath);
     if (scriptInfo.exists()) {
-        process->setWorkingDirectory(scriptInfo.absolutePath());
-        emit logMessage(QString("Working directory: %1").arg(scriptInfo.absolutePath()));
+        launch.workingDirectory = scriptInfo.absolutePath();
     }
     
+    return m_launchCache.insert(job.id, launch).value();
+}
+
+QProcessEnvironment CronManager::buildEnvironment()
+{
     // Set environment variables for proper UTF-8 encoding (fixes Unicode/emoji issues on Windows)
     QProcessEnvironment env = QProcessEnvironment::systemEnvironment();
     
@@ -215,52 +1518,14 @@ void CronManager::executeJob(CronJob& job)
     // Set console output code page to UTF-8 for cmd/batch scripts
     env.insert("CHCP", "65001");
     
-    process->setProcessEnvironment(env);
-    
-    QString jobId = job.id;
-    
-    connect(process, QOverload<int, QProcess::ExitStatus>::of(&QProcess::finished),
-            this, [this, process, jobId](int exitCode, QProcess::ExitStatus status) {
-        QString output = process->readAllStandardOutput();
-        QString error = process->readAllStandardError();
-        bool success = (exitCode == 0 && status == QProcess::NormalExit);
-        
-        QString fullOutput = output;
-        if (!error.isEmpty()) {
-            fullOutput += "\nErrors:\n" + error;
-        }
-        
-        emit jobExecuted(jobId, success, fullOutput);
-        emit logMessage(QString("Job completed with exit code: %1").arg(exitCode));
-        
-        process->deleteLater();
-    });
-    
-    connect(process, &QProcess::errorOccurred, this, [this, process, jobId](QProcess::ProcessError error) {
-        QString errorMsg;
-        switch(error) {
-            case QProcess::FailedToStart: errorMsg = "Failed to start"; break;
-            case QProcess::Crashed: errorMsg = "Process crashed"; break;
-            case QProcess::Timedout: errorMsg = "Timed out"; break;
-            default: errorMsg = "Unknown error"; break;
-        }
-        emit jobExecuted(jobId, false, errorMsg);
-        emit logMessage(QString("Job error: %1").arg(errorMsg));
-        process->deleteLater();
-    });
-    
-    // Update job timing
-    job.lastRun = QDateTime::currentDateTime();
-    job.calculateNextRun();
-    saveJobs();
-    emit jobsChanged();
-    
-    process->start(program, args);
+    return env;
 }
 
 QString CronManager::getConfigPath()
 {
-    QString configDir = QStandardPaths::writableLocation(QStandardPaths::AppDataLocation);
+    QString configDir = m_configDir.isEmpty()
+        ? QStandardPaths::writableLocation(QStandardPaths::AppDataLocation)
+        : m_configDir;
     QDir dir(configDir);
     if (!dir.exists()) {
         dir.mkpath(".");
@@ -268,19 +1533,196 @@ QString CronManager::getConfigPath()
     return configDir + "/cronjobs.json";
 }
 
+QString CronManager::stateDir()
+{
+    // Written while jobs run, so kept out of the watched config folder
+    const QString dir = QFileInfo(getConfigPath()).absolutePath() + "/state";
+    QDir().mkpath(dir);
+    return dir;
+}
+
+void CronManager::migrateState()
+{
+    // Older versions kept these next to cronjobs.json
+    const QDir configDir = QFileInfo(getConfigPath()).absoluteDir();
+    const QDir state(stateDir());
+    const QStringList names = configDir.entryList(
+        QStringList() << "groups.json" << "inflight*.jsonl" << "output" << "output-*", QDir::Files | QDir::Dirs | QDir::NoDotAndDotDot);
+    for (const QString& name : names) {
+        if (!state.exists(name) && QDir().rename(configDir.filePath(name), state.filePath(name))) {
+            emit logMessage(QString("Moved %1 to %2").arg(name, state.absolutePath()));
+        }
+    }
+}
+
+void CronManager::recoverRuns()
+{
+    const QDateTime now = currentTime();
+    bool changed = false;
+    const QVector<RunJournal::OpenRun> runs = m_journal->recoveredRuns();
+    for (const RunJournal::OpenRun& run : runs) {
+        CronJob* job = getJob(run.jobId);
+        const QString name = job ? job->name : run.jobId;
+        const QDateTime launched = QDateTime::fromMSecsSinceEpoch(run.launchedMs);
+        
+        if (run.pid <= 0) {
+            // Launched on paper only: the slot never ran, so give it back.
+            // Its lastRun may or may not have been saved; the journal knows.
+            if (job && (!job->lastRun.isValid() || job->lastRun <= launched)) {
+                job->lastRun = run.previousLastRunMs >= 0
+                    ? QDateTime::fromMSecsSinceEpoch(run.previousLastRunMs) : QDateTime();
+                job->calculateNextRun(now);
+                changed = true;
+            }
+            emit logMessage(QString("Run of %1 was cut off before its process started; it is due again").arg(name));
+            m_journal->ended(run.runId);
+            continue;
+        }
+        
+        // The slot did run. Make sure it counts as run even if the save
+        // that recorded it was lost, so it isn't run a second time.
+        if (job && (!job->lastRun.isValid() || job->lastRun < launched)) {
+            job->lastRun = launched;
+            job->calculateNextRun(now);
+            changed = true;
+        }
+        if (run.pidStart >= 0 && ProcessStats::processStartTime(run.pid) == run.pidStart) {
+            emit logMessage(QString("Run of %1 (pid %2) outlived the last session; watching it until it ends")
+                .arg(name).arg(run.pid));
+            m_journal->watchOrphan(run);
+        } else {
+            emit logMessage(QString("Run of %1 started %2 ended while the app was not running; its result is unknown")
+                .arg(name, launched.toString("yyyy-MM-dd hh:mm:ss")));
+            m_journal->ended(run.runId);
+        }
+    }
+    
+    if (changed) {
+        rebuildSchedule();
+        if (!m_cluster) {
+            scheduleSave();
+        }
+    }
+}
+
+void CronManager::scheduleSave()
+{
+    if (!m_saveTimer->isActive()) {
+        m_saveTimer->start();
+    }
+}
+
 void CronManager::saveJobs()
 {
+    LoopWatchdog::Scope scope("CronManager::saveJobs");
+    m_saveTimer->stop();
+    if (m_dryRun) {
+        return;   // A replay must never overwrite the real job list
+    }
+    
     QJsonArray jobsArray;
-    for (const CronJob& job : m_jobs) {
-        jobsArray.append(job.toJson());
+    for (int i : jobOrder()) {
+        jobsArray.append(m_jobs[i].toJson());
     }
     
-    QJsonDocument doc(jobsArray);
-    QFile file(getConfigPath());
+    // Written aside and renamed over the old file, so a batch change is
+    // either saved whole or not at all
+    QByteArray data = QJsonDocument(jobsArray).toJson();
+    QSaveFile file(getConfigPath());
+    if (file.open(QIODevice::WriteOnly)) {
+        file.write(data);
+        if (file.commit()) {
+            m_configHash = QCryptographicHash::hash(data, QCryptographicHash::Sha1);
+            m_configStamp = configStamp();
+        }
+    }
+    syncRetention();
+}
+
+void CronManager::syncRetention()
+{
+    QHash<QString, int> retention;
+    for (const CronJob& job : qAsConst(m_jobs)) {
+        if (job.keepOutputDays > 0) {
+            retention.insert(job.id, job.keepOutputDays);
+        }
+    }
+    if (retention == m_retention) {
+        return;
+    }
+    m_retention = retention;
+    OutputIndex* index = m_outputIndex;
+    QMetaObject::invokeMethod(index, [index, retention]() { index->setRetention(retention); }, Qt::QueuedConnection);
+}
+
+void CronManager::loadGroups()
+{
+    QFile file(stateDir() + "/groups.json");
+    if (!file.open(QIODevice::ReadOnly)) {
+        return;
+    }
+    const QJsonArray groups = QJsonDocument::fromJson(file.readAll()).array();
+    for (const QJsonValue& val : groups) {
+        JobGroup group = JobGroup::fromJson(val.toObject());
+        if (!group.name.isEmpty()) {
+            m_groups.insert(group.name, group);
+        }
+    }
+}
+
+void CronManager::saveGroups()
+{
+    if (m_dryRun) {
+        return;
+    }
+    QJsonArray groups;
+    for (const JobGroup& group : qAsConst(m_groups)) {
+        groups.append(group.toJson());
+    }
+    QSaveFile file(stateDir() + "/groups.json");
     if (file.open(QIODevice::WriteOnly)) {
-        file.write(doc.toJson());
-        file.close();
+        file.write(QJsonDocument(groups).toJson());
+        file.commit();
+    }
+}
+
+bool CronManager::readConfig(QVector<CronJob>& jobs, QByteArray& hash)
+{
+    QFile file(getConfigPath());
+    if (!file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+    
+    m_configStamp = configStamp();
+    QByteArray data = file.readAll();
+    file.close();
+    hash = QCryptographicHash::hash(data, QCryptographicHash::Sha1);
+    
+    QJsonDocument doc = QJsonDocument::fromJson(data);
+    if (!doc.isArray()) {
+        return false;
+    }
+    
+    QJsonArray jobsArray = doc.array();
+    jobs.clear();
+    jobs.reserve(jobsArray.size());
+    QSet<QString> pool;
+    for (const QJsonValue& val : jobsArray) {
+        if (!val.isObject()) {
+            continue;
+        }
+        // A hand-edited file gets the same checks as an import; an interval
+        // of 0 would otherwise run the job in a tight loop
+        CronJob job = CronJob::fromJson(val.toObject());
+        QString error;
+        if (!CronImporter::validateJob(job, error)) {
+            emit logMessage(QString("Skipping job %1 in %2: %3").arg(job.id, getConfigPath(), error));
+            continue;
+        }
+        internStrings(job, pool);
+        jobs.append(job);
     }
+    return true;
 }
 
 void CronManager::loadJobs()
@@ -290,22 +1732,135 @@ void CronManager::loadJobs()
         return;
     }
     
-    if (file.open(QIODevice::ReadOnly)) {
-        QByteArray data = file.readAll();
-        file.close();
+    QVector<CronJob> jobs;
+    QByteArray hash;
+    if (readConfig(jobs, hash)) {
+        m_jobs = jobs;
+        m_configHash = hash;
+    }
+    renumberJobs();
+    rebuildSchedule();
+    m_launchCache.clear();
+    m_fileTrigger->updateJobs(m_jobs);
+    emit logMessage(QString("Loaded %1 jobs").arg(m_jobs.size()));
+}
+
+void CronManager::watchConfig()
+{
+    QString path = getConfigPath();
+    QString dir = QFileInfo(path).absolutePath();
+    if (!m_configWatcher->directories().contains(dir)) {
+        m_configWatcher->addPath(dir);
+    }
+    // Saving by rename replaces the file and drops its watch
+    if (QFile::exists(path) && !m_configWatcher->files().contains(path)) {
+        m_configWatcher->addPath(path);
+    }
+}
+
+void CronManager::onConfigChanged()
+{
+    watchConfig();
+    m_reloadTimer->start();
+}
+
+void CronManager::onConfigDirChanged()
+{
+    // Something else in the folder changed; only a new or replaced job file
+    // is worth reading. Edits in place also arrive through the file's own watch.
+    watchConfig();
+    if (configStamp() != m_configStamp) {
+        m_reloadTimer->start();
+    }
+}
+
+QString CronManager::configStamp()
+{
+    const QFileInfo info(getConfigPath());
+    if (!info.exists()) {
+        return QString();
+    }
+    return QString("%1:%2").arg(info.size()).arg(info.lastModified().toMSecsSinceEpoch());
+}
+
+void CronManager::reloadJobs()
+{
+    LoopWatchdog::Scope scope("CronManager::reloadJobs");
+    QVector<CronJob> fileJobs;
+    QByteArray hash;
+    if (!readConfig(fileJobs, hash)) {
+        return;  // Missing or half-written; a later change will bring it back
+    }
+    if (hash == m_configHash) {
+        return;  // Our own write, or nothing changed
+    }
+    m_configHash = hash;
+    
+    QHash<QString, int> oldIndex;
+    oldIndex.reserve(m_jobs.size());
+    for (int i = 0; i < m_jobs.size(); ++i) {
+        oldIndex.insert(m_jobs[i].id, i);
+    }
+    
+    // Keep the in-memory job, with its runtime state, unless its settings changed
+    QVector<CronJob> jobs;
+    jobs.reserve(fileJobs.size());
+    QSet<QString> added;
+    QSet<QString> updated;
+    for (CronJob& job : fileJobs) {
+        auto it = oldIndex.find(job.id);
+        if (it == oldIndex.end()) {
+            job.calculateNextRun(currentTime());
+            added.insert(job.id);
+            jobs.append(job);
+            continue;
+        }
         
-        QJsonDocument doc = QJsonDocument::fromJson(data);
-        if (doc.isArray()) {
-            QJsonArray jobsArray = doc.array();
-            m_jobs.clear();
-            for (const QJsonValue& val : jobsArray) {
-                if (val.isObject()) {
-                    m_jobs.append(CronJob::fromJson(val.toObject()));
-                }
-            }
+        const CronJob& current = m_jobs[it.value()];
+        if (current.sameConfig(job)) {
+            jobs.append(current);
+        } else {
+            job.lastRun = current.lastRun;
+            job.copyRunHistory(current);
+            job.calculateNextRun(currentTime());
+            m_launchCache.remove(job.id);
+            unqueue(job.id);
+            updated.insert(job.id);
+            jobs.append(job);
         }
+        oldIndex.erase(it);
     }
-    emit logMessage(QString("Loaded %1 jobs").arg(m_jobs.size()));
+    
+    QStringList removed;
+    for (auto it = oldIndex.constBegin(); it != oldIndex.constEnd(); ++it) {
+        removed.append(it.key());
+        m_launchCache.remove(it.key());
+        unqueue(it.key());
+    }
+    
+    if (added.isEmpty() && updated.isEmpty() && removed.isEmpty()) {
+        return;
+    }
+    
+    m_jobs = jobs;
+    renumberJobs();
+    rebuildSchedule();
+    m_fileTrigger->updateJobs(m_jobs);
+    syncRetention();
+    armTimer();
+    
+    for (const QString& id : removed) {
+        emit jobRemoved(id);
+    }
+    for (const CronJob& job : m_jobs) {
+        if (added.contains(job.id)) {
+            emit jobAdded(job);
+        } else if (updated.contains(job.id)) {
+            emit jobUpdated(job);
+        }
+    }
+    emit logMessage(QString("Reloaded %1: %2 added, %3 changed, %4 removed")
+        .arg(QFileInfo(getConfigPath()).fileName()).arg(added.size()).arg(updated.size()).arg(removed.size()));
 }
 
 void CronManager::setAutoStart(bool enable)
@@ -6,48 +6,302 @@
 #include <QVector>
 #include <QProcess>
 #include <QSettings>
+#include <QHash>
+#include <QMultiMap>
+#include <QPointer>
+#include <QSet>
+#include <QStringList>
+#include <QProcessEnvironment>
+#include <QFileSystemWatcher>
+#include <QJsonObject>
+#include <QElapsedTimer>
+#include <QRandomGenerator>
+#include <QThread>
+#include <functional>
+#include <memory>
 #include "cronjob.h"
+#include "scheduletable.h"
+#include "admissioncontroller.h"
+#include "processstats.h"
+#include "schedulerclock.h"
+#include "jobprocess.h"
 
+class FileTrigger;
+class ClusterCoordinator;
+class TraceRecorder;
+class PluginExecutor;
+class RunJournal;
+class OutputIndex;
+class LoopWatchdog;
+
+// Scheduler health figures published to the GUI and the metrics export
+struct SchedulerStats {
+    qint64 firedRuns = 0;
+    qint64 lastLagMs = 0;      // Delay between a job becoming due and being started
+    qint64 maxLagMs = 0;
+    qint64 totalLagMs = 0;
+    qint64 lagSamples = 0;
+    qint64 firstRunMs = -1;    // From launch to the first scheduled run
+    QString clusterNode;       // Empty unless running in clustered mode
+    int clusterSize = 0;
+    qint64 deferrals = 0;      // Low-priority runs held back because the host was busy
+    qint64 forcedRuns = 0;     // Deferred runs started anyway after the maximum wait
+    int deferredJobs = 0;      // Jobs being held back right now
+    int groupWaiting = 0;      // Runs waiting for a free slot in their job group
+    qint64 earlyStarts = 0;    // Runs started ahead of their due time to meet a deadline
+    qint64 predictedMisses = 0; // Runs started when already expected to finish late
+    qint64 deadlineMisses = 0; // Runs that finished after their deadline
+    qint64 loopStalls = 0;     // Times the scheduler thread's event loop was blocked too long
+    qint64 longestStallMs = 0;
+    QString lastStallHandler;  // What was running during the last stall
+    QJsonObject loopLatency;   // Full watchdog figures; only filled in by stats()
+
+    QJsonObject toJson() const {
+        QJsonObject obj;
+        obj["firedRuns"] = firedRuns;
+        obj["lastLagMs"] = lastLagMs;
+        obj["maxLagMs"] = maxLagMs;
+        obj["avgLagMs"] = lagSamples > 0 ? double(totalLagMs) / lagSamples : 0.0;
+        obj["firstRunMs"] = firstRunMs;
+        obj["deferrals"] = deferrals;
+        obj["forcedRuns"] = forcedRuns;
+        obj["deferredJobs"] = deferredJobs;
+        obj["groupWaiting"] = groupWaiting;
+        obj["earlyStarts"] = earlyStarts;
+        obj["predictedMisses"] = predictedMisses;
+        obj["deadlineMisses"] = deadlineMisses;
+        obj["loopStalls"] = loopStalls;
+        obj["longestStallMs"] = longestStallMs;
+        if (!lastStallHandler.isEmpty()) {
+            obj["lastStallHandler"] = lastStallHandler;
+        }
+        if (!loopLatency.isEmpty()) {
+            obj["loopLatency"] = loopLatency;
+        }
+        if (!clusterNode.isEmpty()) {
+            obj["clusterNode"] = clusterNode;
+            obj["clusterSize"] = clusterSize;
+        }
+        return obj;
+    }
+};
+Q_DECLARE_METATYPE(SchedulerStats)
+
+// Owns the jobs, the timer and the job processes. It runs on its own
+// scheduler thread: other threads talk to it through queued calls and get
+// copies of jobs through signals, so a busy GUI never delays a job.
 class CronManager : public QObject
 {
     Q_OBJECT
 
 public:
-    explicit CronManager(QObject *parent = nullptr);
+    // configDir: where cronjobs.json lives (default: the app data folder).
+    // clusterNodeId: join the cluster sharing configDir under this node id.
+    explicit CronManager(const QString& configDir = QString(), const QString& clusterNodeId = QString(),
+                         QObject *parent = nullptr);
     ~CronManager();
 
     void addJob(const CronJob& job);
     void updateJob(const CronJob& job);
     void removeJob(const QString& id);
+    void importJobs(const QVector<CronJob>& jobs);  // Add or replace by id, saved once
     void runJobNow(const QString& id);  // Run a job immediately
+    
+    // Bulk changes, e.g. to a whole group: applied together, then saved
+    // once and reported with one jobsChanged(). Unknown ids are skipped.
+    void setJobsEnabled(const QStringList& ids, bool enabled);
+    void removeJobs(const QStringList& ids);
+    void runJobs(const QStringList& ids);
+    void setGroup(const JobGroup& group);   // Add or change a group's settings
+
+    // Scheduler thread only; other threads use the signals below
     CronJob* getJob(const QString& id);
-    QVector<CronJob>& getJobs();
+    const QVector<CronJob>& getJobs() const;
+    QVector<int> jobOrder() const;   // Positions in getJobs() in the order the jobs were added
+    SchedulerStats stats() const;
+    // Object scan vs. schedule table, for tuning. Runs in short slices
+    // between real work; done gets the result.
+    void benchmarkScan(int rounds, const std::function<void(const QJsonObject&)>& done);
+    bool setTraceFile(const QString& path);  // Record runs as trace events; empty path stops
+    QString traceFile() const;
+    
+    // Stored run output, searchable; the object lives on its own thread
+    OutputIndex* outputIndex() const { return m_outputIndex; }
 
     void start();
     void stop();
+    void setLaunchTimer(const QElapsedTimer& timer) { m_launchTimer = timer; }
+    
+    // Replay: with a virtual clock nothing waits on real timers; the caller
+    // moves the clock to nextEventMs() and calls processDue(). In a dry run
+    // jobs are not executed: each run takes the job's average run time (a
+    // minute if unknown) and succeeds, unless its job is set to fail, and
+    // nothing is saved. A fixed seed makes retry times repeat.
+    void setClock(SchedulerClock* clock);
+    void setDryRun(bool dryRun) { m_dryRun = dryRun; }
+    void setFailingJobs(const QSet<QString>& jobIds) { m_failingJobs = jobIds; }
+    void setRandomSeed(quint32 seed) { m_jitter.seed(seed); }
+    qint64 nextEventMs() const;
+    void processDue();
+    int activeRuns() const { return m_processes.size() + m_stubRuns.size(); }
 
     void saveJobs();
     void loadJobs();
 
+
     // Windows startup management
     static void setAutoStart(bool enable);
     static bool isAutoStartEnabled();
 
 signals:
     void jobExecuted(const QString& jobId, bool success, const QString& output);
-    void jobsChanged();
+    void jobOutput(const QString& jobId, const QString& text);   // Whole lines, batched, while a job runs
+    void jobsChanged(const QVector<CronJob>& jobs);   // Many jobs changed; rebuild views
+    void groupsChanged(const QVector<JobGroup>& groups);
+    void jobAdded(const CronJob& job);
+    void jobUpdated(const CronJob& job);
+    void jobRemoved(const QString& jobId);
+    void statsChanged(const SchedulerStats& stats);
+    void deadlineAlert(const QString& jobId, const QString& message);   // A run will miss, or missed, its deadline
     void logMessage(const QString& message);
 
 private slots:
     void checkAndRunJobs();
+    void onFileTriggered(const QString& jobId, const QStringList& changedFiles);
+    void onSlotOrphaned(const QString& jobId, qint64 slot, const QString& formerHolder);
+    void onConfigChanged();
+    void onConfigDirChanged();
+    void reloadJobs();
 
 private:
-    void executeJob(CronJob& job);
+    // Resolved program, arguments and working directory for a job
+    struct LaunchInfo {
+        QString program;
+        QStringList arguments;
+        QString workingDirectory;
+    };
+    
+    // When one run started, the deadline it has to meet and the cluster
+    // lease it holds. Kept with the run rather than the job, as runs of one
+    // job can overlap.
+    struct RunTiming {
+        qint64 startedMs = -1;
+        qint64 deadlineMs = ScheduleTable::NEVER;
+        qint64 leaseSlot = -1;      // -1: a manual run, retry or file trigger holds no lease
+    };
+
+    // A job process that has not finished yet
+    struct RunningProcess {
+        QString jobId;
+        RunTiming timing;
+        RunUsage sampled;           // Largest figures seen while it ran, if sampled
+        QByteArray output;          // Read so far, for jobExecuted(), up to MAX_RUN_OUTPUT_BYTES
+        QByteArray errors;          // between the two
+        qint64 droppedBytes = 0;    // Read past that limit and not kept
+        QByteArray partialOutput;   // Unfinished last line of each channel
+        QByteArray partialError;
+        QByteArray tail;            // Whole lines not yet sent as jobOutput()
+    };
+
+    void executeJob(CronJob& job, const QStringList& changedFiles = QStringList(), qint64 dueMs = -1);
+    void finishRun(const QString& jobId, bool success, const QString& output, const RunTiming& timing,
+                   const RunUsage& usage = RunUsage(), bool freeGroupSlot = true);
+    void sampleUsage();
+    bool readOutput(JobProcess* process, QProcess::ProcessChannel channel);
+    void emitOutput();
+    RunUsage takeUsage(JobProcess* process);
+    qint64 retryDelayMs(const CronJob& job);
+    void noteStarted(CronJob& job, qint64 slotMs);
+    void scheduleNextRun(CronJob& job, qint64 slotMs = -1);
+    qint64 runDeadline(const CronJob& job);
+    qint64 startDeadline(const CronJob& job, RunTiming& timing);
+    void releaseLease(const QString& jobId);
+    QDateTime currentTime() const { return m_clock->now(); }
+    bool deferRun(CronJob& job, int handle, qint64 nowMs);
+    void armTimer();
+    void scheduleSave();
+    void syncRetention();
+    void renumberJobs();
+    void recoverRuns();
+    void beginGroupRun(const CronJob& job);
+    QString endGroupRun(const QString& jobId);
+    bool groupFull(const QString& group) const;
+    void waitForGroup(CronJob& job, int handle);
+    void unqueue(const QString& jobId);
+    void startQueued(const QString& group);
+    void notifyJobUpdated(const CronJob& job);
+    void loadGroups();
+    void saveGroups();
+    void rebuildSchedule();
+    void syncSchedule(const CronJob& job);
+    static void internStrings(CronJob& job, QSet<QString>& pool);
+    struct ScanBenchmark;
+    void benchmarkSlice(const std::shared_ptr<ScanBenchmark>& bench);
+    QJsonObject scanResult(int rounds, qint64 objectNs, qint64 denseNs, qint64 scanned, qint64 dueJobs) const;
+    const LaunchInfo& launchInfo(const CronJob& job);
+    static QProcessEnvironment buildEnvironment();
     QString getConfigPath();
+    QString stateDir();
+    void migrateState();
+    bool readConfig(QVector<CronJob>& jobs, QByteArray& hash);
+    QString configStamp();
+    void watchConfig();
 
     QVector<CronJob> m_jobs;
+    QHash<QString, int> m_jobIndex;   // Job id -> position in m_jobs (its schedule handle)
+    QHash<QString, quint64> m_jobOrder;   // Job id -> when it was added; removals reorder m_jobs
+    quint64 m_nextOrder = 0;
+    ScheduleTable m_schedule;         // Hot scheduling data, parallel to m_jobs
+    QVector<int> m_dueScratch;
     QTimer* m_timer;
     bool m_running;
+    FileTrigger* m_fileTrigger;
+    QHash<QString, LaunchInfo> m_launchCache;   // Job id -> launch info, dropped on edits
+    QHash<QString, QStringList> m_retryFiles;   // Job id -> changed files to pass to a file job's retry
+    AdmissionController m_admission;
+    QHash<QString, qint64> m_deferredSince;     // Job id -> when its current run was first held back
+    QProcessEnvironment m_environment;
+    QFileSystemWatcher* m_configWatcher;
+    QTimer* m_reloadTimer;
+    QByteArray m_configHash;   // Hash of the config contents we last read or wrote
+    QString m_configStamp;     // Size and modification time of the file at that point
+    QString m_configDir;
+    ClusterCoordinator* m_cluster;
+    TraceRecorder* m_trace;    // Null unless recording
+    PluginExecutor* m_plugins;
+    RunJournal* m_journal;     // Job processes in flight, kept on disk
+    QThread* m_indexThread;
+    OutputIndex* m_outputIndex;
+    QHash<QString, int> m_retention;   // Output retention last handed to the index
+    LoopWatchdog* m_watchdog;  // Measures how long this thread's event loop gets blocked
+    QTimer* m_saveTimer;       // Coalesces saves of run state
+    JobProcess::Backend m_launcher;   // How job processes are started
+    QHash<JobProcess*, RunningProcess> m_processes;
+    QTimer* m_usageTimer;      // Samples running processes while there are any
+    QTimer* m_outputTimer;     // Batches live output into jobOutput() signals
+    SchedulerClock* m_clock;
+    bool m_dryRun;
+    // A dry run's stand-in for a process
+    struct StubRun {
+        QString jobId;
+        RunTiming timing;
+    };
+    QMultiMap<qint64, StubRun> m_stubRuns;   // Dry run: end time -> runs in progress
+    QSet<QString> m_failingJobs;             // Dry run: jobs whose runs fail
+    QRandomGenerator m_jitter;               // Spreads retries
+    QHash<QString, JobGroup> m_groups;
+    QHash<QString, int> m_groupRunning;          // Group -> runs in progress
+    QMultiHash<QString, QString> m_runGroups;    // Job id -> group each of its runs counts against
+    QHash<QString, QStringList> m_groupQueues;   // Group -> job ids waiting for a slot, earliest deadline first
+    QHash<QString, qint64> m_pendingDeadlines;   // Job id -> deadline of its due run that hasn't started
+    QHash<QString, qint64> m_pendingLeases;      // Job id -> lease slot of its due run that hasn't started
+    QHash<QString, RunTiming> m_pluginRuns;      // Job id -> its in-process run; one at a time per job
+    // Job id -> trace slot of its in-process run, with the recorder it is in
+    QHash<QString, QPair<QPointer<TraceRecorder>, int>> m_pluginTraces;
+    bool m_bulk;                                 // Inside a bulk change: one jobsChanged() at the end
+    SchedulerStats m_stats;
+    qint64 m_lastCheckMs;
+    QElapsedTimer m_launchTimer;   // Started in main(), for time-to-first-run
 };
 
 #endif // CRONMANAGER_H
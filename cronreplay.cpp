@@ -0,0 +1,285 @@
+// cron-gui-replay: runs the real scheduler on a virtual clock to see what a
+// job list does over days or weeks, in seconds and reproducibly.
+//
+//   cron-gui-replay [--from ISO-TIME] [--days N] [--resolution MS] FILE
+//   cron-gui-replay [--from ISO-TIME] [--days N] --synthetic JOBS [--seed N]
+//   ... [--group NAME=MAX]... [--fail JOB-ID]... [--per-job] [--expect KEY=VALUE]...
+//
+// FILE is read like an import (cronjobs.json, JSON lines or crontab). Jobs
+// are not executed: every run takes the job's average run time (a minute
+// if unknown) and succeeds, or fails for jobs given with --fail. The report
+// is one JSON object on stdout; with the same input, --from and options
+// (--seed included), orderHash is the same on every run. Each --expect
+// checks one report field, with =, >= or <=, and a dotted KEY reaches into
+// perJob; any mismatch exits with 2, which is how the regression tests use it.
+
+#include "cronmanager.h"
+#include "cronimporter.h"
+#include "schedulerclock.h"
+
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QCryptographicHash>
+#include <QElapsedTimer>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QRandomGenerator>
+#include <QRegularExpression>
+#include <QTemporaryDir>
+#include <QTextStream>
+#include <QVariant>
+
+namespace {
+
+// More wake-ups than this at one instant means the scheduler is not moving on
+const int MAX_WAKEUPS_AT_ONCE = 1000;
+
+QTextStream& err()
+{
+    static QTextStream stream(stderr);
+    return stream;
+}
+
+// What one job's runs did, for --per-job; times are ms after --from
+struct JobTally {
+    int runs = 0;
+    int failures = 0;
+    qint64 firstFinishedMs = -1;
+    qint64 lastFinishedMs = -1;
+};
+
+// One --expect: KEY=VALUE, KEY>=VALUE or KEY<=VALUE. Numbers compare as numbers.
+bool checkExpectation(const QJsonObject& report, const QString& expect)
+{
+    static const QRegularExpression pattern("^([^=<>]+)(=|>=|<=)(.*)$");
+    const QRegularExpressionMatch match = pattern.match(expect);
+    if (!match.hasMatch()) {
+        err() << "Invalid --expect: " << expect << "\n";
+        return false;
+    }
+    QJsonValue value = report;
+    for (const QString& key : match.captured(1).split('.')) {
+        value = value.toObject().value(key);
+    }
+    const QString op = match.captured(2);
+    const QString want = match.captured(3);
+    bool numeric = false;
+    const double wantNumber = want.toDouble(&numeric);
+    bool ok;
+    if (value.isDouble() && numeric) {
+        const double got = value.toDouble();
+        ok = op == "=" ? got == wantNumber : op == ">=" ? got >= wantNumber : got <= wantNumber;
+    } else {
+        ok = op == "=" && !value.isUndefined() && value.toVariant().toString() == want;
+    }
+    if (!ok) {
+        const QString got = value.isUndefined() ? QString("nothing")
+            : value.isDouble() ? QString::number(value.toDouble(), 'f', 0) : value.toVariant().toString();
+        err() << "Expected " << expect << ", got " << got << "\n";
+    }
+    return ok;
+}
+
+// Interval jobs with a spread of intervals, start minutes and run times
+QVector<CronJob> syntheticJobs(int count, quint32 seed, const QDateTime& from)
+{
+    static const int intervals[] = { 5, 15, 30, 60, 60, 120, 240, 720, 1440 };
+    QRandomGenerator rng(seed);
+    const QDateTime minute = QDateTime::fromMSecsSinceEpoch(from.toMSecsSinceEpoch() / 60000 * 60000, Qt::UTC);
+    QVector<CronJob> jobs;
+    jobs.reserve(count);
+    for (int i = 0; i < count; ++i) {
+        CronJob job;
+        job.id = QString("synthetic-%1").arg(i);
+        job.name = QString("Synthetic job %1").arg(i);
+        job.scriptPath = "/bin/true";
+        job.intervalMinutes = intervals[rng.bounded(int(sizeof(intervals) / sizeof(intervals[0])))];
+        // Whole minutes, as cron-style schedules are
+        job.lastRun = minute.addSecs(-60 * qint64(rng.bounded(job.intervalMinutes)));
+        job.averageDurationMs = 1000 + rng.bounded(300000);
+        jobs.append(job);
+    }
+    return jobs;
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("cron-gui-replay");
+    QCoreApplication::setApplicationVersion("1.0");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Replay the schedule of a job list on a virtual clock.");
+    parser.addHelpOption();
+    parser.addVersionOption();
+    parser.addPositionalArgument("file", "Jobs to replay (cronjobs.json, JSON lines or crontab)", "[file]");
+    QCommandLineOption fromOption("from", "Start of the replay (ISO 8601, default: now).", "time");
+    QCommandLineOption daysOption("days", "How many days to replay (default: 7).", "days", "7");
+    QCommandLineOption resolutionOption("resolution",
+        "Wake the scheduler only on multiples of this many ms, to study late starts (default: 0, exact).",
+        "ms", "0");
+    QCommandLineOption syntheticOption("synthetic", "Replay this many generated interval jobs instead of a file.", "jobs");
+    QCommandLineOption seedOption("seed", "Seed for --synthetic and for retry jitter (default: 1).", "seed", "1");
+    QCommandLineOption groupOption("group", "Limit a job group to MAX runs at a time (repeatable).", "name=max");
+    QCommandLineOption failOption("fail", "Runs of this job fail, to replay retries and the breaker (repeatable).", "job-id");
+    QCommandLineOption perJobOption("per-job", "Add runs, failures and finish times of each job to the report.");
+    QCommandLineOption expectOption("expect",
+        "Exit with 2 unless the report field KEY compares as given; =, >= or <= (repeatable).", "key=value");
+    parser.addOption(fromOption);
+    parser.addOption(daysOption);
+    parser.addOption(resolutionOption);
+    parser.addOption(syntheticOption);
+    parser.addOption(seedOption);
+    parser.addOption(groupOption);
+    parser.addOption(failOption);
+    parser.addOption(perJobOption);
+    parser.addOption(expectOption);
+    parser.process(app);
+
+    QDateTime from = parser.isSet(fromOption)
+        ? QDateTime::fromString(parser.value(fromOption), Qt::ISODate)
+        : QDateTime::currentDateTime();
+    if (!from.isValid()) {
+        err() << "Invalid --from time: " << parser.value(fromOption) << "\n";
+        return 1;
+    }
+    from = from.toUTC();
+    const int days = qBound(1, parser.value(daysOption).toInt(), 366);
+    const qint64 resolutionMs = qMax<qint64>(0, parser.value(resolutionOption).toLongLong());
+
+    QVector<CronJob> jobs;
+    if (parser.isSet(syntheticOption)) {
+        jobs = syntheticJobs(parser.value(syntheticOption).toInt(), parser.value(seedOption).toUInt(), from);
+    } else {
+        const QStringList args = parser.positionalArguments();
+        if (args.isEmpty()) {
+            parser.showHelp(1);
+        }
+        CronImporter importer;
+        importer.setNow(from);   // Crontab times of day are anchored to the replay, not to today
+        bool ok = importer.importFile(args.first(),
+            [&jobs](const CronJob& job) { jobs.append(job); },
+            [](qint64 line, const QString& message) { err() << "line " << line << ": " << message << "\n"; });
+        if (!ok) {
+            err() << importer.errorString() << "\n";
+            return 1;
+        }
+    }
+
+    // The manager gets an empty scratch folder, so the real job list is never read or written
+    QTemporaryDir scratch;
+    VirtualClock clock(from.toMSecsSinceEpoch());
+    CronManager manager(scratch.path());
+    manager.setClock(&clock);
+    manager.setDryRun(true);
+    manager.setRandomSeed(parser.value(seedOption).toUInt());
+    for (const QString& spec : parser.values(groupOption)) {
+        JobGroup group;
+        group.name = spec.section('=', 0, 0);
+        group.maxConcurrent = qMax(0, spec.section('=', 1).toInt());
+        manager.setGroup(group);
+    }
+    const QStringList failing = parser.values(failOption);
+    manager.setFailingJobs(QSet<QString>(failing.cbegin(), failing.cend()));
+    manager.importJobs(jobs);
+
+    // Completion order, with times, is what the hash pins down
+    QCryptographicHash orderHash(QCryptographicHash::Sha1);
+    qint64 finishedRuns = 0;
+    qint64 failedRuns = 0;
+    QHash<QString, JobTally> tallies;
+    const bool perJob = parser.isSet(perJobOption);
+    QObject::connect(&manager, &CronManager::jobExecuted, [&](const QString& jobId, bool success, const QString&) {
+        const qint64 ms = clock.nowMs();
+        orderHash.addData(reinterpret_cast<const char*>(&ms), sizeof(ms));
+        orderHash.addData(jobId.toUtf8());
+        ++finishedRuns;
+        if (!success) {
+            ++failedRuns;
+        }
+        if (perJob) {
+            JobTally& tally = tallies[jobId];
+            ++tally.runs;
+            tally.failures += success ? 0 : 1;
+            tally.lastFinishedMs = ms - from.toMSecsSinceEpoch();
+            if (tally.firstFinishedMs < 0) {
+                tally.firstFinishedMs = tally.lastFinishedMs;
+            }
+        }
+    });
+
+    QElapsedTimer wallTimer;
+    wallTimer.start();
+
+    const qint64 endMs = clock.nowMs() + days * 86400000LL;
+    qint64 wakeups = 0;
+    int maxConcurrent = 0;
+    int wakeupsAtOnce = 0;
+    manager.start();
+    for (;;) {
+        qint64 next = manager.nextEventMs();
+        if (next > endMs) {
+            break;
+        }
+        if (resolutionMs > 0) {
+            next = (next + resolutionMs - 1) / resolutionMs * resolutionMs;
+        }
+        if (next <= clock.nowMs()) {
+            if (++wakeupsAtOnce > MAX_WAKEUPS_AT_ONCE) {
+                err() << "The schedule does not advance at " << QDateTime::fromMSecsSinceEpoch(clock.nowMs(), Qt::UTC).toString(Qt::ISODate) << "\n";
+                return 1;
+            }
+        } else {
+            wakeupsAtOnce = 0;
+            clock.setMs(next);
+        }
+        manager.processDue();
+        ++wakeups;
+        maxConcurrent = qMax(maxConcurrent, manager.activeRuns());
+    }
+    const qint64 wallMs = wallTimer.elapsed();
+    manager.stop();
+
+    const SchedulerStats stats = manager.stats();
+    QJsonObject report;
+    report["jobs"] = jobs.size();
+    report["from"] = from.toString(Qt::ISODate);
+    report["days"] = days;
+    report["resolutionMs"] = resolutionMs;
+    report["startedRuns"] = stats.firedRuns;
+    report["finishedRuns"] = finishedRuns;
+    report["failedRuns"] = failedRuns;
+    report["wakeups"] = wakeups;
+    report["maxConcurrent"] = maxConcurrent;
+    report["maxLagMs"] = stats.maxLagMs;
+    report["avgLagMs"] = stats.lagSamples > 0 ? double(stats.totalLagMs) / stats.lagSamples : 0.0;
+    report["earlyStarts"] = stats.earlyStarts;
+    report["predictedMisses"] = stats.predictedMisses;
+    report["deadlineMisses"] = stats.deadlineMisses;
+    report["orderHash"] = QString::fromLatin1(orderHash.result().toHex());
+    report["wallMs"] = wallMs;
+    report["runsPerSecond"] = wallMs > 0 ? stats.firedRuns * 1000.0 / wallMs : 0.0;
+    if (perJob) {
+        QJsonObject byJob;
+        for (auto it = tallies.cbegin(); it != tallies.cend(); ++it) {
+            QJsonObject tally;
+            tally["runs"] = it->runs;
+            tally["failures"] = it->failures;
+            tally["firstFinishedMs"] = it->firstFinishedMs;
+            tally["lastFinishedMs"] = it->lastFinishedMs;
+            byJob[it.key()] = tally;
+        }
+        report["perJob"] = byJob;
+    }
+    QTextStream(stdout) << QJsonDocument(report).toJson(QJsonDocument::Compact) << "\n";
+
+    int mismatches = 0;
+    for (const QString& expect : parser.values(expectOption)) {
+        if (!checkExpectation(report, expect)) {
+            ++mismatches;
+        }
+    }
+    return mismatches > 0 ? 2 : 0;
+}
@@ -0,0 +1,284 @@
+#include "crontabformat.h"
+#include <QFileInfo>
+#include <QStringList>
+#include <QDateTime>
+
+namespace {
+
+// Characters that need a shell to interpret the command ('%' is a newline in crontab)
+const QString SHELL_CHARS = "|&;<>$`*?(){}[]'\"\\%~";
+
+bool needsShell(const QString& command)
+{
+    for (const QChar& c : command) {
+        if (SHELL_CHARS.contains(c)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// Returns the step of a "*" or "*/N" field, 0 for a single fixed value and -1 otherwise
+int fieldStep(const QString& field)
+{
+    if (field == "*") {
+        return 1;
+    }
+    if (field.startsWith("*/")) {
+        bool ok = false;
+        int step = field.mid(2).toInt(&ok);
+        return (ok && step > 0) ? step : -1;
+    }
+    bool ok = false;
+    field.toInt(&ok);
+    return ok ? 0 : -1;
+}
+
+bool inRange(const QString& field, int low, int high)
+{
+    const int value = field.toInt();
+    return value >= low && value <= high;
+}
+
+// Whether a "*", "*/N" or fixed field allows value; low is the field's first value
+bool fieldMatches(const QString& field, int value, int low)
+{
+    const int step = fieldStep(field);
+    if (step > 0) {
+        return (value - low) % step == 0;
+    }
+    return field.toInt() == value;
+}
+
+// The five time fields a schedule macro stands for
+QStringList macroFields(const QString& macro)
+{
+    if (macro == "@hourly") return QStringList{"0", "*", "*", "*", "*"};
+    if (macro == "@daily" || macro == "@midnight") return QStringList{"0", "0", "*", "*", "*"};
+    if (macro == "@weekly") return QStringList{"0", "0", "*", "*", "0"};
+    return QStringList();
+}
+
+} // namespace
+
+QDateTime CrontabFormat::firstRun(const QStringList& fields, const QDateTime& now)
+{
+    const QStringList f = fields.size() == 1 ? macroFields(fields.first()) : fields;
+    if (f.size() != 5) {
+        return QDateTime();
+    }
+
+    // The first whole minute from now on that every field allows; a few
+    // years of days covers the 29th of February
+    const QDateTime start = QDateTime(now.date(), QTime(now.time().hour(), now.time().minute()))
+        .addSecs(now.time().second() > 0 || now.time().msec() > 0 ? 60 : 0);
+    for (int day = 0; day <= 4 * 366; ++day) {
+        const QDate date = start.date().addDays(day);
+        const int dayOfWeek = date.dayOfWeek() % 7;   // Sunday is 0, or 7 in the field
+        if (!fieldMatches(f[2], date.day(), 1) || !fieldMatches(f[3], date.month(), 1)
+            || !(fieldMatches(f[4], dayOfWeek, 0) || (dayOfWeek == 0 && f[4] == "7"))) {
+            continue;
+        }
+        for (int hour = day == 0 ? start.time().hour() : 0; hour < 24; ++hour) {
+            if (!fieldMatches(f[1], hour, 0)) {
+                continue;
+            }
+            const bool firstHour = day == 0 && hour == start.time().hour();
+            for (int minute = firstHour ? start.time().minute() : 0; minute < 60; ++minute) {
+                if (fieldMatches(f[0], minute, 0)) {
+                    const QDateTime at(date, QTime(hour, minute));
+                    if (at.isValid()) {   // Not inside a daylight saving gap
+                        return at;
+                    }
+                }
+            }
+        }
+    }
+    return QDateTime();
+}
+
+CrontabFormat::LineResult CrontabFormat::parseLine(const QString& line, CronJob& job,
+                                                   QString& error, bool systemFormat, const QDateTime& now)
+{
+    QString trimmed = line.trimmed();
+    if (trimmed.isEmpty() || trimmed.startsWith('#')) {
+        return SkippedLine;
+    }
+
+    // Split off the schedule fields, keeping the command's own spacing intact
+    const int fieldCount = (trimmed.startsWith('@') ? 1 : 5) + (systemFormat ? 1 : 0);
+    QStringList fields;
+    int pos = 0;
+    while (fields.size() < fieldCount && pos < trimmed.size()) {
+        int end = pos;
+        while (end < trimmed.size() && !trimmed.at(end).isSpace()) {
+            ++end;
+        }
+        fields.append(trimmed.mid(pos, end - pos));
+        pos = end;
+        while (pos < trimmed.size() && trimmed.at(pos).isSpace()) {
+            ++pos;
+        }
+    }
+
+    // NAME=value environment lines
+    if (!fields.isEmpty() && fields.first().contains('=') && !trimmed.startsWith('@')) {
+        return SkippedLine;
+    }
+
+    QString command = trimmed.mid(pos).trimmed();
+    if (fields.size() < fieldCount || command.isEmpty()) {
+        error = "Expected schedule fields followed by a command";
+        return InvalidLine;
+    }
+
+    if (systemFormat) {
+        fields.removeLast();  // User column; jobs run as the scheduler's user
+    }
+
+    int minutes = scheduleToMinutes(fields, error);
+    if (minutes <= 0) {
+        return InvalidLine;
+    }
+
+    job.intervalMinutes = minutes;
+    job.nextRun = firstRun(fields, now.isValid() ? now : QDateTime::currentDateTime());   // Keeps the time of day
+    job.arguments.clear();
+    job.useCustomCommand = false;
+    job.customCommand.clear();
+    if (needsShell(command)) {
+        job.useCustomCommand = true;
+        job.customCommand = "sh -c";
+        job.scriptPath = command;
+        job.name = command.left(60);
+    } else {
+        QStringList parts = command.split(' ', Qt::SkipEmptyParts);
+        job.scriptPath = parts.takeFirst();
+        job.arguments = parts.join(' ');
+        job.name = QFileInfo(job.scriptPath).fileName();
+    }
+    return ParsedJob;
+}
+
+int CrontabFormat::scheduleToMinutes(const QStringList& fields, QString& error)
+{
+    if (fields.size() == 1) {
+        const QString& macro = fields.first();
+        if (macro == "@hourly") return 60;
+        if (macro == "@daily" || macro == "@midnight") return 1440;
+        if (macro == "@weekly") return 10080;
+        if (macro == "@monthly" || macro == "@yearly" || macro == "@annually") {
+            // Months and years differ in length, so like a day of the month these have no fixed interval
+            error = QString("Schedule '%1' does not repeat at a fixed interval: months and years "
+                            "differ in length").arg(macro);
+            return -1;
+        }
+        error = QString("Unsupported schedule macro: %1").arg(macro);
+        return -1;
+    }
+
+    if (fields.size() != 5) {
+        error = "Expected five schedule fields";
+        return -1;
+    }
+
+    const int minute = fieldStep(fields[0]);
+    const int hour = fieldStep(fields[1]);
+    const int dayOfMonth = fieldStep(fields[2]);
+    const int month = fieldStep(fields[3]);
+    const int dayOfWeek = fieldStep(fields[4]);
+
+    // Real cron starts counting again at each hour and day, so a step that
+    // doesn't divide the field's range (*/7 minutes, */5 hours) has a short
+    // gap at the wrap and is no fixed interval. Days of the month never
+    // divide evenly, as months differ in length.
+    if ((minute > 1 && 60 % minute != 0) || (hour > 1 && 24 % hour != 0) || dayOfMonth > 1) {
+        error = QString("Schedule '%1' does not repeat at a fixed interval: the step restarts "
+                        "at the start of each hour or day").arg(fields.join(' '));
+        return -1;
+    }
+    if ((minute == 0 && !inRange(fields[0], 0, 59)) || (hour == 0 && !inRange(fields[1], 0, 23))
+        || (dayOfWeek == 0 && !inRange(fields[4], 0, 7))) {
+        error = QString("Schedule '%1' has a value out of range").arg(fields.join(' '));
+        return -1;
+    }
+
+    if (month == 1) {
+        if (minute >= 1 && hour == 1 && dayOfMonth == 1 && dayOfWeek == 1) {
+            return minute;                          // */N * * * *
+        }
+        if (minute == 0 && hour >= 1 && dayOfMonth == 1 && dayOfWeek == 1) {
+            return hour * 60;                       // M */N * * *
+        }
+        if (minute == 0 && hour == 0 && dayOfMonth == 1 && dayOfWeek == 1) {
+            return 1440;                            // M H * * *
+        }
+        if (minute == 0 && hour == 0 && dayOfMonth == 1 && dayOfWeek == 0) {
+            return 10080;                           // M H * * D
+        }
+    }
+
+    error = QString("Schedule '%1' cannot be expressed as a fixed interval").arg(fields.join(' '));
+    return -1;
+}
+
+QString CrontabFormat::minutesToSchedule(int minutes, const QDateTime& anchor)
+{
+    if (minutes <= 0) {
+        return QString();
+    }
+    // The anchor (the next run) supplies the minute and hour cron fires at
+    const int minute = anchor.isValid() ? anchor.time().minute() : 0;
+    const int hour = anchor.isValid() ? anchor.time().hour() : 0;
+    if (minutes < 60 && 60 % minutes == 0) {
+        return minutes == 1 ? "* * * * *" : QString("*/%1 * * * *").arg(minutes);
+    }
+    if (minutes % 60 == 0 && minutes < 1440 && 24 % (minutes / 60) == 0) {
+        int hours = minutes / 60;
+        return hours == 1 ? QString("%1 * * * *").arg(minute) : QString("%1 */%2 * * *").arg(minute).arg(hours);
+    }
+    if (minutes == 10080) {
+        return QString("%1 %2 * * %3").arg(minute).arg(hour).arg(anchor.isValid() ? anchor.date().dayOfWeek() % 7 : 0);
+    }
+    if (minutes == 1440) {
+        return QString("%1 %2 * * *").arg(minute).arg(hour);
+    }
+    return QString();   // Steps over days of the month restart every month
+}
+
+QString CrontabFormat::formatJob(const CronJob& job)
+{
+    QString command;
+    if (job.useCustomCommand && job.customCommand == "sh -c") {
+        command = job.scriptPath;
+    } else {
+        QStringList parts;
+        if (job.useCustomCommand && !job.customCommand.isEmpty()) {
+            parts.append(job.customCommand);
+        }
+        parts.append(job.scriptPath);
+        if (!job.arguments.isEmpty()) {
+            parts.append(job.arguments);
+        }
+        command = parts.join(' ');
+    }
+
+    if (job.triggerType == CronJob::FileChangeTrigger) {
+        return QString("# %1: runs when %2 changes, which has no crontab equivalent\n# %3")
+            .arg(job.name, job.watchPath, command);
+    }
+
+    if (job.intervalSeconds > 0) {
+        return QString("# %1: every %2 seconds has no crontab equivalent\n# * * * * * %3")
+            .arg(job.name).arg(job.intervalSeconds).arg(command);
+    }
+
+    QString schedule = minutesToSchedule(job.intervalMinutes, job.nextRun);
+    if (schedule.isEmpty()) {
+        return QString("# %1: every %2 minutes has no crontab equivalent\n# * * * * * %3")
+            .arg(job.name).arg(job.intervalMinutes).arg(command);
+    }
+
+    QString line = QString("%1 %2").arg(schedule, command);
+    return job.enabled ? line : "# " + line;
+}
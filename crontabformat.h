@@ -0,0 +1,32 @@
+#ifndef CRONTABFORMAT_H
+#define CRONTABFORMAT_H
+
+#include <QString>
+#include <QStringList>
+#include <QDateTime>
+#include "cronjob.h"
+
+// Conversion between crontab lines and interval based CronJobs.
+// Only schedules that repeat at a fixed interval can be represented; the
+// time of day they fire at becomes the job's first nextRun.
+class CrontabFormat
+{
+public:
+    enum LineResult {
+        ParsedJob,
+        SkippedLine,   // Blank line, comment or environment assignment
+        InvalidLine
+    };
+
+    // systemFormat: line has a user column after the five time fields (/etc/crontab).
+    // The first run is the next match after now (default: the current time).
+    static LineResult parseLine(const QString& line, CronJob& job, QString& error,
+                                bool systemFormat = false, const QDateTime& now = QDateTime());
+    static QString formatJob(const CronJob& job);
+
+    static int scheduleToMinutes(const QStringList& fields, QString& error);
+    static QString minutesToSchedule(int minutes, const QDateTime& anchor = QDateTime());
+    static QDateTime firstRun(const QStringList& fields, const QDateTime& now);
+};
+
+#endif // CRONTABFORMAT_H
@@ -0,0 +1,37 @@
+#ifndef CRONTASK_H
+#define CRONTASK_H
+
+#include <QtPlugin>
+#include <QString>
+#include <atomic>
+
+// Interface for jobs that run inside the scheduler instead of as a process.
+// Build a Qt plugin (a shared library) whose root object implements it:
+//
+//   class DiskCheck : public QObject, public CronTask
+//   {
+//       Q_OBJECT
+//       Q_PLUGIN_METADATA(IID CronTask_iid)
+//       Q_INTERFACES(CronTask)
+//   public:
+//       bool run(const QString& arguments, QString& output, const std::atomic_bool& cancelled) override;
+//   };
+//
+// run() is called on a pool thread. One job never has two calls running at
+// once, but jobs sharing a library share its instance, so run() must be
+// safe to call from several threads. Once the job's time limit passes,
+// 'cancelled' is set; return soon after, because a thread cannot be stopped
+// from outside.
+class CronTask
+{
+public:
+    virtual ~CronTask() = default;
+
+    // True on success; output is shown like a script's output
+    virtual bool run(const QString& arguments, QString& output, const std::atomic_bool& cancelled) = 0;
+};
+
+#define CronTask_iid "org.crongui.CronTask/1.0"
+Q_DECLARE_INTERFACE(CronTask, CronTask_iid)
+
+#endif // CRONTASK_H
@@ -0,0 +1,341 @@
+#include "filetrigger.h"
+#include <QDir>
+#include <QFileInfo>
+#include <QSet>
+
+namespace {
+const int MISSING_RETRY_MS = 2000;   // How often paths that don't exist are looked for
+}
+
+FileTrigger::FileTrigger(QObject *parent)
+    : QObject(parent)
+    , m_watcher(new QFileSystemWatcher(this))
+    , m_retryTimer(new QTimer(this))
+{
+    connect(m_watcher, &QFileSystemWatcher::directoryChanged, this, &FileTrigger::onDirectoryChanged);
+    connect(m_watcher, &QFileSystemWatcher::fileChanged, this, &FileTrigger::onFileChanged);
+    m_retryTimer->setInterval(MISSING_RETRY_MS);
+    connect(m_retryTimer, &QTimer::timeout, this, &FileTrigger::retryMissing);
+}
+
+void FileTrigger::updateJobs(const QVector<CronJob>& jobs)
+{
+    QSet<QString> ids;
+    ids.reserve(jobs.size());
+    for (const CronJob& job : jobs) {
+        ids.insert(job.id);
+        const QString key = watchKey(job);
+        auto seen = m_jobKeys.constFind(job.id);
+        if (seen == m_jobKeys.constEnd() || seen.value() != key) {
+            updateJob(job);
+        }
+    }
+
+    const QStringList watchedIds = m_watches.keys();
+    for (const QString& id : watchedIds) {
+        if (!ids.contains(id)) {
+            removeWatch(id);
+        }
+    }
+
+    const QStringList scriptedIds = m_scripts.keys();
+    for (const QString& id : scriptedIds) {
+        if (!ids.contains(id)) {
+            unwatchPath(m_scripts.take(id), id, m_scriptJobs);
+        }
+    }
+
+    for (auto it = m_jobKeys.begin(); it != m_jobKeys.end();) {
+        if (ids.contains(it.key())) {
+            ++it;
+        } else {
+            it = m_jobKeys.erase(it);
+        }
+    }
+}
+
+QString FileTrigger::watchKey(const CronJob& job)
+{
+    return QStringList{job.enabled ? "1" : "0", QString::number(job.triggerType), job.watchPath,
+                       job.watchFilter, QString::number(job.debounceMs), job.scriptPath}.join('\n');
+}
+
+void FileTrigger::updateJob(const CronJob& job)
+{
+    // Settings are remembered only once every path they need is watched;
+    // a path that doesn't exist yet is also looked for on the next call
+    bool complete = true;
+    if (job.enabled && job.triggerType == CronJob::FileChangeTrigger && !job.watchPath.isEmpty()) {
+        auto it = m_watches.constFind(job.id);
+        if (it == m_watches.constEnd()
+            || it->path != QDir::cleanPath(job.watchPath)
+            || it->filter != job.watchFilter
+            || it->debounceMs != job.debounceMs) {
+            removeWatch(job.id);
+            addWatch(job);
+        } else {
+            watchPath(it->path);
+        }
+        complete = m_watched.contains(QDir::cleanPath(job.watchPath));
+    } else {
+        removeWatch(job.id);
+    }
+
+    const QString previous = m_scripts.value(job.id);
+    if (!job.scriptPath.isEmpty() && QFileInfo(job.scriptPath).isFile()) {
+        QString path = QDir::cleanPath(job.scriptPath);
+        if (previous != path) {
+            if (!previous.isEmpty()) {
+                unwatchPath(previous, job.id, m_scriptJobs);
+            }
+            m_scripts.insert(job.id, path);
+            m_scriptJobs[path].append(job.id);
+            watchPath(path);
+        }
+    } else {
+        if (!previous.isEmpty()) {
+            unwatchPath(m_scripts.take(job.id), job.id, m_scriptJobs);
+        }
+        complete = complete && job.scriptPath.isEmpty();
+    }
+
+    if (complete) {
+        m_jobKeys.insert(job.id, watchKey(job));
+    } else {
+        m_jobKeys.remove(job.id);
+    }
+}
+
+void FileTrigger::addWatch(const CronJob& job)
+{
+    Watch watch;
+    watch.jobId = job.id;
+    watch.path = QDir::cleanPath(job.watchPath);
+    watch.filter = job.watchFilter;
+    watch.nameFilters = job.watchFilter.split(';', Qt::SkipEmptyParts);
+    for (QString& pattern : watch.nameFilters) {
+        pattern = pattern.trimmed();
+    }
+    watch.debounceMs = job.debounceMs;
+    watch.isDirectory = QFileInfo(watch.path).isDir();
+    if (watch.isDirectory) {
+        watch.snapshot = scanDirectory(watch);
+    }
+
+    QString jobId = job.id;
+    watch.debounce = new QTimer(this);
+    watch.debounce->setSingleShot(true);
+    connect(watch.debounce, &QTimer::timeout, this, [this, jobId]() {
+        auto it = m_watches.find(jobId);
+        if (it == m_watches.end()) {
+            return;
+        }
+        Watch& w = it.value();
+
+        // Files still being written: wait for another quiet period
+        if (w.isDirectory) {
+            QHash<QString, Entry> current = scanDirectory(w);
+            if (current != w.snapshot) {
+                QStringList changed;
+                for (auto entry = current.constBegin(); entry != current.constEnd(); ++entry) {
+                    if (w.snapshot.value(entry.key()) != entry.value()) {
+                        changed.append(QDir(w.path).filePath(entry.key()));
+                    }
+                }
+                w.snapshot = current;
+                noteChanges(w, changed);
+                return;
+            }
+        }
+
+        QStringList files = w.pendingChanges;
+        w.pendingChanges.clear();
+        emit triggered(jobId, files);
+    });
+
+    m_pathJobs[watch.path].append(job.id);
+    watchPath(watch.path);
+    m_watches.insert(job.id, watch);
+}
+
+void FileTrigger::removeWatch(const QString& jobId)
+{
+    auto it = m_watches.find(jobId);
+    if (it == m_watches.end()) {
+        return;
+    }
+    it->debounce->stop();
+    it->debounce->deleteLater();
+    QString path = it->path;
+    m_watches.erase(it);
+    unwatchPath(path, jobId, m_pathJobs);
+}
+
+bool FileTrigger::watchPath(const QString& path)
+{
+    if (m_watched.contains(path)) {
+        return true;
+    }
+    if (QFileInfo::exists(path) && m_watcher->addPath(path)) {
+        m_watched.insert(path);
+        m_missing.remove(path);
+        return true;
+    }
+    m_missing.insert(path);
+    if (!m_retryTimer->isActive()) {
+        m_retryTimer->start();
+    }
+    return false;
+}
+
+void FileTrigger::pathLost(const QString& path)
+{
+    // Deleted or replaced; the watcher has dropped it already. A replacement
+    // by rename is usually back at once, otherwise the retry timer finds it.
+    m_watcher->removePath(path);
+    m_watched.remove(path);
+    if (!watchPath(path)) {
+        for (const QString& jobId : m_pathJobs.value(path) + m_scriptJobs.value(path)) {
+            m_jobKeys.remove(jobId);
+        }
+    }
+}
+
+void FileTrigger::pathAppeared(const QString& path)
+{
+    // A dropped file is a change, and so is every matching file in a folder
+    // that appears: its snapshot is empty
+    for (const QString& jobId : m_scriptJobs.value(path)) {
+        emit scriptChanged(jobId);
+    }
+    const QStringList jobIds = m_pathJobs.value(path);
+    for (const QString& jobId : jobIds) {
+        auto it = m_watches.find(jobId);
+        if (it == m_watches.end()) {
+            continue;
+        }
+        it->isDirectory = QFileInfo(path).isDir();
+        if (!it->isDirectory) {
+            noteChanges(it.value(), QStringList() << path);
+        }
+    }
+    if (QFileInfo(path).isDir()) {
+        onDirectoryChanged(path);
+    }
+}
+
+void FileTrigger::retryMissing()
+{
+    const QList<QString> missing = m_missing.values();
+    for (const QString& path : missing) {
+        if (watchPath(path)) {
+            pathAppeared(path);
+        }
+    }
+    if (m_missing.isEmpty()) {
+        m_retryTimer->stop();
+    }
+}
+
+void FileTrigger::unwatchPath(const QString& path, const QString& jobId, QHash<QString, QStringList>& index)
+{
+    auto it = index.find(path);
+    if (it != index.end()) {
+        it->removeAll(jobId);
+        if (it->isEmpty()) {
+            index.erase(it);
+        }
+    }
+
+    // The same path may still be needed as a trigger or as a script
+    if (!m_pathJobs.contains(path) && !m_scriptJobs.contains(path)) {
+        m_missing.remove(path);
+        if (m_watched.remove(path)) {
+            m_watcher->removePath(path);
+        }
+    }
+}
+
+QHash<QString, FileTrigger::Entry> FileTrigger::scanDirectory(const Watch& watch) const
+{
+    QHash<QString, Entry> entries;
+    const QFileInfoList files = QDir(watch.path).entryInfoList(watch.nameFilters, QDir::Files | QDir::NoDotAndDotDot);
+    entries.reserve(files.size());
+    for (const QFileInfo& info : files) {
+        Entry entry;
+        entry.modified = info.lastModified().toMSecsSinceEpoch();
+        entry.size = info.size();
+        entries.insert(info.fileName(), entry);
+    }
+    return entries;
+}
+
+void FileTrigger::noteChanges(Watch& watch, const QStringList& files)
+{
+    for (const QString& file : files) {
+        if (!watch.pendingChanges.contains(file)) {
+            watch.pendingChanges.append(file);
+        }
+    }
+    watch.debounce->start(watch.debounceMs);
+}
+
+void FileTrigger::onDirectoryChanged(const QString& path)
+{
+    const QStringList jobIds = m_pathJobs.value(path);
+    if (!QFileInfo(path).isDir()) {
+        // The folder itself is gone; whatever it holds when it is back is new
+        for (const QString& jobId : jobIds) {
+            auto it = m_watches.find(jobId);
+            if (it != m_watches.end()) {
+                it->snapshot.clear();
+            }
+        }
+        if (m_watched.contains(path)) {
+            pathLost(path);
+        }
+        return;
+    }
+    for (const QString& jobId : jobIds) {
+        auto it = m_watches.find(jobId);
+        if (it == m_watches.end() || !it->isDirectory) {
+            continue;
+        }
+
+        // Only new or modified files that match the filter count as a change
+        QHash<QString, Entry> current = scanDirectory(it.value());
+        QStringList changed;
+        for (auto entry = current.constBegin(); entry != current.constEnd(); ++entry) {
+            auto previous = it->snapshot.constFind(entry.key());
+            if (previous == it->snapshot.constEnd() || previous.value() != entry.value()) {
+                changed.append(QDir(path).filePath(entry.key()));
+            }
+        }
+        it->snapshot = current;
+        if (!changed.isEmpty()) {
+            noteChanges(it.value(), changed);
+        }
+    }
+}
+
+void FileTrigger::onFileChanged(const QString& path)
+{
+    const QStringList scriptJobIds = m_scriptJobs.value(path);
+    for (const QString& jobId : scriptJobIds) {
+        emit scriptChanged(jobId);
+    }
+
+    // A deleted file is no change to act on (a drop-file job usually deletes
+    // its own input); its return is, through pathAppeared()
+    const QStringList triggerJobIds = m_pathJobs.value(path);
+    const bool exists = QFileInfo::exists(path);
+    for (const QString& jobId : triggerJobIds) {
+        auto it = m_watches.find(jobId);
+        if (exists && it != m_watches.end() && !it->isDirectory) {
+            noteChanges(it.value(), QStringList() << path);
+        }
+    }
+
+    // Editors often save by replacing the file, which drops the watch
+    pathLost(path);
+}
@@ -0,0 +1,81 @@
+#ifndef FILETRIGGER_H
+#define FILETRIGGER_H
+
+#include <QObject>
+#include <QHash>
+#include <QSet>
+#include <QStringList>
+#include <QVector>
+#include <QFileSystemWatcher>
+#include <QTimer>
+#include "cronjob.h"
+
+// Fires file-change jobs from QFileSystemWatcher notifications (inotify on
+// Linux) instead of polling, and reports edits to any job's script file so
+// cached launch information can be dropped. Idle watches cost no CPU. A path
+// that doesn't exist, or was deleted, is looked for every few seconds until
+// it turns up; a watched file or folder that appears counts as a change.
+class FileTrigger : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit FileTrigger(QObject *parent = nullptr);
+
+    // Brings the watch set in line with the jobs; only jobs whose watch
+    // settings changed since the last call are looked at again
+    void updateJobs(const QVector<CronJob>& jobs);
+
+signals:
+    void triggered(const QString& jobId, const QStringList& changedFiles);
+    void scriptChanged(const QString& jobId);
+
+private slots:
+    void onDirectoryChanged(const QString& path);
+    void onFileChanged(const QString& path);
+    void retryMissing();
+
+private:
+    struct Entry {
+        qint64 modified = 0;
+        qint64 size = 0;
+
+        bool operator==(const Entry& other) const { return modified == other.modified && size == other.size; }
+        bool operator!=(const Entry& other) const { return !(*this == other); }
+    };
+
+    struct Watch {
+        QString jobId;
+        QString path;
+        QString filter;
+        QStringList nameFilters;
+        int debounceMs = 0;
+        bool isDirectory = false;
+        QHash<QString, Entry> snapshot;   // Matching files in a watched folder
+        QStringList pendingChanges;
+        QTimer* debounce = nullptr;
+    };
+
+    static QString watchKey(const CronJob& job);
+    void updateJob(const CronJob& job);
+    void addWatch(const CronJob& job);
+    void removeWatch(const QString& jobId);
+    bool watchPath(const QString& path);
+    void pathLost(const QString& path);
+    void pathAppeared(const QString& path);
+    void unwatchPath(const QString& path, const QString& jobId, QHash<QString, QStringList>& index);
+    QHash<QString, Entry> scanDirectory(const Watch& watch) const;
+    void noteChanges(Watch& watch, const QStringList& files);
+
+    QFileSystemWatcher* m_watcher;
+    QHash<QString, Watch> m_watches;             // Job id -> file-change watch
+    QHash<QString, QStringList> m_pathJobs;      // Watched path -> job ids with a trigger on it
+    QHash<QString, QString> m_scripts;           // Job id -> watched script path
+    QHash<QString, QStringList> m_scriptJobs;    // Script path -> job ids using it
+    QSet<QString> m_watched;                     // Paths handed to m_watcher
+    QSet<QString> m_missing;                     // Needed paths that could not be watched
+    QTimer* m_retryTimer;                        // Looks for m_missing while there are any
+    QHash<QString, QString> m_jobKeys;           // Job id -> watch settings last applied
+};
+
+#endif // FILETRIGGER_H
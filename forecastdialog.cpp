@@ -0,0 +1,128 @@
+#include "forecastdialog.h"
+#include <QDateTime>
+#include <QHBoxLayout>
+#include <QPixmap>
+#include <QThreadPool>
+#include <QVBoxLayout>
+#include <QtConcurrent>
+
+namespace {
+const int CHUNKS_PER_THREAD = 4;
+const int PEAKS_LISTED = 10;
+}
+
+ForecastDialog::ForecastDialog(const QVector<CronJob>& jobs, bool clustered, QWidget *parent)
+    : QDialog(parent)
+    , m_jobs(jobs)
+    , m_days(0)
+    , m_clustered(clustered)
+    , m_startedMs(0)
+{
+    setWindowTitle("Schedule Forecast");
+    resize(900, 560);
+
+    QVBoxLayout* layout = new QVBoxLayout(this);
+
+    QHBoxLayout* controls = new QHBoxLayout();
+    m_daysSpinBox = new QSpinBox(this);
+    m_daysSpinBox->setRange(1, 31);
+    m_daysSpinBox->setValue(7);
+    m_daysSpinBox->setSuffix(" day(s)");
+    m_computeButton = new QPushButton("Compute", this);
+    controls->addWidget(new QLabel("Forecast the next", this));
+    controls->addWidget(m_daysSpinBox);
+    controls->addWidget(m_computeButton);
+    controls->addStretch();
+    layout->addLayout(controls);
+
+    m_summaryLabel = new QLabel(this);
+    layout->addWidget(m_summaryLabel);
+
+    m_heatMapLabel = new QLabel(this);
+    m_heatMapLabel->setMinimumSize(300, 120);
+    m_heatMapLabel->setSizePolicy(QSizePolicy::Ignored, QSizePolicy::Ignored);
+    m_heatMapLabel->setToolTip("Rows are days, columns the time of day; red marks the most jobs running at once");
+    layout->addWidget(m_heatMapLabel, 1);
+
+    layout->addWidget(new QLabel("Busiest times:", this));
+    m_peakList = new QListWidget(this);
+    m_peakList->setMaximumHeight(140);
+    layout->addWidget(m_peakList);
+
+    connect(m_computeButton, &QPushButton::clicked, this, &ForecastDialog::compute);
+    connect(&m_watcher, &QFutureWatcher<ScheduleForecast::Partial>::finished, this, &ForecastDialog::onFinished);
+
+    compute();
+}
+
+ForecastDialog::~ForecastDialog()
+{
+    // The chunks point into m_jobs
+    m_watcher.cancel();
+    m_watcher.waitForFinished();
+}
+
+void ForecastDialog::compute()
+{
+    if (m_watcher.isRunning()) {
+        return;
+    }
+
+    m_from = QDateTime::currentDateTime();
+    m_days = m_daysSpinBox->value();
+    m_startedMs = QDateTime::currentMSecsSinceEpoch();
+    m_computeButton->setEnabled(false);
+    m_summaryLabel->setText("Computing...");
+
+    const int threads = QThreadPool::globalInstance()->maxThreadCount();
+    const QVector<ScheduleForecast::Chunk> chunks =
+        ScheduleForecast::makeChunks(m_jobs, m_from, m_days, threads * CHUNKS_PER_THREAD, m_clustered);
+    // Unordered reduce: the merge is a sum, so any order gives the same result
+    m_watcher.setFuture(QtConcurrent::mappedReduced<ScheduleForecast::Partial>(
+        chunks, &ScheduleForecast::simulate, &ScheduleForecast::merge, QtConcurrent::UnorderedReduce));
+}
+
+void ForecastDialog::onFinished()
+{
+    m_computeButton->setEnabled(true);
+    if (m_watcher.isCanceled()) {
+        return;
+    }
+
+    m_result = ScheduleForecast::finish(m_watcher.result(), m_from, m_days);
+    const qint64 elapsedMs = QDateTime::currentMSecsSinceEpoch() - m_startedMs;
+
+    QString peakText = "no runs";
+    if (m_result.peakMinute >= 0) {
+        peakText = QString("peak %1 at once, %2").arg(m_result.peak)
+            .arg(m_from.addSecs(qint64(m_result.peakMinute) * 60).toString("ddd yyyy-MM-dd HH:mm"));
+    }
+    m_summaryLabel->setText(QString("%1 run(s) of %2 job(s), %3 - computed in %4 ms on %5 thread(s)")
+        .arg(m_result.runs).arg(m_jobs.size()).arg(peakText).arg(elapsedMs)
+        .arg(QThreadPool::globalInstance()->maxThreadCount()));
+
+    m_peakList->clear();
+    const QVector<int> peaks = ScheduleForecast::topMinutes(m_result, PEAKS_LISTED);
+    for (int minute : peaks) {
+        m_peakList->addItem(QString("%1  -  %2 job(s) running")
+            .arg(m_from.addSecs(qint64(minute) * 60).toString("ddd yyyy-MM-dd HH:mm"))
+            .arg(m_result.concurrency[minute]));
+    }
+
+    renderHeatMap();
+}
+
+void ForecastDialog::resizeEvent(QResizeEvent *event)
+{
+    QDialog::resizeEvent(event);
+    renderHeatMap();
+}
+
+void ForecastDialog::renderHeatMap()
+{
+    if (m_result.concurrency.isEmpty()) {
+        return;
+    }
+    m_heatMapLabel->setPixmap(QPixmap::fromImage(
+        ScheduleForecast::renderHeatMap(m_result, m_heatMapLabel->size())));
+}
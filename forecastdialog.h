@@ -0,0 +1,48 @@
+#ifndef FORECASTDIALOG_H
+#define FORECASTDIALOG_H
+
+#include <QDialog>
+#include <QFutureWatcher>
+#include <QLabel>
+#include <QListWidget>
+#include <QPushButton>
+#include <QSpinBox>
+#include "cronjob.h"
+#include "scheduleforecast.h"
+
+// Shows when jobs will run over the coming days as a heat-map of how many
+// run at once, so clusters of start times can be spread out before they
+// happen. The simulation runs on the global thread pool.
+class ForecastDialog : public QDialog
+{
+    Q_OBJECT
+
+public:
+    explicit ForecastDialog(const QVector<CronJob>& jobs, bool clustered = false, QWidget *parent = nullptr);
+    ~ForecastDialog();
+
+protected:
+    void resizeEvent(QResizeEvent *event) override;
+
+private slots:
+    void compute();
+    void onFinished();
+
+private:
+    void renderHeatMap();
+
+    QVector<CronJob> m_jobs;   // Snapshot; chunks point into it while computing
+    QSpinBox* m_daysSpinBox;
+    QPushButton* m_computeButton;
+    QLabel* m_summaryLabel;
+    QLabel* m_heatMapLabel;
+    QListWidget* m_peakList;
+    QFutureWatcher<ScheduleForecast::Partial> m_watcher;
+    QDateTime m_from;
+    int m_days;
+    bool m_clustered;   // Runs snap to slot boundaries, as on a cluster node
+    qint64 m_startedMs;
+    ScheduleForecast::Result m_result;
+};
+
+#endif // FORECASTDIALOG_H
@@ -5,6 +5,7 @@
 #include <QFileDialog>
 #include <QMessageBox>
 #include <QGroupBox>
+#include <QLibrary>
 
 JobEditDialog::JobEditDialog(QWidget *parent)
     : QDialog(parent)
@@ -35,6 +36,10 @@ void JobEditDialog::setupUI()
     m_nameEdit->setPlaceholderText("Enter a descriptive name for this job");
     formLayout->addRow("Name:", m_nameEdit);
     
+    m_groupEdit = new QLineEdit(this);
+    m_groupEdit->setPlaceholderText("Optional; jobs in a group share its concurrency limit");
+    formLayout->addRow("Group:", m_groupEdit);
+    
     // Script path with browse button
     QHBoxLayout* scriptLayout = new QHBoxLayout();
     m_scriptPathEdit = new QLineEdit(this);
@@ -48,6 +53,19 @@ void JobEditDialog::setupUI()
     m_argumentsEdit->setPlaceholderText("Optional command line arguments");
     formLayout->addRow("Arguments:", m_argumentsEdit);
     
+    m_inProcessCheck = new QCheckBox("Run in-process (the file is a CronTask plugin library)", this);
+    m_inProcessCheck->setToolTip("Calls the plugin on a worker thread instead of starting a process; best for small, frequent checks");
+    formLayout->addRow("", m_inProcessCheck);
+    
+    m_timeoutSpinBox = new QSpinBox(this);
+    m_timeoutSpinBox->setRange(0, 86400);
+    m_timeoutSpinBox->setSuffix(" s");
+    m_timeoutSpinBox->setSpecialValueText("No limit");
+    m_timeoutSpinBox->setValue(60);
+    m_timeoutSpinBox->setEnabled(false);
+    m_timeoutSpinBox->setToolTip("The run counts as failed after this long and the plugin is asked to stop");
+    formLayout->addRow("Time limit:", m_timeoutSpinBox);
+    
     mainLayout->addWidget(detailsGroup);
     
     // Custom Command Group
@@ -76,12 +94,18 @@ void JobEditDialog::setupUI()
     mainLayout->addWidget(commandGroup);
     
     connect(m_useCustomCommandCheck, &QCheckBox::toggled, this, &JobEditDialog::onCustomCommandToggled);
+    connect(m_inProcessCheck, &QCheckBox::toggled, this, &JobEditDialog::onInProcessToggled);
     connect(m_browseCommandButton, &QPushButton::clicked, this, &JobEditDialog::browseCustomCommand);
     
     // Schedule Group
     QGroupBox* scheduleGroup = new QGroupBox("Schedule", this);
     QFormLayout* scheduleLayout = new QFormLayout(scheduleGroup);
     
+    m_triggerCombo = new QComboBox(this);
+    m_triggerCombo->addItem("On an interval", CronJob::IntervalTrigger);
+    m_triggerCombo->addItem("When files change", CronJob::FileChangeTrigger);
+    scheduleLayout->addRow("Trigger:", m_triggerCombo);
+    
     QHBoxLayout* intervalLayout = new QHBoxLayout();
     m_intervalSpinBox = new QSpinBox(this);
     m_intervalSpinBox->setMinimum(1);
@@ -92,6 +116,7 @@ void JobEditDialog::setupUI()
     m_intervalUnitCombo->addItem("Minutes", 1);
     m_intervalUnitCombo->addItem("Hours", 60);
     m_intervalUnitCombo->addItem("Days", 1440);
+    m_intervalUnitCombo->addItem("Seconds", 0);   // In-process jobs only
     m_intervalUnitCombo->setCurrentIndex(1); // Default to hours
     
     intervalLayout->addWidget(m_intervalSpinBox);
@@ -99,12 +124,100 @@ void JobEditDialog::setupUI()
     intervalLayout->addStretch();
     scheduleLayout->addRow("Run every:", intervalLayout);
     
+    m_deadlineSpinBox = new QSpinBox(this);
+    m_deadlineSpinBox->setRange(0, 10080);
+    m_deadlineSpinBox->setSpecialValueText("No deadline");
+    m_deadlineSpinBox->setSuffix(" min after it is due");
+    m_deadlineSpinBox->setToolTip("Runs are started early when past run times say they would finish late, "
+                                  "and go ahead of other waiting jobs with later deadlines");
+    scheduleLayout->addRow("Finish within:", m_deadlineSpinBox);
+    
+    // File-change trigger
+    QHBoxLayout* watchLayout = new QHBoxLayout();
+    m_watchPathEdit = new QLineEdit(this);
+    m_watchPathEdit->setPlaceholderText("Folder or file to watch");
+    m_browseWatchButton = new QPushButton("Browse...", this);
+    watchLayout->addWidget(m_watchPathEdit);
+    watchLayout->addWidget(m_browseWatchButton);
+    scheduleLayout->addRow("Watch:", watchLayout);
+    
+    m_watchFilterEdit = new QLineEdit(this);
+    m_watchFilterEdit->setPlaceholderText("e.g., *.csv;*.txt (leave empty for any file)");
+    scheduleLayout->addRow("File filter:", m_watchFilterEdit);
+    
+    m_debounceSpinBox = new QSpinBox(this);
+    m_debounceSpinBox->setRange(0, 600000);
+    m_debounceSpinBox->setSingleStep(100);
+    m_debounceSpinBox->setSuffix(" ms");
+    m_debounceSpinBox->setValue(500);
+    m_debounceSpinBox->setToolTip("Wait until files have stopped changing for this long before running");
+    scheduleLayout->addRow("Quiet period:", m_debounceSpinBox);
+    
     m_enabledCheck = new QCheckBox("Job is enabled", this);
     m_enabledCheck->setChecked(true);
     scheduleLayout->addRow("", m_enabledCheck);
     
+    m_alertCheck = new QCheckBox("Notify me right away when it finishes", this);
+    m_alertCheck->setToolTip("Otherwise finished jobs are reported together in a periodic summary");
+    scheduleLayout->addRow("", m_alertCheck);
+    
+    m_lowPriorityCheck = new QCheckBox("Low priority: wait while the computer is busy", this);
+    m_lowPriorityCheck->setToolTip("Runs are held back while load or CPU/memory pressure is high, for at most an hour by default");
+    scheduleLayout->addRow("", m_lowPriorityCheck);
+    
+    m_keepOutputSpinBox = new QSpinBox(this);
+    m_keepOutputSpinBox->setRange(0, 3650);
+    m_keepOutputSpinBox->setSpecialValueText("Forever");
+    m_keepOutputSpinBox->setSuffix(" days");
+    m_keepOutputSpinBox->setToolTip("Stored output of older runs is deleted during the hourly compaction");
+    scheduleLayout->addRow("Keep output:", m_keepOutputSpinBox);
+    
     mainLayout->addWidget(scheduleGroup);
     
+    connect(m_triggerCombo, QOverload<int>::of(&QComboBox::currentIndexChanged), this, &JobEditDialog::onTriggerTypeChanged);
+    connect(m_browseWatchButton, &QPushButton::clicked, this, &JobEditDialog::browseWatchPath);
+    onTriggerTypeChanged(m_triggerCombo->currentIndex());
+    
+    // Failure Handling Group
+    QGroupBox* failureGroup = new QGroupBox("When the Job Fails", this);
+    QFormLayout* failureLayout = new QFormLayout(failureGroup);
+    
+    m_retrySpinBox = new QSpinBox(this);
+    m_retrySpinBox->setRange(0, 10);
+    m_retrySpinBox->setSpecialValueText("Don't retry");
+    failureLayout->addRow("Retries:", m_retrySpinBox);
+    
+    m_retryDelaySpinBox = new QSpinBox(this);
+    m_retryDelaySpinBox->setRange(1, 3600);
+    m_retryDelaySpinBox->setSuffix(" s");
+    m_retryDelaySpinBox->setValue(30);
+    m_retryDelaySpinBox->setToolTip("Doubles for each further retry, with some random spread");
+    failureLayout->addRow("First retry after:", m_retryDelaySpinBox);
+    
+    m_breakerSpinBox = new QSpinBox(this);
+    m_breakerSpinBox->setRange(0, 100);
+    m_breakerSpinBox->setSpecialValueText("Never");
+    m_breakerSpinBox->setSuffix(" failures in a row");
+    failureLayout->addRow("Pause after:", m_breakerSpinBox);
+    
+    m_breakerCooldownSpinBox = new QSpinBox(this);
+    m_breakerCooldownSpinBox->setRange(1, 10080);
+    m_breakerCooldownSpinBox->setSuffix(" min");
+    m_breakerCooldownSpinBox->setValue(15);
+    m_breakerCooldownSpinBox->setToolTip("A paused job gets one trial run after this long; it resumes if that run succeeds");
+    failureLayout->addRow("Try again after:", m_breakerCooldownSpinBox);
+    
+    mainLayout->addWidget(failureGroup);
+    
+    connect(m_retrySpinBox, QOverload<int>::of(&QSpinBox::valueChanged), this, [this](int value) {
+        m_retryDelaySpinBox->setEnabled(value > 0);
+    });
+    connect(m_breakerSpinBox, QOverload<int>::of(&QSpinBox::valueChanged), this, [this](int value) {
+        m_breakerCooldownSpinBox->setEnabled(value > 0);
+    });
+    m_retryDelaySpinBox->setEnabled(false);
+    m_breakerCooldownSpinBox->setEnabled(false);
+    
     // Buttons
     QHBoxLayout* buttonLayout = new QHBoxLayout();
     buttonLayout->addStretch();
@@ -131,6 +244,7 @@ void JobEditDialog::populateFromJob(const CronJob& job)
     m_nextRun = job.nextRun;
     
     m_nameEdit->setText(job.name);
+    m_groupEdit->setText(job.group);
     m_scriptPathEdit->setText(job.scriptPath);
     m_argumentsEdit->setText(job.arguments);
     m_useCustomCommandCheck->setChecked(job.useCustomCommand);
@@ -138,10 +252,27 @@ void JobEditDialog::populateFromJob(const CronJob& job)
     m_customCommandEdit->setEnabled(job.useCustomCommand);
     m_browseCommandButton->setEnabled(job.useCustomCommand);
     m_enabledCheck->setChecked(job.enabled);
+    m_alertCheck->setChecked(job.alertImmediately);
+    m_lowPriorityCheck->setChecked(job.lowPriority);
+    m_keepOutputSpinBox->setValue(job.keepOutputDays);
+    m_inProcessCheck->setChecked(job.runInProcess);
+    m_timeoutSpinBox->setValue(job.timeoutSeconds);
+    m_triggerCombo->setCurrentIndex(m_triggerCombo->findData(job.triggerType));
+    m_watchPathEdit->setText(job.watchPath);
+    m_watchFilterEdit->setText(job.watchFilter);
+    m_debounceSpinBox->setValue(job.debounceMs);
+    m_deadlineSpinBox->setValue(job.deadlineMinutes);
+    m_retrySpinBox->setValue(job.maxRetries);
+    m_retryDelaySpinBox->setValue(job.retryDelaySeconds);
+    m_breakerSpinBox->setValue(job.breakerThreshold);
+    m_breakerCooldownSpinBox->setValue(job.breakerCooldownMinutes);
     
     // Convert minutes to appropriate unit
     int minutes = job.intervalMinutes;
-    if (minutes >= 1440 && minutes % 1440 == 0) {
+    if (job.intervalSeconds > 0) {
+        m_intervalSpinBox->setValue(job.intervalSeconds);
+        m_intervalUnitCombo->setCurrentIndex(3); // Seconds
+    } else if (minutes >= 1440 && minutes % 1440 == 0) {
         m_intervalSpinBox->setValue(minutes / 1440);
         m_intervalUnitCombo->setCurrentIndex(2); // Days
     } else if (minutes >= 60 && minutes % 60 == 0) {
@@ -162,6 +293,36 @@ void JobEditDialog::onCustomCommandToggled(bool checked)
     }
 }
 
+void JobEditDialog::onInProcessToggled(bool checked)
+{
+    // A plugin is loaded, not run by an interpreter
+    m_timeoutSpinBox->setEnabled(checked);
+    m_useCustomCommandCheck->setEnabled(!checked);
+    if (checked) {
+        m_useCustomCommandCheck->setChecked(false);
+    }
+}
+
+void JobEditDialog::onTriggerTypeChanged(int index)
+{
+    bool fileChange = m_triggerCombo->itemData(index).toInt() == CronJob::FileChangeTrigger;
+    m_intervalSpinBox->setEnabled(!fileChange);
+    m_intervalUnitCombo->setEnabled(!fileChange);
+    m_deadlineSpinBox->setEnabled(!fileChange);
+    m_watchPathEdit->setEnabled(fileChange);
+    m_browseWatchButton->setEnabled(fileChange);
+    m_watchFilterEdit->setEnabled(fileChange);
+    m_debounceSpinBox->setEnabled(fileChange);
+}
+
+void JobEditDialog::browseWatchPath()
+{
+    QString dirName = QFileDialog::getExistingDirectory(this, "Select Folder to Watch", m_watchPathEdit->text());
+    if (!dirName.isEmpty()) {
+        m_watchPathEdit->setText(dirName);
+    }
+}
+
 void JobEditDialog::browseCustomCommand()
 {
     QString filter = "Executables (*.exe);;All Files (*.*)";
@@ -207,6 +368,33 @@ void JobEditDialog::validateAndAccept()
         return;
     }
     
+    if (m_inProcessCheck->isChecked() && !QLibrary::isLibrary(fileInfo.fileName())) {
+        QMessageBox::warning(this, "Validation Error", "In-process jobs need a plugin library (.dll, .so or .dylib).");
+        m_scriptPathEdit->setFocus();
+        return;
+    }
+    
+    if (m_triggerCombo->currentData().toInt() == CronJob::IntervalTrigger
+        && m_intervalUnitCombo->currentData().toInt() == 0) {
+        if (!m_inProcessCheck->isChecked()) {
+            QMessageBox::warning(this, "Validation Error", "Intervals in seconds are only for in-process jobs.");
+            m_intervalUnitCombo->setFocus();
+            return;
+        }
+        if (m_intervalSpinBox->value() > 59) {
+            QMessageBox::warning(this, "Validation Error", "Use minutes for intervals of a minute or more.");
+            m_intervalSpinBox->setFocus();
+            return;
+        }
+    }
+    
+    if (m_triggerCombo->currentData().toInt() == CronJob::FileChangeTrigger
+        && !QFileInfo::exists(m_watchPathEdit->text().trimmed())) {
+        QMessageBox::warning(this, "Validation Error", "Please select an existing folder or file to watch.");
+        m_watchPathEdit->setFocus();
+        return;
+    }
+    
     accept();
 }
 
@@ -221,14 +409,36 @@ CronJob JobEditDialog::getJob() const
     }
     
     job.name = m_nameEdit->text().trimmed();
+    job.group = m_groupEdit->text().trimmed();
     job.scriptPath = m_scriptPathEdit->text().trimmed();
     job.arguments = m_argumentsEdit->text().trimmed();
     job.useCustomCommand = m_useCustomCommandCheck->isChecked();
     job.customCommand = m_customCommandEdit->text().trimmed();
     job.enabled = m_enabledCheck->isChecked();
+    job.alertImmediately = m_alertCheck->isChecked();
+    job.lowPriority = m_lowPriorityCheck->isChecked();
+    job.keepOutputDays = m_keepOutputSpinBox->value();
+    job.runInProcess = m_inProcessCheck->isChecked();
+    job.timeoutSeconds = m_timeoutSpinBox->value();
+    job.triggerType = static_cast<CronJob::TriggerType>(m_triggerCombo->currentData().toInt());
+    job.watchPath = m_watchPathEdit->text().trimmed();
+    job.watchFilter = m_watchFilterEdit->text().trimmed();
+    job.debounceMs = m_debounceSpinBox->value();
+    job.deadlineMinutes = m_deadlineSpinBox->value();
+    job.maxRetries = m_retrySpinBox->value();
+    job.retryDelaySeconds = m_retryDelaySpinBox->value();
+    job.breakerThreshold = m_breakerSpinBox->value();
+    job.breakerCooldownMinutes = m_breakerCooldownSpinBox->value();
+    // Failure counts are left at zero: saving a paused job resumes it
     
     int multiplier = m_intervalUnitCombo->currentData().toInt();
-    job.intervalMinutes = m_intervalSpinBox->value() * multiplier;
+    if (multiplier == 0) {
+        job.intervalSeconds = m_intervalSpinBox->value();
+        job.intervalMinutes = 1;
+    } else {
+        job.intervalSeconds = 0;
+        job.intervalMinutes = m_intervalSpinBox->value() * multiplier;
+    }
     
     return job;
 }
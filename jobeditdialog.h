@@ -25,21 +25,40 @@ private slots:
     void browseCustomCommand();
     void validateAndAccept();
     void onCustomCommandToggled(bool checked);
+    void onTriggerTypeChanged(int index);
+    void onInProcessToggled(bool checked);
+    void browseWatchPath();
 
 private:
     void setupUI();
     void populateFromJob(const CronJob& job);
 
     QLineEdit* m_nameEdit;
+    QLineEdit* m_groupEdit;
     QLineEdit* m_scriptPathEdit;
     QPushButton* m_browseButton;
     QLineEdit* m_argumentsEdit;
+    QCheckBox* m_inProcessCheck;
+    QSpinBox* m_timeoutSpinBox;
     QCheckBox* m_useCustomCommandCheck;
     QLineEdit* m_customCommandEdit;
     QPushButton* m_browseCommandButton;
     QSpinBox* m_intervalSpinBox;
     QComboBox* m_intervalUnitCombo;
+    QComboBox* m_triggerCombo;
+    QLineEdit* m_watchPathEdit;
+    QPushButton* m_browseWatchButton;
+    QLineEdit* m_watchFilterEdit;
+    QSpinBox* m_debounceSpinBox;
+    QSpinBox* m_deadlineSpinBox;
     QCheckBox* m_enabledCheck;
+    QCheckBox* m_alertCheck;
+    QCheckBox* m_lowPriorityCheck;
+    QSpinBox* m_keepOutputSpinBox;
+    QSpinBox* m_retrySpinBox;
+    QSpinBox* m_retryDelaySpinBox;
+    QSpinBox* m_breakerSpinBox;
+    QSpinBox* m_breakerCooldownSpinBox;
     
     QString m_jobId;
     QDateTime m_lastRun;
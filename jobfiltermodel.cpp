@@ -0,0 +1,61 @@
+#include "jobfiltermodel.h"
+#include "jobtablemodel.h"
+#include <QElapsedTimer>
+
+JobFilterModel::JobFilterModel(JobTableModel* jobs, QObject *parent)
+    : QSortFilterProxyModel(parent)
+    , m_jobs(jobs)
+    , m_lastSearchMs(0)
+{
+    m_jobs->setSearchIndexEnabled(true);
+
+    // Connected before setSourceModel() so the matches are current by the
+    // time the proxy reacts to the same signals
+    connect(m_jobs, &JobTableModel::jobReindexed, this, &JobFilterModel::onJobReindexed);
+    connect(m_jobs, &QAbstractItemModel::modelReset, this, [this]() {
+        if (!m_terms.isEmpty()) {
+            m_matches = m_jobs->matchingJobs(m_terms);
+        }
+    });
+
+    setSourceModel(m_jobs);
+    setSortRole(JobTableModel::SortRole);
+    setDynamicSortFilter(true);
+}
+
+void JobFilterModel::setSearchText(const QString& text)
+{
+    QElapsedTimer timer;
+    timer.start();
+
+    QStringList terms = JobTableModel::tokenize(text);
+    if (terms == m_terms) {
+        return;
+    }
+    m_terms = terms;
+    m_matches = m_terms.isEmpty() ? QSet<QString>() : m_jobs->matchingJobs(m_terms);
+    invalidateFilter();
+
+    m_lastSearchMs = timer.elapsed();
+}
+
+bool JobFilterModel::filterAcceptsRow(int sourceRow, const QModelIndex& sourceParent) const
+{
+    if (m_terms.isEmpty()) {
+        return true;
+    }
+    Q_UNUSED(sourceParent);
+    return m_matches.contains(m_jobs->jobs().at(sourceRow).id);
+}
+
+void JobFilterModel::onJobReindexed(const QString& jobId)
+{
+    if (m_terms.isEmpty()) {
+        return;
+    }
+    if (m_jobs->jobMatches(jobId, m_terms)) {
+        m_matches.insert(jobId);
+    } else {
+        m_matches.remove(jobId);
+    }
+}
@@ -0,0 +1,37 @@
+#ifndef JOBFILTERMODEL_H
+#define JOBFILTERMODEL_H
+
+#include <QSortFilterProxyModel>
+#include <QSet>
+#include <QStringList>
+
+class JobTableModel;
+
+// Filter bar and column sorting for the job table. A search is answered
+// from the job model's token index once per keystroke; rows then only need
+// a set lookup. Sorting uses typed keys and stays incremental, so a job
+// whose next run changes just moves to its new place.
+class JobFilterModel : public QSortFilterProxyModel
+{
+    Q_OBJECT
+
+public:
+    explicit JobFilterModel(JobTableModel* jobs, QObject *parent = nullptr);
+
+    void setSearchText(const QString& text);
+    qint64 lastSearchMs() const { return m_lastSearchMs; }
+
+protected:
+    bool filterAcceptsRow(int sourceRow, const QModelIndex& sourceParent) const override;
+
+private slots:
+    void onJobReindexed(const QString& jobId);
+
+private:
+    JobTableModel* m_jobs;
+    QStringList m_terms;
+    QSet<QString> m_matches;   // Ids of the jobs matching m_terms
+    qint64 m_lastSearchMs;
+};
+
+#endif // JOBFILTERMODEL_H
@@ -0,0 +1,420 @@
+#include "jobprocess.h"
+#include <QProcess>
+#include <QSettings>
+#include <QTimer>
+
+#ifdef Q_OS_LINUX
+#include <QFile>
+#include <QSocketNotifier>
+#include <QVector>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <signal.h>
+#include <spawn.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#ifndef SYS_pidfd_open
+#define SYS_pidfd_open 434   // Same number on every architecture
+#endif
+
+// posix_spawn_file_actions_addchdir_np() arrived in glibc 2.29
+#if defined(__GLIBC__)
+#if __GLIBC_PREREQ(2, 29)
+#define HAVE_SPAWN_CHDIR 1
+#endif
+#endif
+#endif
+
+namespace {
+
+const int REAP_POLL_MS = 100;   // Only if a pidfd can't be had for a process
+
+// QProcess, with stdin from the null device like the spawn backend
+class PortableProcess : public JobProcess
+{
+public:
+    explicit PortableProcess(QObject *parent)
+        : JobProcess(parent)
+        , m_process(new QProcess(this))
+    {
+        m_process->setStandardInputFile(QProcess::nullDevice());
+        connect(m_process, &QProcess::started, this, &JobProcess::started);
+        connect(m_process, &QProcess::readyReadStandardOutput, this, &JobProcess::readyReadStandardOutput);
+        connect(m_process, &QProcess::readyReadStandardError, this, &JobProcess::readyReadStandardError);
+        connect(m_process, QOverload<int, QProcess::ExitStatus>::of(&QProcess::finished),
+                this, [this](int exitCode, QProcess::ExitStatus status) {
+            emit finished(exitCode, status == QProcess::CrashExit);
+        });
+        connect(m_process, &QProcess::errorOccurred, this, [this](QProcess::ProcessError error) {
+            // Other errors are followed by finished()
+            if (error == QProcess::FailedToStart) {
+                const QString message = QString("Failed to start: %1").arg(m_process->errorString());
+                QMetaObject::invokeMethod(this, [this, message]() { emit failedToStart(message); }, Qt::QueuedConnection);
+            }
+        });
+    }
+
+    void start(const QString& program, const QStringList& arguments,
+               const QString& workingDirectory, const QProcessEnvironment& environment) override
+    {
+        if (!workingDirectory.isEmpty()) {
+            m_process->setWorkingDirectory(workingDirectory);
+        }
+        m_process->setProcessEnvironment(environment);
+        m_process->start(program, arguments);
+    }
+
+    qint64 processId() const override { return m_process->processId(); }
+    QByteArray readAllStandardOutput() override { return m_process->readAllStandardOutput(); }
+    QByteArray readAllStandardError() override { return m_process->readAllStandardError(); }
+
+private:
+    QProcess* m_process;
+};
+
+#ifdef Q_OS_LINUX
+// posix_spawn() runs the child on a vfork-style clone in glibc, so the
+// parent's page tables are never copied however large the GUI heap is,
+// and the call returns once exec has succeeded or failed. Completion comes
+// from a pidfd becoming readable, and output is read straight from the
+// pipes, with no helper threads or signal handlers involved.
+class SpawnProcess : public JobProcess
+{
+public:
+    explicit SpawnProcess(QObject *parent)
+        : JobProcess(parent)
+        , m_pid(-1)
+        , m_pidFd(-1)
+        , m_outFd(-1)
+        , m_errFd(-1)
+        , m_pidNotifier(nullptr)
+        , m_outNotifier(nullptr)
+        , m_errNotifier(nullptr)
+        , m_reapTimer(nullptr)
+    {
+    }
+
+    ~SpawnProcess() override
+    {
+        if (m_pid > 0) {
+            // Like QProcess: a job process doesn't outlive its handle
+            ::kill(m_pid, SIGKILL);
+            while (::waitpid(m_pid, nullptr, 0) < 0 && errno == EINTR) {
+            }
+        }
+        closeFd(m_pidFd, m_pidNotifier);
+        closeFd(m_outFd, m_outNotifier);
+        closeFd(m_errFd, m_errNotifier);
+    }
+
+    void start(const QString& program, const QStringList& arguments,
+               const QString& workingDirectory, const QProcessEnvironment& environment) override
+    {
+        int outPipe[2];
+        int errPipe[2];
+        if (::pipe2(outPipe, O_CLOEXEC) != 0) {
+            fail(errno);
+            return;
+        }
+        if (::pipe2(errPipe, O_CLOEXEC) != 0) {
+            const int pipeError = errno;
+            ::close(outPipe[0]);
+            ::close(outPipe[1]);
+            fail(pipeError);
+            return;
+        }
+
+        // Everything the child needs is built before the spawn
+        const QByteArray file = QFile::encodeName(program);
+        QVector<QByteArray> argStore;
+        argStore.reserve(arguments.size() + 1);
+        argStore.append(file);
+        for (const QString& argument : arguments) {
+            argStore.append(argument.toLocal8Bit());
+        }
+        QVector<QByteArray> envStore;
+        for (const QString& variable : environment.toStringList()) {
+            envStore.append(variable.toLocal8Bit());
+        }
+        QVector<char*> argv;
+        for (QByteArray& arg : argStore) {
+            argv.append(arg.data());
+        }
+        argv.append(nullptr);
+        QVector<char*> envp;
+        for (QByteArray& variable : envStore) {
+            envp.append(variable.data());
+        }
+        envp.append(nullptr);
+        const QByteArray directory = QFile::encodeName(workingDirectory);
+
+        // Each action that can't be recorded fails the start, rather than
+        // running the job with the wrong stdio or directory
+        posix_spawn_file_actions_t actions;
+        int error = posix_spawn_file_actions_init(&actions);
+        if (error != 0) {
+            closePipes(outPipe, errPipe);
+            fail(error);
+            return;
+        }
+        error = posix_spawn_file_actions_addopen(&actions, STDIN_FILENO, "/dev/null", O_RDONLY, 0);
+        if (error == 0) {
+            error = posix_spawn_file_actions_adddup2(&actions, outPipe[1], STDOUT_FILENO);
+        }
+        if (error == 0) {
+            error = posix_spawn_file_actions_adddup2(&actions, errPipe[1], STDERR_FILENO);
+        }
+#ifdef HAVE_SPAWN_CHDIR
+        if (error == 0 && !directory.isEmpty()) {
+            error = posix_spawn_file_actions_addchdir_np(&actions, directory.constData());
+        }
+#endif
+        if (error != 0) {
+            posix_spawn_file_actions_destroy(&actions);
+            closePipes(outPipe, errPipe);
+            fail(error);
+            return;
+        }
+
+        // Ignored signals survive exec; give the job the defaults
+        posix_spawnattr_t attr;
+        posix_spawnattr_init(&attr);
+        sigset_t signals;
+        sigemptyset(&signals);
+        posix_spawnattr_setsigmask(&attr, &signals);
+        sigfillset(&signals);
+        posix_spawnattr_setsigdefault(&attr, &signals);
+        posix_spawnattr_setflags(&attr, POSIX_SPAWN_SETSIGMASK | POSIX_SPAWN_SETSIGDEF);
+
+        pid_t pid = -1;
+        error = ::posix_spawnp(&pid, file.constData(), &actions, &attr, argv.data(), envp.data());
+        posix_spawn_file_actions_destroy(&actions);
+        posix_spawnattr_destroy(&attr);
+        ::close(outPipe[1]);
+        ::close(errPipe[1]);
+        if (error != 0) {
+            ::close(outPipe[0]);
+            ::close(errPipe[0]);
+            fail(error);
+            return;
+        }
+
+        m_pid = pid;
+        m_outFd = outPipe[0];
+        m_errFd = errPipe[0];
+        ::fcntl(m_outFd, F_SETFL, ::fcntl(m_outFd, F_GETFL) | O_NONBLOCK);
+        ::fcntl(m_errFd, F_SETFL, ::fcntl(m_errFd, F_GETFL) | O_NONBLOCK);
+        m_outNotifier = new QSocketNotifier(m_outFd, QSocketNotifier::Read, this);
+        connect(m_outNotifier, &QSocketNotifier::activated, this, [this]() { readPipe(m_outFd, m_outNotifier, m_out); });
+        m_errNotifier = new QSocketNotifier(m_errFd, QSocketNotifier::Read, this);
+        connect(m_errNotifier, &QSocketNotifier::activated, this, [this]() { readPipe(m_errFd, m_errNotifier, m_err); });
+
+        // The pid can't be reused before we reap it, so this is the right process
+        m_pidFd = int(::syscall(SYS_pidfd_open, pid, 0));
+        if (m_pidFd >= 0) {
+            m_pidNotifier = new QSocketNotifier(m_pidFd, QSocketNotifier::Read, this);
+            connect(m_pidNotifier, &QSocketNotifier::activated, this, [this]() { reap(); });
+        } else {
+            m_reapTimer = new QTimer(this);
+            connect(m_reapTimer, &QTimer::timeout, this, [this]() { reap(); });
+            m_reapTimer->start(REAP_POLL_MS);
+        }
+        QMetaObject::invokeMethod(this, [this]() { emit started(); }, Qt::QueuedConnection);
+    }
+
+    qint64 processId() const override { return m_pid > 0 ? m_pid : 0; }
+    RunUsage usage() const override { return m_usage; }
+
+    QByteArray readAllStandardOutput() override
+    {
+        QByteArray data;
+        data.swap(m_out);
+        return data;
+    }
+
+    QByteArray readAllStandardError() override
+    {
+        QByteArray data;
+        data.swap(m_err);
+        return data;
+    }
+
+private:
+    static void closePipes(int outPipe[2], int errPipe[2])
+    {
+        ::close(outPipe[0]);
+        ::close(outPipe[1]);
+        ::close(errPipe[0]);
+        ::close(errPipe[1]);
+    }
+
+    void fail(int error)
+    {
+        const QString message = QString("Failed to start: %1").arg(QString::fromLocal8Bit(::strerror(error)));
+        QMetaObject::invokeMethod(this, [this, message]() { emit failedToStart(message); }, Qt::QueuedConnection);
+    }
+
+    // Reads what the pipe has; false once the other end is closed
+    bool drain(int fd, QByteArray& buffer)
+    {
+        char chunk[16384];
+        for (;;) {
+            const ssize_t n = ::read(fd, chunk, sizeof(chunk));
+            if (n > 0) {
+                buffer.append(chunk, int(n));
+            } else if (n < 0 && errno == EINTR) {
+                continue;
+            } else {
+                return n < 0 && errno == EAGAIN;
+            }
+        }
+    }
+
+    void readPipe(int& fd, QSocketNotifier*& notifier, QByteArray& buffer)
+    {
+        const int before = buffer.size();
+        const bool open = drain(fd, buffer);
+        const bool isOutput = &buffer == &m_out;
+        if (!open) {
+            closeFd(fd, notifier);
+        }
+        if (buffer.size() > before) {
+            if (isOutput) {
+                emit readyReadStandardOutput();
+            } else {
+                emit readyReadStandardError();
+            }
+        }
+    }
+
+    void reap()
+    {
+        // wait4 hands over this child's own totals, descendants it waited
+        // for included, so every run is measured exactly to its end
+        int status = 0;
+        struct rusage ru;
+        pid_t result;
+        do {
+            result = ::wait4(m_pid, &status, WNOHANG, &ru);
+        } while (result < 0 && errno == EINTR);
+        if (result == 0) {
+            return;
+        }
+        if (result == m_pid) {
+            m_usage.cpuMs = (qint64(ru.ru_utime.tv_sec) + ru.ru_stime.tv_sec) * 1000
+                          + (ru.ru_utime.tv_usec + ru.ru_stime.tv_usec) / 1000;
+            m_usage.peakRssBytes = qint64(ru.ru_maxrss) * 1024;
+            m_usage.readBytes = qint64(ru.ru_inblock) * 512;
+            m_usage.writeBytes = qint64(ru.ru_oublock) * 512;
+        }
+
+        int exitCode = -1;
+        bool crashed = true;   // Reaped elsewhere: no status to go by
+        if (result == m_pid && WIFEXITED(status)) {
+            exitCode = WEXITSTATUS(status);
+            crashed = false;
+        } else if (result == m_pid && WIFSIGNALED(status)) {
+            exitCode = WTERMSIG(status);
+        }
+        m_pid = -1;
+        closeFd(m_pidFd, m_pidNotifier);
+        if (m_reapTimer) {
+            m_reapTimer->stop();
+            m_reapTimer->deleteLater();
+            m_reapTimer = nullptr;
+        }
+
+        // Output written before the exit is in the pipes now; a background
+        // child that inherited them may keep them open, so don't wait for EOF
+        if (m_outFd >= 0) {
+            readPipe(m_outFd, m_outNotifier, m_out);
+        }
+        if (m_errFd >= 0) {
+            readPipe(m_errFd, m_errNotifier, m_err);
+        }
+        closeFd(m_outFd, m_outNotifier);
+        closeFd(m_errFd, m_errNotifier);
+        emit finished(exitCode, crashed);
+    }
+
+    // Safe from the notifier's own activated() signal
+    static void closeFd(int& fd, QSocketNotifier*& notifier)
+    {
+        if (notifier) {
+            notifier->setEnabled(false);
+            notifier->deleteLater();
+            notifier = nullptr;
+        }
+        if (fd >= 0) {
+            ::close(fd);
+            fd = -1;
+        }
+    }
+
+    pid_t m_pid;
+    int m_pidFd;
+    int m_outFd;
+    int m_errFd;
+    QSocketNotifier* m_pidNotifier;
+    QSocketNotifier* m_outNotifier;
+    QSocketNotifier* m_errNotifier;
+    QTimer* m_reapTimer;
+    QByteArray m_out;
+    QByteArray m_err;
+    RunUsage m_usage;
+};
+#endif
+
+}
+
+JobProcess::Backend JobProcess::defaultBackend()
+{
+    QSettings settings;
+    const QString name = settings.value("launcher/backend", "spawn").toString();
+    if (name == "spawn" && isSupported(SpawnBackend)) {
+        return SpawnBackend;
+    }
+    return QProcessBackend;
+}
+
+bool JobProcess::isSupported(Backend backend)
+{
+    if (backend == QProcessBackend) {
+        return true;
+    }
+#if defined(Q_OS_LINUX) && defined(HAVE_SPAWN_CHDIR)
+    // pidfd_open() needs Linux 5.3
+    static const bool hasPidFd = [] {
+        const int fd = int(::syscall(SYS_pidfd_open, ::getpid(), 0));
+        if (fd < 0) {
+            return false;
+        }
+        ::close(fd);
+        return true;
+    }();
+    return hasPidFd;
+#else
+    return false;
+#endif
+}
+
+QString JobProcess::backendName(Backend backend)
+{
+    return backend == SpawnBackend ? QString("posix_spawn") : QString("QProcess");
+}
+
+JobProcess* JobProcess::create(Backend backend, QObject *parent)
+{
+#ifdef Q_OS_LINUX
+    if (backend == SpawnBackend && isSupported(SpawnBackend)) {
+        return new SpawnProcess(parent);
+    }
+#else
+    Q_UNUSED(backend);
+#endif
+    return new PortableProcess(parent);
+}
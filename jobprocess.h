@@ -0,0 +1,55 @@
+#ifndef JOBPROCESS_H
+#define JOBPROCESS_H
+
+#include <QObject>
+#include <QByteArray>
+#include <QProcessEnvironment>
+#include <QStringList>
+#include "processstats.h"
+
+// A job's child process, whichever way it is launched. Emits started()
+// once it runs, readyRead*() as output arrives and, after the output
+// available at exit has been read, exactly one of finished() or
+// failedToStart(). Both of those come from the event loop, never from
+// inside start(). Use create() to get one.
+class JobProcess : public QObject
+{
+    Q_OBJECT
+
+public:
+    enum Backend {
+        QProcessBackend,   // Portable
+        SpawnBackend       // Linux: posix_spawn, pidfd and plain pipes
+    };
+
+    // The backend from the [launcher] settings, or QProcessBackend where
+    // the preferred one isn't supported
+    static Backend defaultBackend();
+    static bool isSupported(Backend backend);
+    static QString backendName(Backend backend);
+    static JobProcess* create(Backend backend, QObject *parent = nullptr);
+
+    // stdin is /dev/null (or closed); stdout and stderr are read separately
+    virtual void start(const QString& program, const QStringList& arguments,
+                       const QString& workingDirectory, const QProcessEnvironment& environment) = 0;
+    virtual qint64 processId() const = 0;
+    virtual QByteArray readAllStandardOutput() = 0;
+    virtual QByteArray readAllStandardError() = 0;
+
+    // What the finished process and the children it waited for used, where
+    // the backend collects it at exit (spawn: wait4). Otherwise invalid,
+    // and the caller has to sample the running process itself.
+    virtual RunUsage usage() const { return RunUsage(); }
+
+signals:
+    void started();
+    void readyReadStandardOutput();
+    void readyReadStandardError();
+    void finished(int exitCode, bool crashed);
+    void failedToStart(const QString& error);
+
+protected:
+    explicit JobProcess(QObject *parent = nullptr) : QObject(parent) {}
+};
+
+#endif // JOBPROCESS_H
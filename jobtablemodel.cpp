@@ -0,0 +1,389 @@
+#include "jobtablemodel.h"
+#include "schedulerclock.h"
+#include <QColor>
+#include <QLocale>
+#include <QRegularExpression>
+#include <climits>
+#include <limits>
+
+JobTableModel::JobTableModel(QObject *parent)
+    : QAbstractTableModel(parent)
+    , m_enabledCount(0)
+    , m_indexed(false)
+{
+}
+
+int JobTableModel::rowCount(const QModelIndex& parent) const
+{
+    return parent.isValid() ? 0 : m_jobs.size();
+}
+
+int JobTableModel::columnCount(const QModelIndex& parent) const
+{
+    return parent.isValid() ? 0 : ColumnCount;
+}
+
+QVariant JobTableModel::headerData(int section, Qt::Orientation orientation, int role) const
+{
+    if (orientation != Qt::Horizontal || role != Qt::DisplayRole) {
+        return QVariant();
+    }
+    switch (section) {
+        case NameColumn: return "Name";
+        case GroupColumn: return "Group";
+        case ScriptColumn: return "Script";
+        case ScheduleColumn: return "Interval";
+        case LastRunColumn: return "Last Run";
+        case NextRunColumn: return "Next Run";
+        case StatusColumn: return "Status";
+        case FailuresColumn: return "Failures";
+        case CpuColumn: return "CPU";
+        case MemoryColumn: return "Peak Memory";
+        case IoColumn: return "Disk I/O";
+        default: return QVariant();
+    }
+}
+
+QVariant JobTableModel::data(const QModelIndex& index, int role) const
+{
+    if (!index.isValid() || index.row() >= m_jobs.size()) {
+        return QVariant();
+    }
+    const CronJob& job = m_jobs[index.row()];
+    const int column = index.column();
+    const QDateTime now = SchedulerClock::system()->now();
+
+    switch (role) {
+        case Qt::DisplayRole:
+            return displayData(job, column, now);
+        case SortRole:
+            return sortData(job, column, now);
+        case JobIdRole:
+            return job.id;
+        case Qt::ToolTipRole:
+            if (column == ScriptColumn) {
+                return job.scriptPath;
+            } else if (column == LastRunColumn && job.lastRun.isValid()) {
+                return job.lastRun.toString("dddd, MMMM d, yyyy 'at' h:mm:ss AP");
+            } else if (column == NextRunColumn && job.nextRun.isValid()) {
+                return job.nextRun.toString("dddd, MMMM d, yyyy 'at' h:mm:ss AP");
+            } else if (column == StatusColumn && job.enabled && job.isPaused(now)) {
+                return QString("Failed %1 time(s) in a row; next try at %2")
+                    .arg(job.consecutiveFailures).arg(formatDateTime(job.pausedUntil));
+            } else if (column == CpuColumn && job.lastCpuMs >= 0) {
+                return "User and system time of the last run, including its child processes";
+            } else if (column == IoColumn && job.lastReadBytes >= 0) {
+                return QString("Last run read %1 and wrote %2")
+                    .arg(formatBytes(job.lastReadBytes), formatBytes(job.lastWriteBytes));
+            }
+            return QVariant();
+        case Qt::TextAlignmentRole:
+            if (column == CpuColumn || column == MemoryColumn || column == IoColumn) {
+                return QVariant(Qt::AlignRight | Qt::AlignVCenter);
+            }
+            return QVariant();
+        case Qt::ForegroundRole:
+            if (column != StatusColumn) {
+                return QVariant();
+            }
+            if (!job.enabled) {
+                return QColor(Qt::gray);
+            }
+            return (job.isPaused(now) || job.retryAttempt > 0) ? QColor(200, 100, 0) : QColor(Qt::darkGreen);
+        default:
+            return QVariant();
+    }
+}
+
+QVariant JobTableModel::displayData(const CronJob& job, int column, const QDateTime& now) const
+{
+    switch (column) {
+        case NameColumn:
+            return job.name;
+        case GroupColumn:
+            return job.group;
+        case ScriptColumn:
+            return job.scriptPath;
+        case ScheduleColumn:
+            if (job.triggerType == CronJob::FileChangeTrigger) {
+                return QString("On change: %1").arg(job.watchPath);
+            } else if (job.intervalSeconds > 0) {
+                return QString("%1 second%2").arg(job.intervalSeconds).arg(job.intervalSeconds > 1 ? "s" : "");
+            }
+            return formatInterval(job.intervalMinutes);
+        case LastRunColumn:
+            return formatDateTime(job.lastRun);
+        case NextRunColumn:
+            return formatDateTime(job.nextRun);
+        case StatusColumn:
+            if (!job.enabled) {
+                return "Disabled";
+            } else if (job.isPaused(now)) {
+                return "Paused";
+            } else if (job.retryAttempt > 0) {
+                return QString("Retrying (%1/%2)").arg(job.retryAttempt).arg(job.maxRetries);
+            }
+            return "Enabled";
+        case FailuresColumn:
+            if (job.runCount == 0) {
+                return "-";
+            }
+            return QString("%1 of %2 (%3%)").arg(job.failureCount).arg(job.runCount)
+                .arg(qRound(100.0 * job.failureCount / job.runCount));
+        case CpuColumn:
+            return formatCpuTime(job.lastCpuMs);
+        case MemoryColumn:
+            return formatBytes(job.lastPeakRssBytes);
+        case IoColumn:
+            return job.lastReadBytes < 0 ? QString("-") : formatBytes(job.lastReadBytes + qMax<qint64>(0, job.lastWriteBytes));
+        default:
+            return QVariant();
+    }
+}
+
+QVariant JobTableModel::sortData(const CronJob& job, int column, const QDateTime& now) const
+{
+    switch (column) {
+        case NameColumn:
+            return job.name.toLower();
+        case GroupColumn:
+            return job.group.toLower();
+        case ScriptColumn:
+            return job.scriptPath.toLower();
+        case ScheduleColumn:
+            // File-change jobs after all interval jobs
+            return job.triggerType == CronJob::FileChangeTrigger ? INT_MAX : int(job.intervalMs() / 1000);
+        case LastRunColumn:
+            return job.lastRun.isValid() ? job.lastRun.toMSecsSinceEpoch() : qint64(-1);
+        case NextRunColumn:
+            // Jobs that never run by the clock go last
+            return job.nextRun.isValid() ? job.nextRun.toMSecsSinceEpoch() : std::numeric_limits<qint64>::max();
+        case StatusColumn:
+            if (!job.enabled) {
+                return 3;
+            } else if (job.isPaused(now)) {
+                return 2;
+            }
+            return job.retryAttempt > 0 ? 1 : 0;
+        case FailuresColumn:
+            return job.runCount > 0 ? double(job.failureCount) / job.runCount : -1.0;
+        case CpuColumn:
+            return job.lastCpuMs;
+        case MemoryColumn:
+            return job.lastPeakRssBytes;
+        case IoColumn:
+            return job.lastReadBytes < 0 ? qint64(-1) : job.lastReadBytes + qMax<qint64>(0, job.lastWriteBytes);
+        default:
+            return QVariant();
+    }
+}
+
+void JobTableModel::setJobs(const QVector<CronJob>& jobs)
+{
+    beginResetModel();
+    m_jobs = jobs;
+    m_rows.clear();
+    m_rows.reserve(m_jobs.size());
+    m_enabledCount = 0;
+    for (int row = 0; row < m_jobs.size(); ++row) {
+        m_rows.insert(m_jobs[row].id, row);
+        if (m_jobs[row].enabled) {
+            ++m_enabledCount;
+        }
+    }
+    if (m_indexed) {
+        m_tokenIndex.clear();
+        m_jobTokens.clear();
+        for (const CronJob& job : m_jobs) {
+            indexJob(job);
+        }
+    }
+    endResetModel();
+}
+
+void JobTableModel::upsertJob(const CronJob& job)
+{
+    if (m_indexed) {
+        unindexJob(job.id);
+        indexJob(job);
+        emit jobReindexed(job.id);
+    }
+
+    auto it = m_rows.constFind(job.id);
+    if (it == m_rows.constEnd()) {
+        int row = m_jobs.size();
+        beginInsertRows(QModelIndex(), row, row);
+        m_jobs.append(job);
+        m_rows.insert(job.id, row);
+        if (job.enabled) {
+            ++m_enabledCount;
+        }
+        endInsertRows();
+        return;
+    }
+
+    int row = it.value();
+    m_enabledCount += int(job.enabled) - int(m_jobs[row].enabled);
+    m_jobs[row] = job;
+    emit dataChanged(index(row, 0), index(row, ColumnCount - 1));
+}
+
+void JobTableModel::removeJob(const QString& jobId)
+{
+    int row = m_rows.value(jobId, -1);
+    if (row < 0) {
+        return;
+    }
+    if (m_indexed) {
+        unindexJob(jobId);
+    }
+
+    beginRemoveRows(QModelIndex(), row, row);
+    if (m_jobs[row].enabled) {
+        --m_enabledCount;
+    }
+    m_jobs.remove(row);
+    m_rows.remove(jobId);
+    for (int i = row; i < m_jobs.size(); ++i) {
+        m_rows[m_jobs[i].id] = i;
+    }
+    endRemoveRows();
+}
+
+const CronJob* JobTableModel::job(const QString& jobId) const
+{
+    int row = m_rows.value(jobId, -1);
+    return row >= 0 ? &m_jobs[row] : nullptr;
+}
+
+void JobTableModel::setSearchIndexEnabled(bool enabled)
+{
+    if (enabled == m_indexed) {
+        return;
+    }
+    m_indexed = enabled;
+    m_tokenIndex.clear();
+    m_jobTokens.clear();
+    if (enabled) {
+        m_jobTokens.reserve(m_jobs.size());
+        for (const CronJob& job : m_jobs) {
+            indexJob(job);
+        }
+    }
+}
+
+QStringList JobTableModel::tokenize(const QString& text)
+{
+    // Words of letters and digits, so "C:\Scripts\backup_db.py" yields
+    // "c", "scripts", "backup", "db" and "py"
+    static const QRegularExpression separators("[^\\w]+|_");
+    QStringList tokens = text.toLower().split(separators, Qt::SkipEmptyParts);
+    tokens.removeDuplicates();
+    return tokens;
+}
+
+void JobTableModel::indexJob(const CronJob& job)
+{
+    QStringList tokens = tokenize(job.name + ' ' + job.group + ' ' + job.scriptPath + ' ' + job.arguments);
+    for (const QString& token : tokens) {
+        m_tokenIndex[token].insert(job.id);
+    }
+    m_jobTokens.insert(job.id, tokens);
+}
+
+void JobTableModel::unindexJob(const QString& jobId)
+{
+    const QStringList tokens = m_jobTokens.take(jobId);
+    for (const QString& token : tokens) {
+        auto it = m_tokenIndex.find(token);
+        if (it != m_tokenIndex.end()) {
+            it->remove(jobId);
+            if (it->isEmpty()) {
+                m_tokenIndex.erase(it);
+            }
+        }
+    }
+}
+
+QSet<QString> JobTableModel::matchingJobs(const QStringList& terms) const
+{
+    // Each term must be the start of some token of the job. Tokens sharing a
+    // prefix are adjacent in the sorted index, so a term costs one lookup
+    // plus the matching entries.
+    QSet<QString> result;
+    bool first = true;
+    for (const QString& term : terms) {
+        QSet<QString> termMatches;
+        for (auto it = m_tokenIndex.lowerBound(term); it != m_tokenIndex.constEnd() && it.key().startsWith(term); ++it) {
+            termMatches.unite(it.value());
+        }
+        if (first) {
+            result = termMatches;
+            first = false;
+        } else {
+            result.intersect(termMatches);
+        }
+        if (result.isEmpty()) {
+            break;
+        }
+    }
+    return result;
+}
+
+bool JobTableModel::jobMatches(const QString& jobId, const QStringList& terms) const
+{
+    const QStringList tokens = m_jobTokens.value(jobId);
+    for (const QString& term : terms) {
+        bool found = false;
+        for (const QString& token : tokens) {
+            if (token.startsWith(term)) {
+                found = true;
+                break;
+            }
+        }
+        if (!found) {
+            return false;
+        }
+    }
+    return true;
+}
+
+QString JobTableModel::formatInterval(int minutes)
+{
+    if (minutes >= 1440) {
+        int days = minutes / 1440;
+        return QString("%1 day%2").arg(days).arg(days > 1 ? "s" : "");
+    } else if (minutes >= 60) {
+        int hours = minutes / 60;
+        return QString("%1 hour%2").arg(hours).arg(hours > 1 ? "s" : "");
+    } else {
+        return QString("%1 minute%2").arg(minutes).arg(minutes > 1 ? "s" : "");
+    }
+}
+
+QString JobTableModel::formatDateTime(const QDateTime& dt)
+{
+    if (!dt.isValid()) {
+        return "Never";
+    }
+    return dt.toString("yyyy-MM-dd hh:mm:ss");
+}
+
+QString JobTableModel::formatCpuTime(qint64 ms)
+{
+    if (ms < 0) {
+        return "-";
+    }
+    if (ms < 60000) {
+        return QString("%1 s").arg(ms / 1000.0, 0, 'f', ms < 10000 ? 2 : 1);
+    }
+    return QString("%1 min").arg(ms / 60000.0, 0, 'f', 1);
+}
+
+QString JobTableModel::formatBytes(qint64 bytes)
+{
+    if (bytes < 0) {
+        return "-";
+    }
+    return QLocale().formattedDataSize(bytes, 1);
+}
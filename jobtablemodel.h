@@ -0,0 +1,86 @@
+#ifndef JOBTABLEMODEL_H
+#define JOBTABLEMODEL_H
+
+#include <QAbstractTableModel>
+#include <QHash>
+#include <QMap>
+#include <QSet>
+#include <QStringList>
+#include <QVector>
+#include "cronjob.h"
+
+// The window's copy of the scheduler's jobs, shown in the job table.
+// Single-job changes are reported as single-row changes, so sorted and
+// filtered views only move the one row instead of starting over. Can also
+// keep a token index over name, group, script path and arguments for searching.
+class JobTableModel : public QAbstractTableModel
+{
+    Q_OBJECT
+
+public:
+    enum Column {
+        NameColumn,
+        GroupColumn,
+        ScriptColumn,
+        ScheduleColumn,
+        LastRunColumn,
+        NextRunColumn,
+        StatusColumn,
+        FailuresColumn,
+        CpuColumn,                  // Resources used by the last run
+        MemoryColumn,
+        IoColumn,
+        ColumnCount
+    };
+
+    enum Role {
+        JobIdRole = Qt::UserRole,
+        SortRole                    // Typed sort key: numbers and times, not display text
+    };
+
+    explicit JobTableModel(QObject *parent = nullptr);
+
+    int rowCount(const QModelIndex& parent = QModelIndex()) const override;
+    int columnCount(const QModelIndex& parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const override;
+    QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const override;
+
+    void setJobs(const QVector<CronJob>& jobs);
+    void upsertJob(const CronJob& job);
+    void removeJob(const QString& jobId);
+
+    const QVector<CronJob>& jobs() const { return m_jobs; }
+    const CronJob* job(const QString& jobId) const;
+    int enabledCount() const { return m_enabledCount; }
+
+    // Searching: the index is only built once a search box asks for it
+    void setSearchIndexEnabled(bool enabled);
+    QSet<QString> matchingJobs(const QStringList& terms) const;
+    bool jobMatches(const QString& jobId, const QStringList& terms) const;
+    static QStringList tokenize(const QString& text);
+
+    static QString formatInterval(int minutes);
+    static QString formatDateTime(const QDateTime& dt);
+    static QString formatCpuTime(qint64 ms);
+    static QString formatBytes(qint64 bytes);
+
+signals:
+    // Emitted before the row change is announced, so a filter can update first
+    void jobReindexed(const QString& jobId);
+
+private:
+    QVariant displayData(const CronJob& job, int column, const QDateTime& now) const;
+    QVariant sortData(const CronJob& job, int column, const QDateTime& now) const;
+    void indexJob(const CronJob& job);
+    void unindexJob(const QString& jobId);
+
+    QVector<CronJob> m_jobs;
+    QHash<QString, int> m_rows;                  // Job id -> row
+    int m_enabledCount;
+
+    bool m_indexed;
+    QMap<QString, QSet<QString>> m_tokenIndex;   // Token -> job ids, sorted for prefix lookups
+    QHash<QString, QStringList> m_jobTokens;     // Job id -> its tokens, to unindex on change
+};
+
+#endif // JOBTABLEMODEL_H
@@ -0,0 +1,175 @@
+#include "loopwatchdog.h"
+#include <QDateTime>
+#include <QJsonArray>
+#include <QMutexLocker>
+#include <QSettings>
+
+namespace {
+const int BUCKETS = 14;             // Up to 1, 2, 4 ... 4096 ms, then anything longer
+const int MAX_RECENT_STALLS = 20;
+const char* const UNNAMED_HANDLER = "unnamed handler";
+}
+
+QAtomicPointer<LoopWatchdog> LoopWatchdog::s_watching;
+
+LoopWatchdog::Scope::Scope(const char* handler)
+    : m_watchdog(s_watching.loadAcquire())
+    , m_previous(nullptr)
+{
+    if (m_watchdog && QThread::currentThread() == m_watchdog->m_watched) {
+        m_previous = m_watchdog->m_current.fetchAndStoreOrdered(handler);
+    } else {
+        m_watchdog = nullptr;
+    }
+}
+
+LoopWatchdog::Scope::~Scope()
+{
+    if (m_watchdog) {
+        m_watchdog->m_current.storeRelease(m_previous);
+    }
+}
+
+LoopWatchdog::LoopWatchdog(QObject *parent)
+    : QObject(parent)
+    , m_heartbeat(new QTimer(this))
+    , m_lastBeatMs(0)
+    , m_current(nullptr)
+    , m_captured(nullptr)
+    , m_capturedFor(-1)
+    , m_watched(nullptr)
+    , m_monitorThread(nullptr)
+    , m_stopping(false)
+    , m_histogram(BUCKETS, 0)
+    , m_beats(0)
+    , m_maxLatencyMs(0)
+    , m_stalls(0)
+{
+    QSettings settings;
+    settings.beginGroup("watchdog");
+    m_heartbeatMs = qMax(10, settings.value("heartbeatMs", 100).toInt());
+    m_stallMs = qMax<qint64>(m_heartbeatMs, settings.value("stallMs", 250).toLongLong());
+    settings.endGroup();
+
+    m_heartbeat->setTimerType(Qt::PreciseTimer);
+    m_heartbeat->setInterval(m_heartbeatMs);
+    connect(m_heartbeat, &QTimer::timeout, this, &LoopWatchdog::beat);
+}
+
+LoopWatchdog::~LoopWatchdog()
+{
+    stop();
+}
+
+void LoopWatchdog::start()
+{
+    if (m_monitorThread) {
+        return;
+    }
+    m_watched = QThread::currentThread();
+    s_watching.storeRelease(this);
+    m_clock.start();
+    m_lastBeatMs.storeRelease(0);
+    m_heartbeat->start();
+
+    m_stopping = false;
+    m_monitorThread = QThread::create([this] { monitor(); });
+    m_monitorThread->setObjectName("Loop watchdog");
+    m_monitorThread->start(QThread::HighPriority);
+}
+
+void LoopWatchdog::stop()
+{
+    if (!m_monitorThread) {
+        return;
+    }
+    m_heartbeat->stop();
+    s_watching.testAndSetOrdered(this, nullptr);
+    {
+        QMutexLocker locker(&m_mutex);
+        m_stopping = true;
+        m_wake.wakeAll();
+    }
+    m_monitorThread->wait();
+    delete m_monitorThread;
+    m_monitorThread = nullptr;
+}
+
+void LoopWatchdog::beat()
+{
+    const qint64 nowMs = m_clock.elapsed();
+    const qint64 lastBeatMs = m_lastBeatMs.fetchAndStoreOrdered(nowMs);
+    const qint64 latencyMs = qMax<qint64>(0, nowMs - lastBeatMs - m_heartbeatMs);
+    // A capture made just before this beat belongs to this delay only
+    const char* captured = m_capturedFor.loadAcquire() == lastBeatMs ? m_captured.loadAcquire() : nullptr;
+
+    int bucket = 0;
+    while (bucket < BUCKETS - 1 && (qint64(1) << bucket) < latencyMs) {
+        ++bucket;
+    }
+    ++m_histogram[bucket];
+    ++m_beats;
+    m_maxLatencyMs = qMax(m_maxLatencyMs, latencyMs);
+
+    if (latencyMs < m_stallMs) {
+        return;
+    }
+    ++m_stalls;
+    Stall stall;
+    stall.atMs = QDateTime::currentMSecsSinceEpoch() - latencyMs;
+    stall.durationMs = latencyMs;
+    stall.handler = QString::fromLatin1(captured ? captured : UNNAMED_HANDLER);
+    m_recent.append(stall);
+    if (m_recent.size() > MAX_RECENT_STALLS) {
+        m_recent.removeFirst();
+    }
+    emit stalled(stall);
+}
+
+void LoopWatchdog::monitor()
+{
+    // Looks once per heartbeat, so anything running for half the stall
+    // threshold past a missed beat is seen at least once
+    QMutexLocker locker(&m_mutex);
+    while (!m_stopping) {
+        m_wake.wait(&m_mutex, m_heartbeatMs);
+        const qint64 lastBeatMs = m_lastBeatMs.loadAcquire();
+        if (m_clock.elapsed() - lastBeatMs - m_heartbeatMs >= m_stallMs / 2) {
+            const char* handler = m_current.loadAcquire();
+            m_captured.storeRelease(handler ? handler : UNNAMED_HANDLER);
+            m_capturedFor.storeRelease(lastBeatMs);
+        }
+    }
+}
+
+QJsonObject LoopWatchdog::toJson() const
+{
+    // counts[i] is beats up to bounds[i] ms late; the last count has no bound
+    QJsonArray bounds;
+    QJsonArray counts;
+    for (int i = 0; i < BUCKETS; ++i) {
+        if (i < BUCKETS - 1) {
+            bounds.append(qint64(1) << i);
+        }
+        counts.append(m_histogram[i]);
+    }
+    QJsonArray recent;
+    for (const Stall& stall : m_recent) {
+        QJsonObject obj;
+        obj["at"] = QDateTime::fromMSecsSinceEpoch(stall.atMs).toString(Qt::ISODateWithMs);
+        obj["durationMs"] = stall.durationMs;
+        obj["handler"] = stall.handler;
+        recent.append(obj);
+    }
+
+    QJsonObject obj;
+    obj["heartbeatMs"] = m_heartbeatMs;
+    obj["stallMs"] = m_stallMs;
+    obj["beats"] = m_beats;
+    obj["maxLatencyMs"] = m_maxLatencyMs;
+    obj["stalls"] = m_stalls;
+    obj["histogramBoundsMs"] = bounds;
+    obj["histogram"] = counts;
+    obj["recentStalls"] = recent;
+    return obj;
+}
@@ -0,0 +1,88 @@
+#ifndef LOOPWATCHDOG_H
+#define LOOPWATCHDOG_H
+
+#include <QObject>
+#include <QAtomicInteger>
+#include <QAtomicPointer>
+#include <QElapsedTimer>
+#include <QJsonObject>
+#include <QMutex>
+#include <QThread>
+#include <QTimer>
+#include <QVector>
+#include <QWaitCondition>
+
+// Measures how late the event loop of the thread that calls start() gets
+// to its events. A heartbeat timer fires every few tens of milliseconds and
+// records how much later than asked it ran; every beat goes into a
+// histogram with power-of-two millisecond buckets. A beat later than the
+// stall threshold counts as a stall. What blocked the loop can't be seen
+// from the loop itself once it is free again, so a small monitor thread
+// watches the heartbeat and, while it is overdue, notes which handler is
+// running. Handlers name themselves with a Scope on the stack; only scopes
+// on the watched thread count, so the same code may run anywhere.
+class LoopWatchdog : public QObject
+{
+    Q_OBJECT
+
+public:
+    class Scope
+    {
+    public:
+        explicit Scope(const char* handler);   // Must be a string literal
+        ~Scope();
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+
+    private:
+        LoopWatchdog* m_watchdog;
+        const char* m_previous;
+    };
+
+    struct Stall {
+        qint64 atMs = 0;          // When it began (epoch ms)
+        qint64 durationMs = 0;
+        QString handler;
+    };
+
+    explicit LoopWatchdog(QObject *parent = nullptr);
+    ~LoopWatchdog();
+
+    void start();   // Watch the calling thread's event loop
+    void stop();
+
+    qint64 stallMs() const { return m_stallMs; }
+    QJsonObject toJson() const;
+
+signals:
+    void stalled(const LoopWatchdog::Stall& stall);
+
+private slots:
+    void beat();
+
+private:
+    void monitor();   // Body of the monitor thread
+
+    static QAtomicPointer<LoopWatchdog> s_watching;
+
+    int m_heartbeatMs;
+    qint64 m_stallMs;
+    QTimer* m_heartbeat;
+    QElapsedTimer m_clock;
+    QAtomicInteger<qint64> m_lastBeatMs;     // m_clock time of the last beat
+    QAtomicPointer<const char> m_current;    // Innermost Scope on the watched thread
+    QAtomicPointer<const char> m_captured;   // Seen by the monitor while a beat was overdue
+    QAtomicInteger<qint64> m_capturedFor;    // ... and the last beat before that delay
+    QThread* m_watched;
+    QThread* m_monitorThread;
+    QMutex m_mutex;
+    QWaitCondition m_wake;
+    bool m_stopping;                         // Guarded by m_mutex
+    QVector<qint64> m_histogram;             // Beats per latency bucket
+    qint64 m_beats;
+    qint64 m_maxLatencyMs;
+    qint64 m_stalls;
+    QVector<Stall> m_recent;                 // The last few stalls, oldest first
+};
+
+#endif // LOOPWATCHDOG_H
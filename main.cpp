@@ -1,16 +1,26 @@
 #include "mainwindow.h"
+#include "controlserver.h"
+#include "controlprotocol.h"
+#include "clustercoordinator.h"
 
 #include <QApplication>
 #include <QSharedMemory>
 #include <QMessageBox>
 #include <QSystemTrayIcon>
-#include <QLocalServer>
 #include <QLocalSocket>
+#include <QThread>
+#include <QElapsedTimer>
 
-const QString SERVER_NAME = "CronGUI_LocalServer";
+static QString argumentValue(const QStringList& args, const QString& name)
+{
+    int index = args.indexOf(name);
+    return (index >= 0 && index + 1 < args.size()) ? args.at(index + 1) : QString();
+}
 
 int main(int argc, char *argv[])
 {
+    QElapsedTimer launchTimer;
+    launchTimer.start();
     QApplication a(argc, argv);
     
     // Set application metadata
@@ -26,16 +36,32 @@ int main(int argc, char *argv[])
         return 1;
     }
     
+    QStringList args = QCoreApplication::arguments();
+    
+    // Clustered mode: several instances share a config directory (possibly on
+    // NFS) and split the jobs between them. Each node is its own single instance.
+    QString clusterDir = argumentValue(args, "--cluster-dir");
+    QString nodeId;
+    if (!clusterDir.isEmpty()) {
+        nodeId = argumentValue(args, "--node-id");
+        if (nodeId.isEmpty()) {
+            nodeId = ClusterCoordinator::defaultNodeId();
+        }
+        nodeId = sanitizeNodeId(nodeId);
+    }
+    const QString serverName = controlServerName(nodeId);
+    
     // Single instance check using shared memory
-    QSharedMemory sharedMem("CronGUI_SingleInstance_Lock");
+    QSharedMemory sharedMem(nodeId.isEmpty() ? QString("CronGUI_SingleInstance_Lock")
+                                             : QString("CronGUI_SingleInstance_Lock_%1").arg(nodeId));
     
     if (!sharedMem.create(1)) {
         // Another instance is already running - try to activate it
         QLocalSocket socket;
-        socket.connectToServer(SERVER_NAME);
+        socket.connectToServer(serverName);
         if (socket.waitForConnected(1000)) {
             // Send "show" command to existing instance
-            socket.write("show");
+            socket.write(CONTROL_CMD_SHOW + "\n");
             socket.waitForBytesWritten(1000);
             socket.disconnectFromServer();
         }
@@ -45,7 +71,6 @@ int main(int argc, char *argv[])
     
     // Check for --hidden argument (used when starting with Windows)
     bool startHidden = false;
-    QStringList args = QCoreApplication::arguments();
     if (args.contains("--hidden") || args.contains("-h")) {
         startHidden = true;
     }
@@ -53,29 +78,42 @@ int main(int argc, char *argv[])
     // Don't quit when last window closes (we want to stay in tray)
     QApplication::setQuitOnLastWindowClosed(false);
     
-    MainWindow w(startHidden);
+    // The scheduler and the control server run on their own thread so that a
+    // busy or blocked GUI never delays a job or a cron-gui-ctl request
+    QThread schedulerThread;
+    schedulerThread.setObjectName("Scheduler");
+    
+    CronManager* cronManager = new CronManager(clusterDir, nodeId);
+    cronManager->setLaunchTimer(launchTimer);
+    ControlServer* server = new ControlServer(cronManager);
+    MainWindow w(cronManager, startHidden);
+    
+    cronManager->moveToThread(&schedulerThread);
+    server->moveToThread(&schedulerThread);
+    QObject::connect(&schedulerThread, &QThread::finished, server, &QObject::deleteLater);
+    QObject::connect(&schedulerThread, &QThread::finished, cronManager, &QObject::deleteLater);
+    
+    // Set up local server for activation requests from other instances and cron-gui-ctl
+    QObject::connect(server, &ControlServer::showRequested, &w, &MainWindow::showWindow);
+    QObject::connect(server, &ControlServer::stallGuiRequested, &w, &MainWindow::stallGui);
     
-    // Set up local server to listen for activation requests from other instances
-    QLocalServer::removeServer(SERVER_NAME);  // Clean up any stale server
-    QLocalServer server;
-    if (server.listen(SERVER_NAME)) {
-        QObject::connect(&server, &QLocalServer::newConnection, [&w, &server]() {
-            QLocalSocket* socket = server.nextPendingConnection();
-            if (socket) {
-                socket->waitForReadyRead(1000);
-                QByteArray data = socket->readAll();
-                if (data == "show") {
-                    w.showWindow();
-                }
-                socket->disconnectFromServer();
-                socket->deleteLater();
-            }
-        });
+    schedulerThread.start();
+    QMetaObject::invokeMethod(server, [server, serverName]() { server->listen(serverName); }, Qt::QueuedConnection);
+    const QString traceFile = argumentValue(args, "--trace");
+    if (!traceFile.isEmpty()) {
+        // Before start(), so the first runs are in the trace
+        QMetaObject::invokeMethod(cronManager, [cronManager, traceFile]() {
+            cronManager->setTraceFile(traceFile);
+        }, Qt::QueuedConnection);
     }
+    QMetaObject::invokeMethod(cronManager, &CronManager::start, Qt::QueuedConnection);
     
     if (!startHidden) {
         w.show();
     }
     
-    return a.exec();
+    int result = a.exec();
+    schedulerThread.quit();
+    schedulerThread.wait();
+    return result;
 }
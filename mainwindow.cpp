@@ -1,20 +1,45 @@
 #include "mainwindow.h"
 #include "./ui_mainwindow.h"
 #include "jobeditdialog.h"
+#include "cronimporter.h"
+#include "traynotifier.h"
+#include "jobtablemodel.h"
+#include "jobfiltermodel.h"
+#include "forecastdialog.h"
+#include "outputtail.h"
 #include <QVBoxLayout>
 #include <QHBoxLayout>
 #include <QSplitter>
-#include <QGroupBox>
 #include <QHeaderView>
 #include <QMessageBox>
 #include <QApplication>
 #include <QStyle>
 #include <QScrollBar>
+#include <QTextDocument>
+#include <QFileDialog>
+#include <QElapsedTimer>
+#include <QThread>
+#include <QSettings>
+#include <QActionGroup>
+#include <QDialogButtonBox>
+#include <QFormLayout>
+#include <QSpinBox>
+#include <QtConcurrent>
 
-MainWindow::MainWindow(bool startHidden, QWidget *parent)
+namespace {
+const int MAX_OUTPUT_TABS = 8;   // Beyond this the oldest finished tab makes room
+const int LOG_OUTPUT_CHARS = 4000;   // A run's output copied into the log; the rest is in the output index
+const int LOG_MAX_LINES = 10000;     // The log drops its oldest lines beyond this
+}
+
+MainWindow::MainWindow(CronManager* cronManager, bool startHidden, QWidget *parent)
     : QMainWindow(parent)
     , ui(new Ui::MainWindow)
-    , m_cronManager(new CronManager(this))
+    , m_cronManager(cronManager)
+    , m_jobModel(new JobTableModel(this))
+    , m_filterModel(nullptr)
+    , m_loggedStartup(false)
+    , m_uiBuilt(false)
     , m_startHidden(startHidden)
 {
     ui->setupUi(this);
@@ -22,34 +47,34 @@ MainWindow::MainWindow(bool startHidden, QWidget *parent)
     setWindowTitle("Cron Job Manager");
     setMinimumSize(900, 600);
     
-    setupUI();
+    // With --hidden the window may never be opened, so only the tray is set
+    // up now; the table and log are built on the first showWindow()
     setupSystemTray();
+    if (!m_startHidden) {
+        ensureUi();
+    }
     
-    // Connect signals
+    // Connect signals; the manager is started on its own thread by main()
+    connect(&m_importWatcher, &QFutureWatcher<ImportResult>::finished, this, &MainWindow::onImportParsed);
     connect(m_cronManager, &CronManager::jobExecuted, this, &MainWindow::onJobExecuted);
+    connect(m_cronManager, &CronManager::jobOutput, this, &MainWindow::onJobOutput);
     connect(m_cronManager, &CronManager::jobsChanged, this, &MainWindow::onJobsChanged);
+    connect(m_cronManager, &CronManager::groupsChanged, this, &MainWindow::onGroupsChanged);
+    connect(m_cronManager, &CronManager::jobAdded, this, &MainWindow::onJobAdded);
+    connect(m_cronManager, &CronManager::jobUpdated, this, &MainWindow::onJobUpdated);
+    connect(m_cronManager, &CronManager::jobRemoved, this, &MainWindow::onJobRemoved);
+    connect(m_cronManager, &CronManager::statsChanged, this, &MainWindow::onStatsChanged);
     connect(m_cronManager, &CronManager::logMessage, this, &MainWindow::onLogMessage);
+    connect(m_cronManager, &CronManager::deadlineAlert, this, [this](const QString&, const QString& message) {
+        m_notifier->showMessage("Cron Job Manager", message, QSystemTrayIcon::Warning, 5000);
+    });
     
-    // Initial refresh
-    refreshJobTable();
-    updateStatusBar();
-    
-    // Start the scheduler
-    m_cronManager->start();
-    
-    // Log startup info
     onLogMessage("Application started");
-    onLogMessage(QString("Loaded %1 job(s)").arg(m_cronManager->getJobs().size()));
-    for (const CronJob& job : m_cronManager->getJobs()) {
-        if (job.enabled) {
-            onLogMessage(QString("  - %1: next run at %2").arg(job.name, job.nextRun.toString("yyyy-MM-dd hh:mm:ss")));
-        }
-    }
     
     // Handle hidden start
     if (m_startHidden) {
         hide();
-        m_trayIcon->showMessage("Cron Job Manager", 
+        m_notifier->showMessage("Cron Job Manager", 
             "Application is running in the background.", 
             QSystemTrayIcon::Information, 3000);
     }
@@ -60,6 +85,25 @@ MainWindow::~MainWindow()
     delete ui;
 }
 
+void MainWindow::ensureUi()
+{
+    if (m_uiBuilt) {
+        return;
+    }
+    
+    QElapsedTimer timer;
+    timer.start();
+    setupUI();
+    m_uiBuilt = true;
+    updateStatusBar();
+    
+    if (!m_pendingLog.isEmpty()) {
+        m_logView->setPlainText(m_pendingLog.join("\n"));
+        m_pendingLog.clear();
+    }
+    onLogMessage(QString("Window built in %1 ms").arg(timer.elapsed()));
+}
+
 void MainWindow::setupUI()
 {
     QWidget* centralWidget = new QWidget(this);
@@ -72,16 +116,22 @@ void MainWindow::setupUI()
     m_editButton = new QPushButton("Edit", this);
     m_removeButton = new QPushButton("Remove", this);
     m_runNowButton = new QPushButton("Run Now", this);
+    m_importButton = new QPushButton("Import...", this);
+    m_forecastButton = new QPushButton("Forecast...", this);
     
     m_addButton->setIcon(QIcon::fromTheme("list-add"));
     m_editButton->setIcon(QIcon::fromTheme("document-edit"));
     m_removeButton->setIcon(QIcon::fromTheme("list-remove"));
     m_runNowButton->setIcon(QIcon::fromTheme("media-playback-start"));
+    m_importButton->setIcon(QIcon::fromTheme("document-import"));
+    m_forecastButton->setIcon(QIcon::fromTheme("x-office-calendar"));
     
     toolbarLayout->addWidget(m_addButton);
     toolbarLayout->addWidget(m_editButton);
     toolbarLayout->addWidget(m_removeButton);
     toolbarLayout->addWidget(m_runNowButton);
+    toolbarLayout->addWidget(m_importButton);
+    toolbarLayout->addWidget(m_forecastButton);
     toolbarLayout->addStretch();
     
     m_autoStartCheck = new QCheckBox("Start with Windows", this);
@@ -97,23 +147,56 @@ void MainWindow::setupUI()
     QGroupBox* jobsGroup = new QGroupBox("Scheduled Jobs", this);
     QVBoxLayout* jobsLayout = new QVBoxLayout(jobsGroup);
     
-    m_jobTable = new QTableWidget(this);
-    m_jobTable->setColumnCount(6);
-    m_jobTable->setHorizontalHeaderLabels({"Name", "Script", "Interval", "Last Run", "Next Run", "Status"});
-    m_jobTable->horizontalHeader()->setSectionResizeMode(0, QHeaderView::Stretch);
-    m_jobTable->horizontalHeader()->setSectionResizeMode(1, QHeaderView::Stretch);
-    m_jobTable->horizontalHeader()->setSectionResizeMode(2, QHeaderView::ResizeToContents);
-    m_jobTable->horizontalHeader()->setSectionResizeMode(3, QHeaderView::ResizeToContents);  // Last Run
-    m_jobTable->horizontalHeader()->setSectionResizeMode(4, QHeaderView::ResizeToContents);  // Next Run
-    m_jobTable->horizontalHeader()->setSectionResizeMode(5, QHeaderView::ResizeToContents);
+    // Filter bar
+    QHBoxLayout* filterLayout = new QHBoxLayout();
+    m_filterEdit = new QLineEdit(this);
+    m_filterEdit->setPlaceholderText("Filter by name, group, script or arguments");
+    m_filterEdit->setClearButtonEnabled(true);
+    m_filterLabel = new QLabel(this);
+    m_filterLabel->setStyleSheet("color: gray;");
+    filterLayout->addWidget(m_filterEdit);
+    filterLayout->addWidget(m_filterLabel);
+    jobsLayout->addLayout(filterLayout);
+    
+    m_filterModel = new JobFilterModel(m_jobModel, this);
+    
+    m_jobTable = new QTableView(this);
+    m_jobTable->setModel(m_filterModel);
+    m_jobTable->horizontalHeader()->setSectionResizeMode(JobTableModel::NameColumn, QHeaderView::Stretch);
+    m_jobTable->horizontalHeader()->setSectionResizeMode(JobTableModel::GroupColumn, QHeaderView::ResizeToContents);
+    m_jobTable->horizontalHeader()->setSectionResizeMode(JobTableModel::ScriptColumn, QHeaderView::Stretch);
+    m_jobTable->horizontalHeader()->setSectionResizeMode(JobTableModel::ScheduleColumn, QHeaderView::ResizeToContents);
+    m_jobTable->horizontalHeader()->setSectionResizeMode(JobTableModel::LastRunColumn, QHeaderView::ResizeToContents);
+    m_jobTable->horizontalHeader()->setSectionResizeMode(JobTableModel::NextRunColumn, QHeaderView::ResizeToContents);
+    m_jobTable->horizontalHeader()->setSectionResizeMode(JobTableModel::StatusColumn, QHeaderView::ResizeToContents);
+    m_jobTable->horizontalHeader()->setSectionResizeMode(JobTableModel::FailuresColumn, QHeaderView::ResizeToContents);
+    m_jobTable->horizontalHeader()->setSectionResizeMode(JobTableModel::CpuColumn, QHeaderView::ResizeToContents);
+    m_jobTable->horizontalHeader()->setSectionResizeMode(JobTableModel::MemoryColumn, QHeaderView::ResizeToContents);
+    m_jobTable->horizontalHeader()->setSectionResizeMode(JobTableModel::IoColumn, QHeaderView::ResizeToContents);
+    m_jobTable->verticalHeader()->setVisible(false);
     m_jobTable->setSelectionBehavior(QAbstractItemView::SelectRows);
-    m_jobTable->setSelectionMode(QAbstractItemView::SingleSelection);
+    m_jobTable->setSelectionMode(QAbstractItemView::ExtendedSelection);
+    m_jobTable->setContextMenuPolicy(Qt::CustomContextMenu);
     m_jobTable->setEditTriggers(QAbstractItemView::NoEditTriggers);
     m_jobTable->setAlternatingRowColors(true);
     
+    // Click a header to sort; start in the order the jobs were added
+    m_jobTable->horizontalHeader()->setSortIndicator(-1, Qt::AscendingOrder);
+    m_jobTable->setSortingEnabled(true);
+    
     jobsLayout->addWidget(m_jobTable);
     splitter->addWidget(jobsGroup);
     
+    // Live output of running jobs, one tab per job; shown once there is some
+    m_outputGroup = new QGroupBox("Live Output", this);
+    QVBoxLayout* outputLayout = new QVBoxLayout(m_outputGroup);
+    m_outputTabs = new QTabWidget(this);
+    m_outputTabs->setTabsClosable(true);
+    m_outputTabs->setDocumentMode(true);
+    outputLayout->addWidget(m_outputTabs);
+    m_outputGroup->hide();
+    splitter->addWidget(m_outputGroup);
+    
     // Log view
     QGroupBox* logGroup = new QGroupBox("Activity Log", this);
     QVBoxLayout* logLayout = new QVBoxLayout(logGroup);
@@ -122,6 +205,7 @@ void MainWindow::setupUI()
     m_logView->setReadOnly(true);
     m_logView->setMinimumHeight(200);
     m_logView->setAcceptRichText(false);  // Use plain text for reliability
+    m_logView->document()->setMaximumBlockCount(LOG_MAX_LINES);
     m_logView->setStyleSheet("QTextEdit { font-family: Consolas, monospace; font-size: 10pt; background-color: #f5f5f5; color: #000000; }");
     
     logLayout->addWidget(m_logView);
@@ -140,8 +224,13 @@ void MainWindow::setupUI()
     connect(m_editButton, &QPushButton::clicked, this, &MainWindow::editJob);
     connect(m_removeButton, &QPushButton::clicked, this, &MainWindow::removeJob);
     connect(m_runNowButton, &QPushButton::clicked, this, &MainWindow::runJobNow);
+    connect(m_importButton, &QPushButton::clicked, this, &MainWindow::importJobs);
+    connect(m_forecastButton, &QPushButton::clicked, this, &MainWindow::showForecast);
     connect(m_autoStartCheck, &QCheckBox::toggled, this, &MainWindow::toggleAutoStart);
-    connect(m_jobTable, &QTableWidget::doubleClicked, this, &MainWindow::editJob);
+    connect(m_jobTable, &QTableView::doubleClicked, this, &MainWindow::editJob);
+    connect(m_jobTable, &QTableView::customContextMenuRequested, this, &MainWindow::showJobMenu);
+    connect(m_filterEdit, &QLineEdit::textChanged, this, &MainWindow::onFilterChanged);
+    connect(m_outputTabs, &QTabWidget::tabCloseRequested, this, &MainWindow::closeOutputTab);
 }
 
 void MainWindow::setupSystemTray()
@@ -172,8 +261,35 @@ void MainWindow::setupSystemTray()
         addJob();
     });
     
+    m_notifier = new TrayNotifier(m_trayIcon, this);
+    QSettings settings;
+    m_notifier->setSummaryInterval(settings.value("notifications/summarySeconds", 10).toInt());
+    
+    // How often finished jobs are reported
+    QMenu* notifyMenu = new QMenu("Job Notifications", this);
+    QActionGroup* notifyGroup = new QActionGroup(this);
+    const QList<QPair<QString, int>> choices = {
+        {"For every job", 0},
+        {"Summary every 10 seconds", 10},
+        {"Summary every minute", 60},
+        {"Summary every 5 minutes", 300},
+        {"Only for jobs set to alert", -1}
+    };
+    for (const auto& choice : choices) {
+        QAction* action = notifyMenu->addAction(choice.first);
+        action->setCheckable(true);
+        action->setChecked(choice.second == m_notifier->summaryInterval());
+        notifyGroup->addAction(action);
+        const int seconds = choice.second;
+        connect(action, &QAction::triggered, this, [this, seconds]() {
+            m_notifier->setSummaryInterval(seconds);
+            QSettings().setValue("notifications/summarySeconds", seconds);
+        });
+    }
+    
     m_trayMenu->addAction(m_showAction);
     m_trayMenu->addAction(addAction);
+    m_trayMenu->addMenu(notifyMenu);
     m_trayMenu->addSeparator();
     
     // Note: No quit action - only killable via Task Manager
@@ -199,7 +315,7 @@ void MainWindow::closeEvent(QCloseEvent *event)
 {
     // Minimize to tray instead of closing
     hide();
-    m_trayIcon->showMessage("Cron Job Manager", 
+    m_notifier->showMessage("Cron Job Manager", 
         "Application minimized to tray. Jobs will continue running.", 
         QSystemTrayIcon::Information, 2000);
     event->ignore();
@@ -217,85 +333,251 @@ void MainWindow::trayIconActivated(QSystemTrayIcon::ActivationReason reason)
 
 void MainWindow::showWindow()
 {
+    ensureUi();
     show();
     raise();
     activateWindow();
 }
 
+void MainWindow::stallGui(int milliseconds)
+{
+    onLogMessage(QString("Blocking the GUI thread for %1 ms").arg(milliseconds));
+    QThread::msleep(qBound(0, milliseconds, 60000));
+}
+
 void MainWindow::addJob()
 {
     JobEditDialog dialog(this);
     if (dialog.exec() == QDialog::Accepted) {
         CronJob job = dialog.getJob();
-        m_cronManager->addJob(job);
+        runInScheduler([manager = m_cronManager, job]() { manager->addJob(job); });
     }
 }
 
 void MainWindow::editJob()
 {
-    int row = m_jobTable->currentRow();
-    if (row < 0) {
+    const CronJob* job = findJob(selectedJobId());
+    if (!job) {
         QMessageBox::information(this, "Edit Job", "Please select a job to edit.");
         return;
     }
     
-    QString jobId = m_jobTable->item(row, 0)->data(Qt::UserRole).toString();
-    CronJob* job = m_cronManager->getJob(jobId);
-    
-    if (job) {
-        JobEditDialog dialog(*job, this);
-        if (dialog.exec() == QDialog::Accepted) {
-            CronJob updatedJob = dialog.getJob();
-            m_cronManager->updateJob(updatedJob);
-        }
+    JobEditDialog dialog(*job, this);
+    if (dialog.exec() == QDialog::Accepted) {
+        CronJob updatedJob = dialog.getJob();
+        runInScheduler([manager = m_cronManager, updatedJob]() { manager->updateJob(updatedJob); });
     }
 }
 
 void MainWindow::removeJob()
 {
-    int row = m_jobTable->currentRow();
-    if (row < 0) {
+    const QStringList ids = selectedJobIds();
+    if (ids.size() > 1) {
+        removeJobs(ids, QString("Are you sure you want to remove the %1 selected jobs?").arg(ids.size()));
+        return;
+    }
+    
+    const CronJob* job = findJob(selectedJobId());
+    if (!job) {
         QMessageBox::information(this, "Remove Job", "Please select a job to remove.");
         return;
     }
     
-    QString jobName = m_jobTable->item(row, 0)->text();
-    QString jobId = m_jobTable->item(row, 0)->data(Qt::UserRole).toString();
+    QString jobName = job->name;
+    QString jobId = job->id;
     
     QMessageBox::StandardButton reply = QMessageBox::question(this, "Remove Job",
         QString("Are you sure you want to remove '%1'?").arg(jobName),
         QMessageBox::Yes | QMessageBox::No);
     
     if (reply == QMessageBox::Yes) {
-        m_cronManager->removeJob(jobId);
+        runInScheduler([manager = m_cronManager, jobId]() { manager->removeJob(jobId); });
     }
 }
 
 void MainWindow::runJobNow()
 {
-    int row = m_jobTable->currentRow();
-    if (row < 0) {
-        QMessageBox::information(this, "Run Job", "Please select a job to run.");
+    const QStringList ids = selectedJobIds();
+    if (ids.size() > 1) {
+        runJobs(ids);
         return;
     }
     
-    QString jobId = m_jobTable->item(row, 0)->data(Qt::UserRole).toString();
+    QString jobId = selectedJobId();
+    if (jobId.isEmpty()) {
+        QMessageBox::information(this, "Run Job", "Please select a job to run.");
+        return;
+    }
     
     // Run the job immediately
-    m_cronManager->runJobNow(jobId);
+    runInScheduler([manager = m_cronManager, jobId]() { manager->runJobNow(jobId); });
 }
 
 void MainWindow::toggleJobEnabled()
 {
-    int row = m_jobTable->currentRow();
-    if (row < 0) return;
+    const CronJob* current = findJob(selectedJobId());
+    
+    if (current) {
+        CronJob job = *current;
+        job.enabled = !job.enabled;
+        runInScheduler([manager = m_cronManager, job]() { manager->updateJob(job); });
+    }
+}
+
+void MainWindow::importJobs()
+{
+    if (m_importWatcher.isRunning()) {
+        return;
+    }
+    QString fileName = QFileDialog::getOpenFileName(this, "Import Jobs", "",
+        "Job Files (*.json *.jsonl *.ndjson *.cron *.crontab *.txt);;All Files (*.*)");
+    if (fileName.isEmpty()) {
+        return;
+    }
+
+    // Parsed on a worker thread, so a large file never freezes the window
+    m_importButton->setEnabled(false);
+    onLogMessage(QString("Importing %1...").arg(fileName));
+    m_importWatcher.setFuture(QtConcurrent::run([fileName]() {
+        const int maxShownErrors = 20;
+        ImportResult result;
+        result.fileName = fileName;
+        CronImporter importer;
+        QElapsedTimer timer;
+        timer.start();
+        result.ok = importer.importFile(fileName,
+            [&result](const CronJob& job) { result.jobs.append(job); },
+            [&result](qint64 line, const QString& message) {
+                if (result.errors.size() < maxShownErrors) {
+                    result.errors.append(QString("Line %1: %2").arg(line).arg(message));
+                }
+            });
+        result.parseMs = timer.elapsed();
+        result.errorString = importer.errorString();
+        result.linesRead = importer.linesRead();
+        result.jobCount = importer.jobCount();
+        result.errorCount = importer.errorCount();
+        return result;
+    }));
+}
+
+void MainWindow::onImportParsed()
+{
+    m_importButton->setEnabled(true);
+    const ImportResult result = m_importWatcher.result();
+
+    // Hand everything over as one batch: one save, one table refresh
+    runInScheduler([manager = m_cronManager, jobs = result.jobs]() { manager->importJobs(jobs); });
+
+    onLogMessage(QString("Read %1 line(s) from %2 in %3 ms (%4 job(s), %5 error(s))")
+        .arg(result.linesRead).arg(result.fileName).arg(result.parseMs)
+        .arg(result.jobCount).arg(result.errorCount));
+    for (const QString& error : result.errors) {
+        onLogMessage("  " + error);
+    }
+
+    if (!result.ok || result.errorCount > 0) {
+        QString message = result.ok ? QString("%1 job(s) imported, %2 line(s) could not be imported.")
+                                          .arg(result.jobCount).arg(result.errorCount)
+                                    : result.errorString;
+        if (!result.errors.isEmpty()) {
+            message += "\n\n" + result.errors.join("\n");
+        }
+        QMessageBox::warning(this, "Import Jobs", message);
+    }
+}
+
+void MainWindow::showForecast()
+{
+    // Works on the GUI-side copy, so the scheduler is never held up
+    ForecastDialog dialog(m_jobModel->jobs(), !m_stats.clusterNode.isEmpty(), this);
+    dialog.exec();
+}
+
+void MainWindow::showJobMenu(const QPoint& pos)
+{
+    const QStringList ids = selectedJobIds();
+    if (ids.isEmpty()) {
+        return;
+    }
+    
+    QMenu menu(this);
+    const QString suffix = ids.size() > 1 ? QString(" (%1 Jobs)").arg(ids.size()) : QString();
+    connect(menu.addAction("Run Now" + suffix), &QAction::triggered, this, &MainWindow::runJobNow);
+    connect(menu.addAction("Enable" + suffix), &QAction::triggered, this, [this, ids]() { setJobsEnabled(ids, true); });
+    connect(menu.addAction("Disable" + suffix), &QAction::triggered, this, [this, ids]() { setJobsEnabled(ids, false); });
+    connect(menu.addAction("Remove" + suffix + "..."), &QAction::triggered, this, &MainWindow::removeJob);
+    
+    // The whole group, whether or not all of it is selected or shown
+    const CronJob* current = findJob(selectedJobId());
+    if (current && !current->group.isEmpty()) {
+        const QString group = current->group;
+        const QStringList members = groupJobIds(group);
+        QMenu* groupMenu = menu.addMenu(QString("Group \"%1\" (%2 Jobs)").arg(group).arg(members.size()));
+        connect(groupMenu->addAction("Run All"), &QAction::triggered, this, [this, members]() { runJobs(members); });
+        connect(groupMenu->addAction("Enable All"), &QAction::triggered, this, [this, members]() { setJobsEnabled(members, true); });
+        connect(groupMenu->addAction("Disable All"), &QAction::triggered, this, [this, members]() { setJobsEnabled(members, false); });
+        connect(groupMenu->addAction("Remove All..."), &QAction::triggered, this, [this, group, members]() {
+            removeJobs(members, QString("Are you sure you want to remove all %1 jobs in group '%2'?").arg(members.size()).arg(group));
+        });
+        groupMenu->addSeparator();
+        connect(groupMenu->addAction("Settings..."), &QAction::triggered, this, [this, group]() { editGroup(group); });
+    }
     
-    QString jobId = m_jobTable->item(row, 0)->data(Qt::UserRole).toString();
-    CronJob* job = m_cronManager->getJob(jobId);
+    menu.exec(m_jobTable->viewport()->mapToGlobal(pos));
+}
+
+void MainWindow::editGroup(const QString& name)
+{
+    JobGroup group = m_groups.value(name);
+    group.name = name;
+    
+    QDialog dialog(this);
+    dialog.setWindowTitle(QString("Group \"%1\"").arg(name));
+    QFormLayout* form = new QFormLayout(&dialog);
+    
+    QSpinBox* limitSpinBox = new QSpinBox(&dialog);
+    limitSpinBox->setRange(0, 1000);
+    limitSpinBox->setSpecialValueText("No limit");
+    limitSpinBox->setSuffix(" at a time");
+    limitSpinBox->setValue(group.maxConcurrent);
+    limitSpinBox->setToolTip("Runs beyond the limit wait for one of the group's jobs to finish");
+    form->addRow("Run at most:", limitSpinBox);
+    
+    QSpinBox* prioritySpinBox = new QSpinBox(&dialog);
+    prioritySpinBox->setRange(-100, 100);
+    prioritySpinBox->setValue(group.priority);
+    prioritySpinBox->setToolTip("When jobs of several groups are due at once, higher priority groups start first");
+    form->addRow("Priority:", prioritySpinBox);
+    
+    QDialogButtonBox* buttons = new QDialogButtonBox(QDialogButtonBox::Ok | QDialogButtonBox::Cancel, &dialog);
+    connect(buttons, &QDialogButtonBox::accepted, &dialog, &QDialog::accept);
+    connect(buttons, &QDialogButtonBox::rejected, &dialog, &QDialog::reject);
+    form->addRow(buttons);
     
-    if (job) {
-        job->enabled = !job->enabled;
-        m_cronManager->updateJob(*job);
+    if (dialog.exec() == QDialog::Accepted) {
+        group.maxConcurrent = limitSpinBox->value();
+        group.priority = prioritySpinBox->value();
+        runInScheduler([manager = m_cronManager, group]() { manager->setGroup(group); });
+    }
+}
+
+void MainWindow::setJobsEnabled(const QStringList& ids, bool enabled)
+{
+    runInScheduler([manager = m_cronManager, ids, enabled]() { manager->setJobsEnabled(ids, enabled); });
+}
+
+void MainWindow::runJobs(const QStringList& ids)
+{
+    runInScheduler([manager = m_cronManager, ids]() { manager->runJobs(ids); });
+}
+
+void MainWindow::removeJobs(const QStringList& ids, const QString& question)
+{
+    QMessageBox::StandardButton reply = QMessageBox::question(this, "Remove Jobs", question,
+        QMessageBox::Yes | QMessageBox::No);
+    if (reply == QMessageBox::Yes) {
+        runInScheduler([manager = m_cronManager, ids]() { manager->removeJobs(ids); });
     }
 }
 
@@ -306,7 +588,7 @@ void MainWindow::toggleAutoStart()
 
 void MainWindow::onJobExecuted(const QString& jobId, bool success, const QString& output)
 {
-    CronJob* job = m_cronManager->getJob(jobId);
+    const CronJob* job = findJob(jobId);
     QString jobName = job ? job->name : jobId;
     
     QString statusIcon = success ? "[OK]" : "[FAIL]";
@@ -314,109 +596,235 @@ void MainWindow::onJobExecuted(const QString& jobId, bool success, const QString
     // Log the job completion status
     onLogMessage(QString("%1 %2 completed").arg(statusIcon, jobName));
     
-    // Log the full output if there is any
-    if (!output.trimmed().isEmpty()) {
-        m_logView->append(QString("--- Output from %1 ---").arg(jobName));
-        m_logView->append(output.trimmed());
-        m_logView->append("--- End of output ---");
-        m_logView->append("");  // Empty line for spacing
+    // Log the output if there is any, unless its tab already shows it;
+    // long output is cut short, since the output index keeps all of it
+    const QString trimmed = output.trimmed();
+    if (!trimmed.isEmpty() && m_outputTails.contains(jobId)) {
+        appendLog(QString("Output of %1 is in its tab below; cron-gui-ctl search finds it later").arg(jobName));
+    } else if (!trimmed.isEmpty()) {
+        appendLog(QString("--- Output from %1 ---").arg(jobName));
+        appendLog(trimmed.left(LOG_OUTPUT_CHARS));
+        if (trimmed.size() > LOG_OUTPUT_CHARS) {
+            appendLog(QString("[%1 more characters; cron-gui-ctl search lists the run, "
+                              "cron-gui-ctl output RUN prints all of it]").arg(trimmed.size() - LOG_OUTPUT_CHARS));
+        }
+        appendLog("--- End of output ---");
+        appendLog("");  // Empty line for spacing
     }
     
     // Scroll to bottom to show latest
-    m_logView->verticalScrollBar()->setValue(m_logView->verticalScrollBar()->maximum());
+    if (m_uiBuilt) {
+        m_logView->verticalScrollBar()->setValue(m_logView->verticalScrollBar()->maximum());
+    }
     
-    // Show tray notification (keep this short)
-    QString notifyText = output.trimmed().isEmpty() ? "Completed" : output.left(100);
-    m_trayIcon->showMessage(
-        success ? "Job Completed" : "Job Failed",
-        QString("%1: %2").arg(jobName, notifyText),
-        success ? QSystemTrayIcon::Information : QSystemTrayIcon::Warning,
-        3000
-    );
+    if (OutputTail* tail = m_outputTails.value(jobId)) {
+        tail->finish(success);
+    }
     
-    refreshJobTable();
+    // Tray notification (keep this short); summarized unless the job asks otherwise
+    QString notifyText = output.trimmed().isEmpty() ? "Completed" : output.left(100);
+    m_notifier->jobFinished(jobName, success, notifyText, job && job->alertImmediately);
 }
 
-void MainWindow::onJobsChanged()
+void MainWindow::onJobOutput(const QString& jobId, const QString& text)
 {
-    refreshJobTable();
-    updateStatusBar();
+    if (!m_uiBuilt) {
+        return;   // Nobody has looked yet; its output goes to the log at the end
+    }
+    
+    OutputTail* tail = m_outputTails.value(jobId);
+    if (!tail) {
+        // Make room by closing the oldest finished tab; running ones stay
+        for (int i = 0; i < m_outputTabs->count() && m_outputTabs->count() >= MAX_OUTPUT_TABS; ) {
+            OutputTail* old = qobject_cast<OutputTail*>(m_outputTabs->widget(i));
+            if (old && old->isFinished() && old != m_outputTabs->currentWidget()) {
+                closeOutputTab(i);
+            } else {
+                ++i;
+            }
+        }
+        const CronJob* job = findJob(jobId);
+        tail = new OutputTail(this);
+        m_outputTails.insert(jobId, tail);
+        m_outputTabs->addTab(tail, job ? job->name : jobId);
+        m_outputGroup->show();
+        connect(tail, &OutputTail::idle, this, [this, tail]() {
+            // Left open while someone is looking at it
+            if (tail != m_outputTabs->currentWidget() || !m_outputGroup->isVisible()) {
+                closeOutputTab(m_outputTabs->indexOf(tail));
+            }
+        });
+    }
+    tail->appendOutput(text);
 }
 
-void MainWindow::onLogMessage(const QString& message)
+void MainWindow::closeOutputTab(int index)
 {
-    QString timestamp = QDateTime::currentDateTime().toString("yyyy-MM-dd hh:mm:ss");
-    m_logView->append(QString("[%1] %2").arg(timestamp, message));
-}
-
-void MainWindow::refreshJobTable()
-{
-    m_jobTable->setRowCount(0);
-    
-    const QVector<CronJob>& jobs = m_cronManager->getJobs();
-    
-    for (const CronJob& job : jobs) {
-        int row = m_jobTable->rowCount();
-        m_jobTable->insertRow(row);
-        
-        QTableWidgetItem* nameItem = new QTableWidgetItem(job.name);
-        nameItem->setData(Qt::UserRole, job.id);
-        m_jobTable->setItem(row, 0, nameItem);
-        
-        QTableWidgetItem* scriptItem = new QTableWidgetItem(job.scriptPath);
-        scriptItem->setToolTip(job.scriptPath);
-        m_jobTable->setItem(row, 1, scriptItem);
-        
-        m_jobTable->setItem(row, 2, new QTableWidgetItem(formatInterval(job.intervalMinutes)));
-        
-        // Last Run with tooltip
-        QTableWidgetItem* lastRunItem = new QTableWidgetItem(formatDateTime(job.lastRun));
-        if (job.lastRun.isValid()) {
-            lastRunItem->setToolTip(job.lastRun.toString("dddd, MMMM d, yyyy 'at' h:mm:ss AP"));
+    OutputTail* tail = qobject_cast<OutputTail*>(m_outputTabs->widget(index));
+    m_outputTabs->removeTab(index);
+    for (auto it = m_outputTails.begin(); it != m_outputTails.end(); ++it) {
+        if (it.value() == tail) {
+            m_outputTails.erase(it);
+            break;
         }
-        m_jobTable->setItem(row, 3, lastRunItem);
-        
-        // Next Run with tooltip
-        QTableWidgetItem* nextRunItem = new QTableWidgetItem(formatDateTime(job.nextRun));
-        if (job.nextRun.isValid()) {
-            nextRunItem->setToolTip(job.nextRun.toString("dddd, MMMM d, yyyy 'at' h:mm:ss AP"));
+    }
+    tail->deleteLater();   // May be the sender of idle()
+    if (m_outputTabs->count() == 0) {
+        m_outputGroup->hide();
+    }
+}
+
+void MainWindow::onJobsChanged(const QVector<CronJob>& jobs)
+{
+    m_jobModel->setJobs(jobs);
+    updateStatusBar();
+    
+    // The first snapshot arrives once the scheduler has loaded and started.
+    // The per-job lines are skipped for a hidden start.
+    if (!m_loggedStartup) {
+        m_loggedStartup = true;
+        onLogMessage(QString("Loaded %1 job(s)").arg(jobs.size()));
+        for (const CronJob& job : m_uiBuilt ? jobs : QVector<CronJob>()) {
+            if (job.enabled) {
+                if (job.triggerType == CronJob::FileChangeTrigger) {
+                    onLogMessage(QString("  - %1: watching %2").arg(job.name, job.watchPath));
+                } else {
+                    onLogMessage(QString("  - %1: next run at %2").arg(job.name, job.nextRun.toString("yyyy-MM-dd hh:mm:ss")));
+                }
+            }
         }
-        m_jobTable->setItem(row, 4, nextRunItem);
-        
-        QString status = job.enabled ? "Enabled" : "Disabled";
-        QTableWidgetItem* statusItem = new QTableWidgetItem(status);
-        statusItem->setForeground(job.enabled ? Qt::darkGreen : Qt::gray);
-        m_jobTable->setItem(row, 5, statusItem);
     }
 }
 
-void MainWindow::updateStatusBar()
+void MainWindow::onGroupsChanged(const QVector<JobGroup>& groups)
 {
-    int total = m_cronManager->getJobs().size();
-    int enabled = 0;
-    for (const CronJob& job : m_cronManager->getJobs()) {
-        if (job.enabled) enabled++;
+    m_groups.clear();
+    for (const JobGroup& group : groups) {
+        m_groups.insert(group.name, group);
     }
-    m_statusLabel->setText(QString("Jobs: %1 total, %2 enabled | Scheduler: Running").arg(total).arg(enabled));
 }
 
-QString MainWindow::formatInterval(int minutes)
+void MainWindow::onJobAdded(const CronJob& job)
 {
-    if (minutes >= 1440) {
-        int days = minutes / 1440;
-        return QString("%1 day%2").arg(days).arg(days > 1 ? "s" : "");
-    } else if (minutes >= 60) {
-        int hours = minutes / 60;
-        return QString("%1 hour%2").arg(hours).arg(hours > 1 ? "s" : "");
-    } else {
-        return QString("%1 minute%2").arg(minutes).arg(minutes > 1 ? "s" : "");
+    m_jobModel->upsertJob(job);
+    updateStatusBar();
+}
+
+void MainWindow::onJobUpdated(const CronJob& job)
+{
+    if (!m_jobModel->job(job.id)) return;
+    
+    m_jobModel->upsertJob(job);
+    updateStatusBar();
+}
+
+void MainWindow::onJobRemoved(const QString& jobId)
+{
+    m_jobModel->removeJob(jobId);
+    updateStatusBar();
+}
+
+void MainWindow::onStatsChanged(const SchedulerStats& stats)
+{
+    m_stats = stats;
+    updateStatusBar();
+}
+
+const CronJob* MainWindow::findJob(const QString& jobId) const
+{
+    return m_jobModel->job(jobId);
+}
+
+QString MainWindow::selectedJobId() const
+{
+    return m_jobTable->currentIndex().data(JobTableModel::JobIdRole).toString();
+}
+
+QStringList MainWindow::selectedJobIds() const
+{
+    QStringList ids;
+    const QModelIndexList rows = m_jobTable->selectionModel()->selectedRows();
+    for (const QModelIndex& row : rows) {
+        ids.append(row.data(JobTableModel::JobIdRole).toString());
+    }
+    return ids;
+}
+
+QStringList MainWindow::groupJobIds(const QString& group) const
+{
+    QStringList ids;
+    for (const CronJob& job : m_jobModel->jobs()) {
+        if (job.group == group) {
+            ids.append(job.id);
+        }
+    }
+    return ids;
+}
+
+void MainWindow::onFilterChanged(const QString& text)
+{
+    m_filterModel->setSearchText(text);
+    updateStatusBar();
+}
+
+void MainWindow::onLogMessage(const QString& message)
+{
+    QString timestamp = QDateTime::currentDateTime().toString("yyyy-MM-dd hh:mm:ss");
+    appendLog(QString("[%1] %2").arg(timestamp, message));
+}
+
+void MainWindow::appendLog(const QString& text)
+{
+    if (m_uiBuilt) {
+        m_logView->append(text);
+        return;
+    }
+    
+    // Keep only the recent past while hidden
+    const int maxPendingLines = 1000;
+    m_pendingLog.append(text);
+    if (m_pendingLog.size() > maxPendingLines) {
+        m_pendingLog.removeFirst();
     }
 }
 
-QString MainWindow::formatDateTime(const QDateTime& dt)
+void MainWindow::updateStatusBar()
 {
-    if (!dt.isValid()) {
-        return "Never";
+    if (!m_uiBuilt) {
+        return;
+    }
+    
+    int total = m_jobModel->rowCount();
+    int enabled = m_jobModel->enabledCount();
+    QString status = QString("Jobs: %1 total, %2 enabled | Scheduler: Running").arg(total).arg(enabled);
+    if (m_stats.lagSamples > 0) {
+        status += QString(" | Start lag: %1 ms (max %2 ms)").arg(m_stats.lastLagMs).arg(m_stats.maxLagMs);
+    }
+    if (!m_stats.clusterNode.isEmpty()) {
+        status += QString(" | Cluster node %1 of %2").arg(m_stats.clusterNode).arg(m_stats.clusterSize);
+    }
+    if (m_stats.groupWaiting > 0) {
+        status += QString(" | Waiting for a group slot: %1").arg(m_stats.groupWaiting);
+    }
+    if (m_stats.deferrals > 0) {
+        status += QString(" | Deferred (host busy): %1 waiting, %2 so far").arg(m_stats.deferredJobs).arg(m_stats.deferrals);
+        if (m_stats.forcedRuns > 0) {
+            status += QString(", %1 run after max wait").arg(m_stats.forcedRuns);
+        }
+    }
+    if (m_stats.deadlineMisses + m_stats.predictedMisses > 0) {
+        status += QString(" | Deadlines: %1 missed, %2 at risk").arg(m_stats.deadlineMisses).arg(m_stats.predictedMisses);
+    }
+    if (m_stats.loopStalls > 0) {
+        status += QString(" | Scheduler blocked: %1 time(s), longest %2 ms, last in %3")
+            .arg(m_stats.loopStalls).arg(m_stats.longestStallMs).arg(m_stats.lastStallHandler);
+    }
+    m_statusLabel->setText(status);
+    
+    if (m_filterEdit->text().isEmpty()) {
+        m_filterLabel->clear();
+    } else {
+        m_filterLabel->setText(QString("%1 of %2 shown (%3 ms)")
+            .arg(m_filterModel->rowCount()).arg(total).arg(m_filterModel->lastSearchMs()));
     }
-    return dt.toString("yyyy-MM-dd hh:mm:ss");
 }
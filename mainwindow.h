@@ -4,14 +4,24 @@
 #include <QMainWindow>
 #include <QSystemTrayIcon>
 #include <QMenu>
-#include <QTableWidget>
+#include <QTableView>
+#include <QLineEdit>
 #include <QTextEdit>
 #include <QCloseEvent>
 #include <QPushButton>
 #include <QCheckBox>
 #include <QLabel>
+#include <QGroupBox>
+#include <QTabWidget>
+#include <QHash>
+#include <QFutureWatcher>
 #include "cronmanager.h"
 
+class TrayNotifier;
+class JobTableModel;
+class JobFilterModel;
+class OutputTail;
+
 QT_BEGIN_NAMESPACE
 namespace Ui {
 class MainWindow;
@@ -23,11 +33,12 @@ class MainWindow : public QMainWindow
     Q_OBJECT
 
 public:
-    MainWindow(bool startHidden = false, QWidget *parent = nullptr);
+    explicit MainWindow(CronManager* cronManager, bool startHidden = false, QWidget *parent = nullptr);
     ~MainWindow();
 
 public slots:
     void showWindow();  // Public so it can be called from other instances
+    void stallGui(int milliseconds);  // Diagnostics: block the GUI thread
 
 protected:
     void closeEvent(QCloseEvent *event) override;
@@ -38,32 +49,85 @@ private slots:
     void removeJob();
     void runJobNow();
     void toggleJobEnabled();
+    void importJobs();
+    void onImportParsed();
+    void showForecast();
+    void showJobMenu(const QPoint& pos);
+    void editGroup(const QString& name);
     
     void onJobExecuted(const QString& jobId, bool success, const QString& output);
-    void onJobsChanged();
+    void onJobOutput(const QString& jobId, const QString& text);
+    void closeOutputTab(int index);
+    void onJobsChanged(const QVector<CronJob>& jobs);
+    void onGroupsChanged(const QVector<JobGroup>& groups);
+    void onJobAdded(const CronJob& job);
+    void onJobUpdated(const CronJob& job);
+    void onJobRemoved(const QString& jobId);
+    void onStatsChanged(const SchedulerStats& stats);
+    void onFilterChanged(const QString& text);
     void onLogMessage(const QString& message);
     
     void trayIconActivated(QSystemTrayIcon::ActivationReason reason);
     void toggleAutoStart();
 
 private:
+    // A job file read on a worker thread
+    struct ImportResult {
+        QString fileName;
+        QVector<CronJob> jobs;
+        QStringList errors;        // The first few, for the message box
+        bool ok = false;
+        QString errorString;
+        qint64 linesRead = 0;
+        qint64 jobCount = 0;
+        qint64 errorCount = 0;
+        qint64 parseMs = 0;
+    };
+
+    void ensureUi();   // Builds the window contents on first use
     void setupUI();
     void setupSystemTray();
-    void refreshJobTable();
+    const CronJob* findJob(const QString& jobId) const;
+    QString selectedJobId() const;
+    QStringList selectedJobIds() const;
+    QStringList groupJobIds(const QString& group) const;
+    void setJobsEnabled(const QStringList& ids, bool enabled);
+    void runJobs(const QStringList& ids);
+    void removeJobs(const QStringList& ids, const QString& question);
     void updateStatusBar();
-    QString formatInterval(int minutes);
-    QString formatDateTime(const QDateTime& dt);
+    void appendLog(const QString& text);
+
+    // The manager lives on the scheduler thread; run f there, queued
+    template <typename Functor>
+    void runInScheduler(Functor f) { QMetaObject::invokeMethod(m_cronManager, f, Qt::QueuedConnection); }
 
     Ui::MainWindow *ui;
     CronManager* m_cronManager;
     
+    // GUI-side copy of the scheduler's jobs, kept current by its signals
+    JobTableModel* m_jobModel;
+    JobFilterModel* m_filterModel;
+    SchedulerStats m_stats;
+    QHash<QString, JobGroup> m_groups;
+    bool m_loggedStartup;
+    bool m_uiBuilt;
+    QStringList m_pendingLog;   // Log lines received before the window was built
+    
     // UI Elements
-    QTableWidget* m_jobTable;
+    QTableView* m_jobTable;
+    QLineEdit* m_filterEdit;
+    QLabel* m_filterLabel;
     QTextEdit* m_logView;
+    QGroupBox* m_outputGroup;
+    QTabWidget* m_outputTabs;
+    QHash<QString, OutputTail*> m_outputTails;   // Job id -> its live output tab
+    QFutureWatcher<ImportResult> m_importWatcher;
     QPushButton* m_addButton;
     QPushButton* m_editButton;
     QPushButton* m_removeButton;
     QPushButton* m_runNowButton;
+    QPushButton* m_importButton;
+    QPushButton* m_forecastButton;
     QCheckBox* m_autoStartCheck;
     QLabel* m_statusLabel;
     
@@ -72,6 +136,7 @@ private:
     QMenu* m_trayMenu;
     QAction* m_showAction;
     QAction* m_quitAction;
+    TrayNotifier* m_notifier;
     
     bool m_startHidden;
 };
@@ -0,0 +1,234 @@
+#include "outputarchive.h"
+#include <QDataStream>
+#include <QDir>
+#include <QHash>
+#include <QSaveFile>
+#include <QSet>
+
+namespace {
+const quint32 PACK_MAGIC = 0x43474152;    // "CGAR"
+const quint32 PACK_VERSION = 1;
+const int BLOCK_BYTES = 256 * 1024;       // Output per block before compression
+const qint64 TRAILER_BYTES = 12;          // Table offset and magic
+}
+
+OutputArchive::OutputArchive(const QString& directory)
+    : m_directory(directory)
+    , m_nextPack(0)
+    , m_truncateHot(false)
+    , m_cachedPack(-1)
+    , m_cachedBlock(-1)
+{
+}
+
+bool OutputArchive::open()
+{
+    QDir dir(m_directory);
+    const QStringList names = dir.entryList(QStringList() << "pack-*.dat", QDir::Files);
+    for (const QString& name : names) {
+        bool ok = false;
+        const int number = name.mid(5, name.size() - 9).toInt(&ok);
+        if (!ok) {
+            continue;
+        }
+        // A pack that can't be read is still never reused
+        m_nextPack = qMax(m_nextPack, number + 1);
+        Pack pack;
+        if (loadPack(number, pack)) {
+            m_packs.insert(number, pack);
+        }
+    }
+    m_hotFile.setFileName(dir.filePath("output.dat"));
+    return m_hotFile.open(QIODevice::WriteOnly | QIODevice::Append);
+}
+
+OutputArchive::Location OutputArchive::append(const QByteArray& data)
+{
+    Location location;
+    location.offset = m_hotFile.size();
+    location.length = data.size();
+    m_hotFile.write(data);
+    m_hotFile.flush();
+    return location;
+}
+
+QByteArray OutputArchive::read(const Location& location) const
+{
+    if (location.length <= 0) {
+        return QByteArray();
+    }
+    if (location.pack < 0) {
+        QFile file(m_hotFile.fileName());
+        if (!file.open(QIODevice::ReadOnly) || !file.seek(location.offset)) {
+            return QByteArray();
+        }
+        return file.read(location.length);
+    }
+
+    auto it = m_packs.constFind(location.pack);
+    if (it == m_packs.constEnd() || location.block < 0 || location.block >= it->blocks.size()) {
+        return QByteArray();
+    }
+    if (m_cachedPack != location.pack || m_cachedBlock != location.block) {
+        const Block& block = it->blocks[location.block];
+        QFile file(packPath(location.pack));
+        if (!file.open(QIODevice::ReadOnly) || !file.seek(block.offset)) {
+            return QByteArray();
+        }
+        m_cachedData = qUncompress(file.read(block.compressedBytes));
+        m_cachedPack = location.pack;
+        m_cachedBlock = location.block;
+    }
+    return m_cachedData.mid(int(location.offset), int(location.length));
+}
+
+bool OutputArchive::compact(const QVector<Location*>& live)
+{
+    QHash<int, qint64> liveBytes;
+    QHash<int, int> liveRuns;
+    for (const Location* location : live) {
+        if (location->pack >= 0) {
+            liveBytes[location->pack] += location->length;
+            ++liveRuns[location->pack];
+        }
+    }
+
+    // Dead packs go; mostly dead ones are rewritten with the new output
+    QSet<int> repack;
+    m_obsoletePacks.clear();
+    for (auto it = m_packs.constBegin(); it != m_packs.constEnd(); ++it) {
+        if (liveRuns.value(it.key()) == 0) {
+            m_obsoletePacks.append(it.key());
+        } else if (liveBytes.value(it.key()) * 2 < it->rawBytes) {
+            repack.insert(it.key());
+            m_obsoletePacks.append(it.key());
+        }
+    }
+    QVector<Location*> moving;
+    for (Location* location : live) {
+        if (location->length <= 0) {
+            *location = Location();   // Nothing to store
+        } else if (location->pack < 0 || repack.contains(location->pack)) {
+            moving.append(location);
+        }
+    }
+    m_truncateHot = m_hotFile.size() > 0;
+    if (moving.isEmpty()) {
+        return m_truncateHot || !m_obsoletePacks.isEmpty();
+    }
+
+    // Written block by block, so a big repack never sits in memory whole
+    const int number = m_nextPack;
+    QSaveFile file(packPath(number));
+    if (!file.open(QIODevice::WriteOnly)) {
+        m_obsoletePacks.clear();
+        m_truncateHot = false;
+        return false;
+    }
+    QDataStream out(&file);
+    out << PACK_MAGIC << PACK_VERSION;
+
+    Pack pack;
+    QByteArray current;
+    auto writeBlock = [&]() {
+        Block block;
+        block.offset = file.pos();
+        const QByteArray compressed = qCompress(current);
+        block.compressedBytes = quint32(compressed.size());
+        block.rawBytes = quint32(current.size());
+        file.write(compressed);
+        pack.blocks.append(block);
+        pack.rawBytes += current.size();
+        current.clear();
+    };
+    QVector<Location> placed;
+    placed.reserve(moving.size());
+    for (const Location* location : qAsConst(moving)) {
+        const QByteArray data = read(*location);
+        if (!current.isEmpty() && current.size() + data.size() > BLOCK_BYTES) {
+            writeBlock();
+        }
+        Location to;
+        to.pack = number;
+        to.block = pack.blocks.size();
+        to.offset = current.size();
+        to.length = data.size();
+        current += data;
+        placed.append(to);
+    }
+    if (!current.isEmpty()) {
+        writeBlock();
+    }
+
+    const qint64 tableOffset = file.pos();
+    out << quint32(pack.blocks.size());
+    for (const Block& block : qAsConst(pack.blocks)) {
+        out << block.offset << block.compressedBytes << block.rawBytes;
+    }
+    out << tableOffset << PACK_MAGIC;
+    if (out.status() != QDataStream::Ok || !file.commit()) {
+        m_obsoletePacks.clear();
+        m_truncateHot = false;
+        return false;
+    }
+
+    m_packs.insert(number, pack);
+    m_nextPack = number + 1;
+    for (int i = 0; i < moving.size(); ++i) {
+        *moving[i] = placed[i];
+    }
+    return true;
+}
+
+void OutputArchive::finishCompaction()
+{
+    for (int number : qAsConst(m_obsoletePacks)) {
+        m_packs.remove(number);
+        QFile::remove(packPath(number));
+    }
+    m_obsoletePacks.clear();
+    m_cachedPack = -1;
+    m_cachedData.clear();
+    if (m_truncateHot) {
+        m_hotFile.resize(0);
+        m_truncateHot = false;
+    }
+}
+
+bool OutputArchive::loadPack(int number, Pack& pack) const
+{
+    QFile file(packPath(number));
+    if (!file.open(QIODevice::ReadOnly) || file.size() < 8 + 4 + TRAILER_BYTES) {
+        return false;
+    }
+    QDataStream in(&file);
+    quint32 magic = 0;
+    quint32 version = 0;
+    in >> magic >> version;
+    if (magic != PACK_MAGIC || version != PACK_VERSION) {
+        return false;
+    }
+    qint64 tableOffset = 0;
+    file.seek(file.size() - TRAILER_BYTES);
+    in >> tableOffset >> magic;
+    if (magic != PACK_MAGIC || tableOffset < 8 || !file.seek(tableOffset)) {
+        return false;
+    }
+
+    quint32 count = 0;
+    in >> count;
+    pack.blocks.clear();
+    pack.rawBytes = 0;
+    for (quint32 i = 0; i < count && in.status() == QDataStream::Ok; ++i) {
+        Block block;
+        in >> block.offset >> block.compressedBytes >> block.rawBytes;
+        pack.blocks.append(block);
+        pack.rawBytes += block.rawBytes;
+    }
+    return in.status() == QDataStream::Ok;
+}
+
+QString OutputArchive::packPath(int number) const
+{
+    return QDir(m_directory).filePath(QString("pack-%1.dat").arg(number));
+}
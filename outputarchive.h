@@ -0,0 +1,71 @@
+#ifndef OUTPUTARCHIVE_H
+#define OUTPUTARCHIVE_H
+
+#include <QByteArray>
+#include <QFile>
+#include <QMap>
+#include <QString>
+#include <QVector>
+
+// Where the output of finished runs is kept. New output is appended to a
+// plain file (output.dat) so a run costs one write. Compaction packs it
+// into pack-N.dat files of zlib-compressed blocks of about 256 KB, with a
+// block table at the end of each pack, so reading any one run means
+// inflating only the block it is in. Packs whose runs have mostly expired
+// are repacked with the next batch, and packs with no live runs deleted,
+// so the archive stays within about twice the live output compressed;
+// OutputIndex caps the live output.
+// Not thread-safe; OutputIndex uses it from its own thread.
+class OutputArchive
+{
+public:
+    struct Location {
+        int pack = -1;            // -1: in output.dat at offset
+        int block = 0;
+        qint64 offset = 0;        // Within the file or the inflated block
+        qint64 length = 0;
+    };
+
+    explicit OutputArchive(const QString& directory);
+
+    bool open();
+    Location append(const QByteArray& data);
+    QByteArray read(const Location& location) const;
+    qint64 hotBytes() const { return m_hotFile.size(); }
+
+    // Moves the given live runs out of output.dat, and out of packs that
+    // are less than half live, into one new pack, updating the locations in
+    // place. Returns false if there was nothing to do. Once the new
+    // locations are saved, call finishCompaction() to drop what was moved.
+    bool compact(const QVector<Location*>& live);
+    void finishCompaction();
+
+private:
+    struct Block {
+        qint64 offset = 0;
+        quint32 compressedBytes = 0;
+        quint32 rawBytes = 0;
+    };
+
+    struct Pack {
+        QVector<Block> blocks;
+        qint64 rawBytes = 0;
+    };
+
+    bool loadPack(int number, Pack& pack) const;
+    QString packPath(int number) const;
+
+    QString m_directory;
+    QFile m_hotFile;
+    QMap<int, Pack> m_packs;
+    int m_nextPack;
+    QVector<int> m_obsoletePacks;     // Emptied by the last compact()
+    bool m_truncateHot;
+
+    // The last block inflated; reads of neighbouring runs are common
+    mutable int m_cachedPack;
+    mutable int m_cachedBlock;
+    mutable QByteArray m_cachedData;
+};
+
+#endif // OUTPUTARCHIVE_H
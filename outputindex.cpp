@@ -0,0 +1,723 @@
+#include "outputindex.h"
+#include <QDataStream>
+#include <QDateTime>
+#include <QDir>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QSaveFile>
+#include <QSet>
+#include <algorithm>
+#include <cmath>
+
+namespace {
+const quint32 SEGMENT_MAGIC = 0x43474958;        // "CGIX"
+const quint32 SEGMENT_VERSION = 1;
+const int SPARSE_EVERY = 64;                     // Terms per in-memory dictionary entry
+const qint64 MEMORY_BUDGET_BYTES = 4 << 20;      // In-memory index size that forces a segment out
+const int FLUSH_IDLE_MS = 60000;                 // Write out recent runs after this long without a new one
+const int MERGE_FACTOR = 4;                      // Segments of one size tier merged at a time
+const qint64 MIN_TIER_BYTES = 64 * 1024;         // Segments below this share the lowest tier
+const int MIN_TERM_LENGTH = 2;
+const int MAX_TERM_LENGTH = 64;
+const int MAX_STORED_OUTPUT = 1 << 20;           // Output kept per run, in bytes
+const int SNIPPET_LENGTH = 200;
+const int COMPACT_INTERVAL_MS = 60 * 60 * 1000;  // Pack new output and apply retention this often
+const qint64 HOT_LIMIT_BYTES = 8 << 20;          // ...or once this much output is waiting
+const int MAX_RUNS = 100000;                     // Newest runs kept, whatever their jobs' retention
+const qint64 MAX_ARCHIVE_BYTES = 1LL << 30;      // Output kept in all, before compression
+}
+
+OutputIndex::OutputIndex(const QString& directory, QObject *parent)
+    : QObject(parent)
+    , m_directory(directory)
+    , m_archive(directory)
+    , m_nextRun(0)
+    , m_indexedRuns(0)
+    , m_nextSegment(0)
+    , m_memoryBytes(0)
+    , m_flushTimer(new QTimer(this))
+    , m_compactTimer(new QTimer(this))
+    , m_clock(SchedulerClock::system())
+    , m_open(false)
+{
+    m_compactTimer->setInterval(COMPACT_INTERVAL_MS);
+    connect(m_compactTimer, &QTimer::timeout, this, &OutputIndex::compact);
+    m_flushTimer->setSingleShot(true);
+    m_flushTimer->setInterval(FLUSH_IDLE_MS);
+    connect(m_flushTimer, &QTimer::timeout, this, &OutputIndex::flush);
+}
+
+OutputIndex::~OutputIndex()
+{
+    flush();
+}
+
+void OutputIndex::open()
+{
+    if (m_open) {
+        return;
+    }
+    QDir().mkpath(m_directory);
+    m_runsFile.setFileName(QDir(m_directory).filePath("runs.jsonl"));
+    loadRuns();
+    m_archive.open();
+    m_runsFile.open(QIODevice::WriteOnly | QIODevice::Append);
+    m_open = true;
+
+    if (!loadManifest()) {
+        // No index; start it over
+        for (const Segment& segment : qAsConst(m_segments)) {
+            QFile::remove(segmentPath(segment.fileName));
+        }
+        m_segments.clear();
+        m_indexedRuns = 0;
+    }
+    // Numbers the index has seen are not handed out again, even if the
+    // runs themselves were lost; the index just finds nothing for them
+    m_nextRun = qMax(m_nextRun, m_indexedRuns);
+
+    // Runs recorded after the last segment was written
+    for (const Run& run : qAsConst(m_runs)) {
+        if (run.id >= m_indexedRuns) {
+            indexRun(run.id, readOutput(run));
+        }
+    }
+
+    // Also clears out packs left behind by a compaction cut short
+    compact();
+    m_compactTimer->start();
+}
+
+void OutputIndex::addRun(const QString& jobId, qint64 finishedMs, bool success, const QString& output)
+{
+    if (!m_open) {
+        return;
+    }
+
+    Run run;
+    run.id = m_nextRun++;
+    run.jobId = jobId;
+    run.finishedMs = finishedMs;
+    run.success = success;
+    QByteArray data = output.toUtf8();
+    if (data.size() > MAX_STORED_OUTPUT) {
+        data.truncate(MAX_STORED_OUTPUT);
+    }
+    run.location = m_archive.append(data);
+    m_runsFile.write(runRecord(run) + '\n');
+    m_runsFile.flush();
+
+    m_runs.append(run);
+    indexRun(run.id, QString::fromUtf8(data));
+    m_flushTimer->start();
+    if (m_archive.hotBytes() >= HOT_LIMIT_BYTES) {
+        compact();
+    }
+}
+
+void OutputIndex::compact()
+{
+    if (!m_open) {
+        return;
+    }
+
+    // Newest first, so whatever is over the cap is the oldest
+    const qint64 nowMs = m_clock->nowMs();
+    int kept = 0;
+    qint64 keptBytes = 0;
+    bool full = false;
+    QVector<bool> drop(m_runs.size(), false);
+    for (int i = m_runs.size() - 1; i >= 0; --i) {
+        const Run& run = m_runs[i];
+        const int days = m_retentionDays.value(run.jobId);
+        full = full || kept >= MAX_RUNS || keptBytes + run.location.length > MAX_ARCHIVE_BYTES;
+        if (full || (days > 0 && run.finishedMs < nowMs - days * 86400000LL)) {
+            drop[i] = true;
+        } else {
+            ++kept;
+            keptBytes += run.location.length;
+        }
+    }
+    const int expired = m_runs.size() - kept;
+    if (expired > 0) {
+        int to = 0;
+        for (int i = 0; i < m_runs.size(); ++i) {
+            if (!drop[i]) {
+                m_runs[to++] = m_runs[i];
+            }
+        }
+        m_runs.resize(to);
+    }
+
+    QVector<OutputArchive::Location*> live;
+    live.reserve(m_runs.size());
+    for (Run& run : m_runs) {
+        live.append(&run.location);
+    }
+    if (!m_archive.compact(live) && expired == 0) {
+        return;
+    }
+
+    // The old copies go only once runs.jsonl points at the new ones
+    if (saveRuns()) {
+        m_archive.finishCompaction();
+    }
+    if (expired > 0) {
+        purgeSegments();
+    }
+}
+
+void OutputIndex::setRetention(const QHash<QString, int>& days)
+{
+    m_retentionDays = days;
+}
+
+void OutputIndex::indexRun(quint32 run, const QString& output)
+{
+    // Each term once per run, so posting lists stay sorted and unique
+    const QStringList terms = tokenize(output);
+    for (const QString& term : terms) {
+        auto it = m_memory.find(term);
+        if (it == m_memory.end()) {
+            it = m_memory.insert(term, QVector<quint32>());
+            m_memoryBytes += term.size() * 2 + 64;
+        }
+        it.value().append(run);
+        m_memoryBytes += sizeof(quint32);
+    }
+    if (m_memoryBytes >= MEMORY_BUDGET_BYTES) {
+        flush();
+    }
+}
+
+void OutputIndex::flush()
+{
+    m_flushTimer->stop();
+    if (!m_open || m_indexedRuns >= m_nextRun) {
+        return;
+    }
+
+    // Terms in byte order of their UTF-8, which is the order lookups expect
+    QVector<QPair<QByteArray, const QVector<quint32>*>> terms;
+    terms.reserve(m_memory.size());
+    for (auto it = m_memory.constBegin(); it != m_memory.constEnd(); ++it) {
+        terms.append(qMakePair(it.key().toUtf8(), &it.value()));
+    }
+    std::sort(terms.begin(), terms.end(), [](const QPair<QByteArray, const QVector<quint32>*>& a,
+                                             const QPair<QByteArray, const QVector<quint32>*>& b) {
+        return a.first < b.first;
+    });
+
+    Segment segment;
+    segment.fileName = QString("seg-%1.idx").arg(m_nextSegment++);
+    segment.firstRun = m_indexedRuns;
+    segment.lastRun = m_nextRun - 1;
+    segment.runs = liveRuns(segment.firstRun, segment.lastRun);
+
+    QSaveFile file(segmentPath(segment.fileName));
+    if (!file.open(QIODevice::WriteOnly)) {
+        return;
+    }
+    QDataStream out(&file);
+    out << SEGMENT_MAGIC << SEGMENT_VERSION;
+    for (const auto& term : qAsConst(terms)) {
+        out << term.first << quint32(term.second->size());
+        for (quint32 run : *term.second) {
+            out << run;
+        }
+    }
+    out << QByteArray();   // End of terms
+    if (!file.commit() || !loadSegment(segment)) {
+        return;
+    }
+
+    m_segments.append(segment);
+    m_indexedRuns = segment.lastRun + 1;
+    m_memory.clear();
+    m_memoryBytes = 0;
+    saveManifest();
+    maybeMerge();
+}
+
+QVector<OutputIndex::Hit> OutputIndex::search(const QString& query, qint64 fromMs, qint64 toMs, int limit)
+{
+    QVector<Hit> hits;
+    const QStringList terms = tokenize(query);
+    if (!m_open || terms.isEmpty() || limit <= 0) {
+        return hits;
+    }
+
+    // Intersect the posting lists, shortest first
+    QVector<QVector<quint32>> lists;
+    for (const QString& term : terms) {
+        lists.append(postings(term));
+        if (lists.last().isEmpty()) {
+            return hits;
+        }
+    }
+    std::sort(lists.begin(), lists.end(), [](const QVector<quint32>& a, const QVector<quint32>& b) {
+        return a.size() < b.size();
+    });
+    QVector<quint32> runs = lists.first();
+    for (int i = 1; i < lists.size() && !runs.isEmpty(); ++i) {
+        QVector<quint32> both;
+        std::set_intersection(runs.constBegin(), runs.constEnd(), lists[i].constBegin(), lists[i].constEnd(),
+                              std::back_inserter(both));
+        runs = both;
+    }
+
+    for (int i = runs.size() - 1; i >= 0 && hits.size() < limit; --i) {
+        const Run* found = findRun(runs[i]);
+        if (!found) {
+            continue;   // Dropped, but still in an older segment
+        }
+        const Run& run = *found;
+        if ((fromMs > 0 && run.finishedMs < fromMs) || (toMs > 0 && run.finishedMs > toMs)) {
+            continue;
+        }
+
+        Hit hit;
+        hit.run = runs[i];
+        hit.jobId = run.jobId;
+        hit.finishedMs = run.finishedMs;
+        hit.success = run.success;
+
+        // Show the line with the whole query if there is one, else the first word
+        const QString output = readOutput(run);
+        int at = output.indexOf(query.simplified(), 0, Qt::CaseInsensitive);
+        if (at < 0) {
+            at = qMax(0, output.indexOf(terms.first(), 0, Qt::CaseInsensitive));
+        }
+        const int lineStart = output.lastIndexOf('\n', at) + 1;
+        int lineEnd = output.indexOf('\n', at);
+        if (lineEnd < 0) {
+            lineEnd = output.size();
+        }
+        const int start = qMax(lineStart, at - SNIPPET_LENGTH / 2);
+        hit.snippet = output.mid(start, qMin(lineEnd - start, SNIPPET_LENGTH)).trimmed();
+        hits.append(hit);
+    }
+    return hits;
+}
+
+bool OutputIndex::runOutput(quint32 run, Hit& info, QString& output) const
+{
+    const Run* found = m_open ? findRun(run) : nullptr;
+    if (!found) {
+        return false;
+    }
+    const Run& stored = *found;
+    info.run = run;
+    info.jobId = stored.jobId;
+    info.finishedMs = stored.finishedMs;
+    info.success = stored.success;
+    output = readOutput(stored);
+    return true;
+}
+
+QVector<quint32> OutputIndex::postings(const QString& term) const
+{
+    QVector<quint32> runs;
+    const QByteArray key = term.toUtf8();
+    for (const Segment& segment : m_segments) {
+        runs += lookup(segment, key);
+    }
+    runs += m_memory.value(term);
+    return runs;
+}
+
+const OutputIndex::Run* OutputIndex::findRun(quint32 id) const
+{
+    auto it = std::lower_bound(m_runs.constBegin(), m_runs.constEnd(), id, [](const Run& run, quint32 value) {
+        return run.id < value;
+    });
+    return it != m_runs.constEnd() && it->id == id ? &*it : nullptr;
+}
+
+int OutputIndex::liveRuns(quint32 firstRun, quint32 lastRun) const
+{
+    auto less = [](const Run& run, quint32 value) { return run.id < value; };
+    auto from = std::lower_bound(m_runs.constBegin(), m_runs.constEnd(), firstRun, less);
+    auto to = std::lower_bound(from, m_runs.constEnd(), lastRun + 1, less);
+    return int(to - from);
+}
+
+void OutputIndex::purgeSegments()
+{
+    // Segments with no live run go; mostly dead ones are rewritten without
+    // the dead runs, the way merges leave them out
+    bool changed = false;
+    for (int i = m_segments.size() - 1; i >= 0; --i) {
+        const Segment& segment = m_segments[i];
+        const int live = liveRuns(segment.firstRun, segment.lastRun);
+        if (live == 0) {
+            QFile::remove(segmentPath(segment.fileName));
+            m_segments.removeAt(i);
+            changed = true;
+        } else if (live * 2 < segment.runs) {
+            mergeSegments(i, 1);
+        }
+    }
+    if (changed) {
+        saveManifest();
+    }
+    maybeMerge();
+}
+
+QVector<quint32> OutputIndex::lookup(const Segment& segment, const QByteArray& term) const
+{
+    QVector<quint32> runs;
+    // The last dictionary entry at or before the term; it is within SPARSE_EVERY records
+    auto it = std::upper_bound(segment.sparse.constBegin(), segment.sparse.constEnd(), term,
+                               [](const QByteArray& key, const QPair<QByteArray, qint64>& entry) {
+        return key < entry.first;
+    });
+    if (it == segment.sparse.constBegin()) {
+        return runs;
+    }
+    --it;
+
+    QFile file(segmentPath(segment.fileName));
+    if (!file.open(QIODevice::ReadOnly) || !file.seek(it->second)) {
+        return runs;
+    }
+    QDataStream in(&file);
+    for (int i = 0; i < SPARSE_EVERY; ++i) {
+        QByteArray current;
+        quint32 count = 0;
+        in >> current;
+        if (current.isEmpty() || in.status() != QDataStream::Ok || current > term) {
+            break;
+        }
+        in >> count;
+        if (current == term) {
+            runs.resize(int(count));
+            for (quint32 j = 0; j < count; ++j) {
+                in >> runs[int(j)];
+            }
+            break;
+        }
+        in.skipRawData(int(count * sizeof(quint32)));
+    }
+    return runs;
+}
+
+bool OutputIndex::loadSegment(Segment& segment)
+{
+    QFile file(segmentPath(segment.fileName));
+    if (!file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+    QDataStream in(&file);
+    quint32 magic = 0;
+    quint32 version = 0;
+    in >> magic >> version;
+    if (magic != SEGMENT_MAGIC || version != SEGMENT_VERSION) {
+        return false;
+    }
+
+    segment.sparse.clear();
+    segment.bytes = file.size();
+    for (int i = 0;; ++i) {
+        const qint64 offset = file.pos();
+        QByteArray term;
+        quint32 count = 0;
+        in >> term;
+        if (term.isEmpty()) {
+            break;
+        }
+        in >> count;
+        if (in.status() != QDataStream::Ok) {
+            return false;
+        }
+        if (i % SPARSE_EVERY == 0) {
+            segment.sparse.append(qMakePair(term, offset));
+        }
+        in.skipRawData(int(count * sizeof(quint32)));
+    }
+    return in.status() == QDataStream::Ok;
+}
+
+int OutputIndex::tier(qint64 bytes)
+{
+    if (bytes <= MIN_TIER_BYTES) {
+        return 0;
+    }
+    return 1 + int(std::log(double(bytes) / MIN_TIER_BYTES) / std::log(double(MERGE_FACTOR)));
+}
+
+void OutputIndex::maybeMerge()
+{
+    // Like-sized neighbours only, so every run is rewritten about
+    // log(runs) times over the life of the index
+    bool merged = true;
+    while (merged) {
+        merged = false;
+        for (int i = 0; i + MERGE_FACTOR <= m_segments.size(); ++i) {
+            const int level = tier(m_segments[i].bytes);
+            int j = 1;
+            while (j < MERGE_FACTOR && tier(m_segments[i + j].bytes) == level) {
+                ++j;
+            }
+            if (j == MERGE_FACTOR) {
+                merged = mergeSegments(i, MERGE_FACTOR);
+                break;
+            }
+        }
+    }
+}
+
+bool OutputIndex::mergeSegments(int first, int count)
+{
+    struct Reader {
+        QFile file;
+        QDataStream stream;
+        QByteArray term;
+        quint32 postings = 0;
+    };
+
+    // One open file and one current term per input
+    QVector<Reader*> readers;
+    auto cleanup = [&readers]() {
+        qDeleteAll(readers);
+        readers.clear();
+    };
+    for (int i = first; i < first + count; ++i) {
+        Reader* reader = new Reader;
+        readers.append(reader);
+        reader->file.setFileName(segmentPath(m_segments[i].fileName));
+        if (!reader->file.open(QIODevice::ReadOnly)) {
+            cleanup();
+            return false;
+        }
+        reader->stream.setDevice(&reader->file);
+        quint32 magic = 0;
+        quint32 version = 0;
+        reader->stream >> magic >> version >> reader->term;
+        if (!reader->term.isEmpty()) {
+            reader->stream >> reader->postings;
+        }
+    }
+
+    Segment merged;
+    merged.fileName = QString("seg-%1.idx").arg(m_nextSegment++);
+    merged.firstRun = m_segments[first].firstRun;
+    merged.lastRun = m_segments[first + count - 1].lastRun;
+    merged.runs = liveRuns(merged.firstRun, merged.lastRun);
+
+    QSaveFile file(segmentPath(merged.fileName));
+    if (!file.open(QIODevice::WriteOnly)) {
+        cleanup();
+        return false;
+    }
+    QDataStream out(&file);
+    out << SEGMENT_MAGIC << SEGMENT_VERSION;
+
+    QVector<quint32> runs;
+    for (;;) {
+        QByteArray smallest;
+        for (Reader* reader : qAsConst(readers)) {
+            if (!reader->term.isEmpty() && (smallest.isEmpty() || reader->term < smallest)) {
+                smallest = reader->term;
+            }
+        }
+        if (smallest.isEmpty()) {
+            break;
+        }
+
+        // The inputs cover consecutive run ranges, so their lists just
+        // concatenate; runs dropped since are left out
+        runs.clear();
+        for (Reader* reader : qAsConst(readers)) {
+            if (reader->term != smallest) {
+                continue;
+            }
+            for (quint32 j = 0; j < reader->postings; ++j) {
+                quint32 run = 0;
+                reader->stream >> run;
+                if (findRun(run)) {
+                    runs.append(run);
+                }
+            }
+            reader->stream >> reader->term;
+            reader->postings = 0;
+            if (!reader->term.isEmpty()) {
+                reader->stream >> reader->postings;
+            }
+            if (reader->stream.status() != QDataStream::Ok) {
+                cleanup();
+                return false;
+            }
+        }
+        if (!runs.isEmpty()) {
+            out << smallest << quint32(runs.size());
+            for (quint32 run : qAsConst(runs)) {
+                out << run;
+            }
+        }
+    }
+    out << QByteArray();
+    cleanup();
+    if (!file.commit() || !loadSegment(merged)) {
+        return false;
+    }
+
+    QStringList obsolete;
+    for (int i = first; i < first + count; ++i) {
+        obsolete.append(m_segments[i].fileName);
+    }
+    m_segments.erase(m_segments.begin() + first, m_segments.begin() + first + count);
+    m_segments.insert(first, merged);
+    saveManifest();
+    for (const QString& fileName : obsolete) {
+        QFile::remove(segmentPath(fileName));
+    }
+    return true;
+}
+
+QStringList OutputIndex::tokenize(const QString& text)
+{
+    QSet<QString> seen;
+    QStringList terms;
+    QString current;
+    for (int i = 0; i <= text.size(); ++i) {
+        const QChar c = i < text.size() ? text.at(i) : QChar(' ');
+        if (c.isLetterOrNumber()) {
+            current.append(c.toLower());
+            continue;
+        }
+        if (current.size() >= MIN_TERM_LENGTH && current.size() <= MAX_TERM_LENGTH && !seen.contains(current)) {
+            seen.insert(current);
+            terms.append(current);
+        }
+        current.clear();
+    }
+    return terms;
+}
+
+void OutputIndex::loadRuns()
+{
+    if (!m_runsFile.open(QIODevice::ReadOnly)) {
+        return;
+    }
+    QHash<QString, QString> jobIds;   // One copy of each job id
+    while (!m_runsFile.atEnd()) {
+        const QJsonObject record = QJsonDocument::fromJson(m_runsFile.readLine()).object();
+        if (record.isEmpty()) {
+            continue;   // Torn by a crash mid-write
+        }
+        // Older files numbered runs by line and kept expired ones
+        Run run;
+        run.id = record.contains("run") ? quint32(record["run"].toDouble()) : m_nextRun;
+        if (run.id < m_nextRun) {
+            continue;   // Out of order; numbers only ever grow
+        }
+        m_nextRun = run.id + 1;
+        if (record["expired"].toBool(false)) {
+            continue;
+        }
+        const QString jobId = record["job"].toString();
+        run.jobId = jobIds.value(jobId, jobId);
+        jobIds.insert(jobId, run.jobId);
+        run.finishedMs = qint64(record["finished"].toDouble());
+        run.success = record["ok"].toBool();
+        run.location.pack = record["pack"].toInt(-1);
+        run.location.block = record["block"].toInt(0);
+        run.location.offset = qint64(record["offset"].toDouble());
+        run.location.length = qint64(record["length"].toDouble());
+        m_runs.append(run);
+    }
+    m_runsFile.close();
+}
+
+bool OutputIndex::saveRuns()
+{
+    QSaveFile file(m_runsFile.fileName());
+    if (!file.open(QIODevice::WriteOnly)) {
+        return false;
+    }
+    for (const Run& run : qAsConst(m_runs)) {
+        file.write(runRecord(run) + '\n');
+    }
+    if (!file.commit()) {
+        return false;
+    }
+    // The open handle still points at the replaced file
+    m_runsFile.close();
+    return m_runsFile.open(QIODevice::WriteOnly | QIODevice::Append);
+}
+
+QByteArray OutputIndex::runRecord(const Run& run)
+{
+    QJsonObject record;
+    record["run"] = qint64(run.id);
+    record["job"] = run.jobId;
+    record["finished"] = run.finishedMs;
+    record["ok"] = run.success;
+    if (run.location.pack >= 0) {
+        record["pack"] = run.location.pack;
+        record["block"] = run.location.block;
+    }
+    record["offset"] = run.location.offset;
+    record["length"] = run.location.length;
+    return QJsonDocument(record).toJson(QJsonDocument::Compact);
+}
+
+bool OutputIndex::loadManifest()
+{
+    QFile file(QDir(m_directory).filePath("segments.json"));
+    if (!file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+    const QJsonObject manifest = QJsonDocument::fromJson(file.readAll()).object();
+    m_indexedRuns = quint32(manifest["indexedRuns"].toDouble());
+    m_nextSegment = quint32(manifest["nextSegment"].toDouble());
+    const QJsonArray segments = manifest["segments"].toArray();
+    bool ok = !manifest.isEmpty();
+    for (const QJsonValue& val : segments) {
+        const QJsonObject obj = val.toObject();
+        Segment segment;
+        segment.fileName = obj["file"].toString();
+        segment.firstRun = quint32(obj["firstRun"].toDouble());
+        segment.lastRun = quint32(obj["lastRun"].toDouble());
+        segment.runs = obj["runs"].toInt(int(segment.lastRun - segment.firstRun + 1));
+        m_segments.append(segment);
+        ok = ok && loadSegment(m_segments.last());
+    }
+    return ok;
+}
+
+void OutputIndex::saveManifest()
+{
+    QJsonArray segments;
+    for (const Segment& segment : qAsConst(m_segments)) {
+        QJsonObject obj;
+        obj["file"] = segment.fileName;
+        obj["firstRun"] = qint64(segment.firstRun);
+        obj["lastRun"] = qint64(segment.lastRun);
+        obj["runs"] = segment.runs;
+        segments.append(obj);
+    }
+    QJsonObject manifest;
+    manifest["indexedRuns"] = qint64(m_indexedRuns);
+    manifest["nextSegment"] = qint64(m_nextSegment);
+    manifest["segments"] = segments;
+
+    QSaveFile file(QDir(m_directory).filePath("segments.json"));
+    if (file.open(QIODevice::WriteOnly)) {
+        file.write(QJsonDocument(manifest).toJson());
+        file.commit();
+    }
+}
+
+QString OutputIndex::readOutput(const Run& run) const
+{
+    return QString::fromUtf8(m_archive.read(run.location));
+}
+
+QString OutputIndex::segmentPath(const QString& fileName) const
+{
+    return QDir(m_directory).filePath(fileName);
+}
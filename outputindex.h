@@ -0,0 +1,119 @@
+#ifndef OUTPUTINDEX_H
+#define OUTPUTINDEX_H
+
+#include <QObject>
+#include <QByteArray>
+#include <QFile>
+#include <QHash>
+#include <QPair>
+#include <QStringList>
+#include <QTimer>
+#include <QVector>
+#include "outputarchive.h"
+#include "schedulerclock.h"
+
+// Stores the output of finished runs and keeps an inverted index over it,
+// so runs of any job can be found by the words they printed. Output goes
+// to an OutputArchive, which packs it into compressed blocks about once an
+// hour; runs.jsonl has one line per run saying where its output is. The
+// same hourly pass drops runs older than their job's retention, and the
+// oldest runs beyond MAX_RUNS or MAX_ARCHIVE_BYTES of output, from the
+// archive, from runs.jsonl and from memory. Run numbers are never reused, so dropped ones leave gaps. New
+// runs are indexed in memory; when that passes a size budget (or has sat for a
+// minute) it is written out as an immutable segment of sorted terms with
+// their run numbers. Segments of about the same size are merged four at a
+// time by streaming through them side by side, so the segment count grows
+// with the log of the run count and a merge holds one term's run list in
+// memory. Merges leave out dropped runs, and a segment left mostly dead is
+// rewritten on its own, so the index shrinks along with the runs. Lookups
+// keep only every 64th term of each segment in memory and read the rest
+// from disk. Lives on its own thread; call open() first.
+class OutputIndex : public QObject
+{
+    Q_OBJECT
+
+public:
+    struct Hit {
+        quint32 run = 0;
+        QString jobId;
+        qint64 finishedMs = 0;
+        bool success = false;
+        QString snippet;          // The first matching line, shortened
+    };
+
+    explicit OutputIndex(const QString& directory, QObject *parent = nullptr);
+    ~OutputIndex();
+
+    // Runs that finished within [fromMs, toMs] and printed every word of
+    // query, newest first. A bound of 0 or less is left open.
+    QVector<Hit> search(const QString& query, qint64 fromMs, qint64 toMs, int limit);
+
+    // One run's details and full output; false if unknown or expired
+    bool runOutput(quint32 run, Hit& info, QString& output) const;
+
+    // Retention is judged on this clock's time; the system clock by default
+    void setClock(const SchedulerClock* clock) { m_clock = clock; }
+
+public slots:
+    void open();
+    void addRun(const QString& jobId, qint64 finishedMs, bool success, const QString& output);
+    void flush();
+    void compact();
+    // Job id -> days to keep its output; jobs not listed keep it until the run cap
+    void setRetention(const QHash<QString, int>& days);
+
+private:
+    struct Run {
+        quint32 id = 0;           // Its run number
+        QString jobId;
+        qint64 finishedMs = 0;
+        OutputArchive::Location location;
+        bool success = false;
+    };
+
+    struct Segment {
+        QString fileName;
+        quint32 firstRun = 0;
+        quint32 lastRun = 0;
+        int runs = 0;             // Live runs in [firstRun, lastRun] when it was written
+        qint64 bytes = 0;
+        QVector<QPair<QByteArray, qint64>> sparse;   // Every SPARSE_EVERY-th term -> file offset
+    };
+
+    static QStringList tokenize(const QString& text);
+    static int tier(qint64 bytes);
+    void loadRuns();
+    bool saveRuns();
+    static QByteArray runRecord(const Run& run);
+    bool loadManifest();
+    void saveManifest();
+    void indexRun(quint32 run, const QString& output);
+    bool loadSegment(Segment& segment);
+    QVector<quint32> lookup(const Segment& segment, const QByteArray& term) const;
+    QVector<quint32> postings(const QString& term) const;
+    const Run* findRun(quint32 id) const;
+    int liveRuns(quint32 firstRun, quint32 lastRun) const;
+    void purgeSegments();
+    void maybeMerge();
+    bool mergeSegments(int first, int count);
+    QString readOutput(const Run& run) const;
+    QString segmentPath(const QString& fileName) const;
+
+    QString m_directory;
+    OutputArchive m_archive;
+    QFile m_runsFile;
+    QVector<Run> m_runs;                          // Live runs, by ascending run number
+    QVector<Segment> m_segments;                  // In run order
+    quint32 m_nextRun;                            // Number of the next run added
+    quint32 m_indexedRuns;                        // Runs below this are in segments
+    quint32 m_nextSegment;
+    QHash<QString, QVector<quint32>> m_memory;    // Term -> runs not yet in a segment
+    qint64 m_memoryBytes;
+    QTimer* m_flushTimer;
+    QTimer* m_compactTimer;
+    QHash<QString, int> m_retentionDays;
+    const SchedulerClock* m_clock;
+    bool m_open;
+};
+
+#endif // OUTPUTINDEX_H
@@ -0,0 +1,90 @@
+#include "outputtail.h"
+#include <QScrollBar>
+
+namespace {
+const int FRAME_MS = 100;      // At most ten updates a second
+const int MAX_LINES = 1000;    // Kept in the view and in the queue
+const int IDLE_MS = 5 * 60 * 1000;   // A finished run's output stays this long
+}
+
+OutputTail::OutputTail(QWidget *parent)
+    : QPlainTextEdit(parent)
+    , m_dropped(0)
+    , m_frameTimer(new QTimer(this))
+    , m_idleTimer(new QTimer(this))
+    , m_finished(false)
+{
+    setReadOnly(true);
+    setMaximumBlockCount(MAX_LINES);
+    setLineWrapMode(QPlainTextEdit::NoWrap);
+    setStyleSheet("QPlainTextEdit { font-family: Consolas, monospace; font-size: 10pt; background-color: #f5f5f5; color: #000000; }");
+
+    m_frameTimer->setSingleShot(true);
+    m_frameTimer->setInterval(FRAME_MS);
+    connect(m_frameTimer, &QTimer::timeout, this, &OutputTail::flushPending);
+    m_idleTimer->setSingleShot(true);
+    m_idleTimer->setInterval(IDLE_MS);
+    connect(m_idleTimer, &QTimer::timeout, this, &OutputTail::idle);
+}
+
+void OutputTail::appendOutput(const QString& text)
+{
+    if (m_finished) {
+        // A new run of the job; start over
+        clear();
+        m_pending.clear();
+        m_dropped = 0;
+        m_finished = false;
+        m_idleTimer->stop();
+    }
+
+    QStringList lines = text.split('\n');
+    if (text.endsWith('\n')) {
+        lines.removeLast();
+    }
+    m_pending.append(lines);
+    if (m_pending.size() > MAX_LINES) {
+        const int excess = m_pending.size() - MAX_LINES;
+        m_pending.erase(m_pending.begin(), m_pending.begin() + excess);
+        m_dropped += excess;
+    }
+
+    if (!m_frameTimer->isActive()) {
+        m_frameTimer->start();
+    }
+}
+
+void OutputTail::finish(bool success)
+{
+    m_pending.append(success ? "--- Finished ---" : "--- Failed ---");
+    flushPending();
+    m_finished = true;
+    m_idleTimer->start();
+}
+
+void OutputTail::showEvent(QShowEvent *event)
+{
+    QPlainTextEdit::showEvent(event);
+    flushPending();
+}
+
+void OutputTail::flushPending()
+{
+    if (m_pending.isEmpty() || !isVisible()) {
+        return;   // Picked up by showEvent()
+    }
+
+    // Follow the output unless the user has scrolled up to read
+    QScrollBar* bar = verticalScrollBar();
+    const bool atBottom = bar->value() == bar->maximum();
+    const int keep = bar->value();
+
+    if (m_dropped > 0) {
+        m_pending.prepend(QString("... %1 line(s) skipped ...").arg(m_dropped));
+        m_dropped = 0;
+    }
+    appendPlainText(m_pending.join('\n'));
+    m_pending.clear();
+
+    bar->setValue(atBottom ? bar->maximum() : keep);
+}
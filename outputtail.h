@@ -0,0 +1,43 @@
+#ifndef OUTPUTTAIL_H
+#define OUTPUTTAIL_H
+
+#include <QPlainTextEdit>
+#include <QStringList>
+#include <QTimer>
+
+// Live view of a running job's output. Incoming text is only queued; the
+// view is updated at most ten times a second in one append, and both the
+// queue and the document keep just the last MAX_LINES lines, so a job
+// writing thousands of lines a second costs the GUI a few repaints and a
+// fixed amount of memory. A tail that isn't on screen just queues. Once
+// its run has finished and no new run has written to it for a while, it
+// emits idle() so the window can close it.
+class OutputTail : public QPlainTextEdit
+{
+    Q_OBJECT
+
+public:
+    explicit OutputTail(QWidget *parent = nullptr);
+
+    void appendOutput(const QString& text);
+    void finish(bool success);
+    bool isFinished() const { return m_finished; }
+
+signals:
+    void idle();
+
+protected:
+    void showEvent(QShowEvent *event) override;
+
+private slots:
+    void flushPending();
+
+private:
+    QStringList m_pending;
+    int m_dropped;          // Lines that scrolled out of the queue unseen
+    QTimer* m_frameTimer;
+    QTimer* m_idleTimer;
+    bool m_finished;
+};
+
+#endif // OUTPUTTAIL_H
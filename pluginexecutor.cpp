@@ -0,0 +1,136 @@
+#include "pluginexecutor.h"
+#include "crontask.h"
+#include <QFileInfo>
+#include <QPluginLoader>
+#include <QTimer>
+#include <exception>
+
+namespace {
+const int SHUTDOWN_WAIT_MS = 5000;
+}
+
+PluginExecutor::PluginExecutor(QObject *parent)
+    : QObject(parent)
+    , m_pool(new QThreadPool)
+    , m_relay(std::make_shared<Relay>())
+    , m_nextCallId(1)
+{
+    m_pool->setObjectName("CronTask");
+    m_relay->target = this;
+}
+
+PluginExecutor::~PluginExecutor()
+{
+    for (const Call& call : qAsConst(m_calls)) {
+        *call.cancelled = true;
+    }
+    {
+        QMutexLocker lock(&m_relay->mutex);
+        m_relay->target = nullptr;   // Results arriving from now on are dropped
+    }
+    m_pool->clear();
+    if (m_pool->waitForDone(SHUTDOWN_WAIT_MS)) {
+        delete m_pool;
+    }
+    // Otherwise a call is stuck in a plugin; deleting the pool would wait for
+    // it without limit, so it is left to the process exit
+}
+
+CronTask* PluginExecutor::task(const QString& path, QString& error)
+{
+    const QString key = QFileInfo(path).absoluteFilePath();
+    QPluginLoader* loader = m_loaders.value(key);
+    if (!loader) {
+        loader = new QPluginLoader(key, this);
+        if (!loader->load()) {
+            // Not cached, so a fixed library is picked up on the next run
+            error = QString("Cannot load plugin: %1").arg(loader->errorString());
+            delete loader;
+            return nullptr;
+        }
+        m_loaders.insert(key, loader);
+    }
+    CronTask* task = qobject_cast<CronTask*>(loader->instance());
+    if (!task) {
+        error = QString("%1 is not a CronTask plugin").arg(key);
+    }
+    return task;
+}
+
+bool PluginExecutor::start(const CronJob& job)
+{
+    if (m_calls.contains(job.id)) {
+        return false;
+    }
+
+    const QString jobId = job.id;
+    QString error;
+    CronTask* task = this->task(job.scriptPath, error);
+    if (!task) {
+        // Queued, so it arrives after the caller has recorded the launch
+        QMetaObject::invokeMethod(this, [this, jobId, error]() {
+            emit finished(jobId, false, error);
+        }, Qt::QueuedConnection);
+        return true;
+    }
+
+    Call call;
+    call.id = m_nextCallId++;
+    call.cancelled = std::make_shared<std::atomic_bool>(false);
+    m_calls.insert(jobId, call);
+
+    const quint64 callId = call.id;
+    const QString arguments = job.arguments;
+    const std::shared_ptr<std::atomic_bool> cancelled = call.cancelled;
+    const std::shared_ptr<Relay> relay = m_relay;
+    m_pool->start([relay, task, jobId, callId, arguments, cancelled]() {
+        QString output;
+        bool success = false;
+        // An escaping exception would take the whole scheduler down
+        try {
+            success = task->run(arguments, output, *cancelled);
+        } catch (const std::exception& e) {
+            output = QString("Task failed with an exception: %1").arg(e.what());
+        } catch (...) {
+            output = "Task failed with an exception";
+        }
+        QMutexLocker lock(&relay->mutex);
+        PluginExecutor* executor = relay->target;
+        if (executor) {
+            QMetaObject::invokeMethod(executor, [executor, jobId, callId, success, output]() {
+                executor->callReturned(jobId, callId, success, output);
+            }, Qt::QueuedConnection);
+        }
+    });
+
+    if (job.timeoutSeconds > 0) {
+        const int seconds = job.timeoutSeconds;
+        QTimer::singleShot(seconds * 1000, this, [this, jobId, callId, seconds]() {
+            auto it = m_calls.find(jobId);
+            if (it == m_calls.end() || it->id != callId) {
+                return;   // Returned in time
+            }
+            // The thread keeps going until the task notices; the job stays
+            // busy until then, so calls can't pile up, and released() follows
+            *it->cancelled = true;
+            it->timedOut = true;
+            emit finished(jobId, false, QString("Timed out after %1 s").arg(seconds));
+        });
+    }
+    return true;
+}
+
+void PluginExecutor::callReturned(const QString& jobId, quint64 callId, bool success, const QString& output)
+{
+    auto it = m_calls.find(jobId);
+    if (it == m_calls.end() || it->id != callId) {
+        return;
+    }
+    const bool timedOut = it->timedOut;
+    m_calls.erase(it);
+    if (timedOut) {
+        emit released(jobId);
+    } else {
+        emit finished(jobId, success, output);
+    }
+}
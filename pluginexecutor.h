@@ -0,0 +1,60 @@
+#ifndef PLUGINEXECUTOR_H
+#define PLUGINEXECUTOR_H
+
+#include <QObject>
+#include <QHash>
+#include <QMutex>
+#include <QThreadPool>
+#include <atomic>
+#include <memory>
+#include "cronjob.h"
+
+class CronTask;
+class QPluginLoader;
+
+// Runs in-process jobs: CronTask plugins called on a thread pool, without
+// the cost of starting a process. Libraries are loaded on first use and
+// stay loaded. Lives on the scheduler thread; results come back there
+// through finished(). A call that times out is reported as failed at once,
+// but its thread counts as busy until run() returns (released()). Shutdown
+// waits a few seconds for running calls and then leaves them behind.
+class PluginExecutor : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit PluginExecutor(QObject *parent = nullptr);
+    ~PluginExecutor();
+
+    // False if the job's previous call has not returned yet; nothing is started then
+    bool start(const CronJob& job);
+    bool isRunning(const QString& jobId) const { return m_calls.contains(jobId); }
+
+signals:
+    void finished(const QString& jobId, bool success, const QString& output);
+    void released(const QString& jobId);   // A timed-out call has returned after all
+
+private:
+    // Shared with the pool threads, which may outlive this object
+    struct Relay {
+        QMutex mutex;
+        PluginExecutor* target = nullptr;
+    };
+
+    struct Call {
+        quint64 id = 0;
+        bool timedOut = false;    // Already reported as failed; the result is dropped
+        std::shared_ptr<std::atomic_bool> cancelled;
+    };
+
+    CronTask* task(const QString& path, QString& error);
+    void callReturned(const QString& jobId, quint64 callId, bool success, const QString& output);
+
+    QThreadPool* m_pool;                        // Leaked at shutdown if a call won't return
+    std::shared_ptr<Relay> m_relay;
+    QHash<QString, QPluginLoader*> m_loaders;   // Library path -> its loader
+    QHash<QString, Call> m_calls;               // Job id -> its call on the pool
+    quint64 m_nextCallId;
+};
+
+#endif // PLUGINEXECUTOR_H
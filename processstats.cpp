@@ -0,0 +1,134 @@
+#include "processstats.h"
+
+#ifdef Q_OS_WIN
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <QFile>
+#include <signal.h>
+#include <unistd.h>
+#endif
+
+qint64 ProcessStats::residentBytes()
+{
+#ifdef Q_OS_WIN
+    PROCESS_MEMORY_COUNTERS counters;
+    if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) {
+        return static_cast<qint64>(counters.WorkingSetSize);
+    }
+    return -1;
+#else
+    // Second field of /proc/self/statm is the resident page count
+    QFile statm("/proc/self/statm");
+    if (!statm.open(QIODevice::ReadOnly)) {
+        return -1;
+    }
+    QList<QByteArray> fields = statm.readAll().split(' ');
+    if (fields.size() < 2) {
+        return -1;
+    }
+    return fields[1].toLongLong() * sysconf(_SC_PAGESIZE);
+#endif
+}
+
+RunUsage ProcessStats::processUsage(qint64 pid)
+{
+    RunUsage usage;
+    if (pid <= 0) {
+        return usage;
+    }
+#ifdef Q_OS_WIN
+    HANDLE process = OpenProcess(PROCESS_QUERY_LIMITED_INFORMATION, FALSE, static_cast<DWORD>(pid));
+    if (!process) {
+        return usage;
+    }
+    FILETIME created, exited, kernel, user;
+    if (GetProcessTimes(process, &created, &exited, &kernel, &user)) {
+        auto ticks = [](const FILETIME& t) { return (qint64(t.dwHighDateTime) << 32) | t.dwLowDateTime; };
+        usage.cpuMs = (ticks(kernel) + ticks(user)) / 10000;   // 100 ns units
+    }
+    PROCESS_MEMORY_COUNTERS counters;
+    if (GetProcessMemoryInfo(process, &counters, sizeof(counters))) {
+        usage.peakRssBytes = static_cast<qint64>(counters.PeakWorkingSetSize);
+    }
+    IO_COUNTERS io;
+    if (GetProcessIoCounters(process, &io)) {
+        usage.readBytes = static_cast<qint64>(io.ReadTransferCount);
+        usage.writeBytes = static_cast<qint64>(io.WriteTransferCount);
+    }
+    CloseHandle(process);
+#else
+    const QByteArray dir = "/proc/" + QByteArray::number(pid);
+
+    // utime, stime, cutime and cstime are fields 14-17; the command name in
+    // field 2 may contain spaces, so count from its closing parenthesis
+    QFile stat(dir + "/stat");
+    if (stat.open(QIODevice::ReadOnly)) {
+        QByteArray line = stat.readAll();
+        QList<QByteArray> fields = line.mid(line.lastIndexOf(')') + 2).split(' ');
+        if (fields.size() > 14) {
+            qint64 ticks = fields[11].toLongLong() + fields[12].toLongLong()
+                         + fields[13].toLongLong() + fields[14].toLongLong();
+            usage.cpuMs = ticks * 1000 / sysconf(_SC_CLK_TCK);
+        }
+    }
+
+    QFile status(dir + "/status");
+    if (status.open(QIODevice::ReadOnly)) {
+        for (QByteArray line = status.readLine(); !line.isEmpty(); line = status.readLine()) {
+            if (line.startsWith("VmHWM:")) {
+                usage.peakRssBytes = line.mid(6).trimmed().split(' ').value(0).toLongLong() * 1024;
+                break;
+            }
+        }
+    }
+
+    // Readable for our own children; missing without task I/O accounting
+    QFile io(dir + "/io");
+    if (io.open(QIODevice::ReadOnly)) {
+        for (QByteArray line = io.readLine(); !line.isEmpty(); line = io.readLine()) {
+            if (line.startsWith("read_bytes:")) {
+                usage.readBytes = line.mid(11).trimmed().toLongLong();
+            } else if (line.startsWith("write_bytes:")) {
+                usage.writeBytes = line.mid(12).trimmed().toLongLong();
+            }
+        }
+    }
+#endif
+    return usage;
+}
+
+qint64 ProcessStats::processStartTime(qint64 pid)
+{
+    if (pid <= 0) {
+        return -1;
+    }
+#ifdef Q_OS_WIN
+    HANDLE process = OpenProcess(PROCESS_QUERY_LIMITED_INFORMATION, FALSE, static_cast<DWORD>(pid));
+    if (!process) {
+        return -1;
+    }
+    qint64 started = -1;
+    DWORD exitCode = 0;
+    FILETIME created, exited, kernel, user;
+    if (GetExitCodeProcess(process, &exitCode) && exitCode == STILL_ACTIVE
+        && GetProcessTimes(process, &created, &exited, &kernel, &user)) {
+        started = (qint64(created.dwHighDateTime) << 32) | created.dwLowDateTime;
+    }
+    CloseHandle(process);
+    return started;
+#else
+    QFile stat("/proc/" + QByteArray::number(pid) + "/stat");
+    if (stat.open(QIODevice::ReadOnly)) {
+        // Field 3 is the state, field 22 the start time in clock ticks since boot
+        QByteArray line = stat.readAll();
+        QList<QByteArray> fields = line.mid(line.lastIndexOf(')') + 2).split(' ');
+        if (fields.size() < 20 || fields[0] == "Z" || fields[0] == "X") {
+            return -1;   // Exited, waiting to be reaped
+        }
+        return fields[19].toLongLong();
+    }
+    // No /proc (macOS): we can only tell whether the pid is in use
+    return kill(static_cast<pid_t>(pid), 0) == 0 ? 0 : -1;
+#endif
+}
@@ -0,0 +1,39 @@
+#ifndef PROCESSSTATS_H
+#define PROCESSSTATS_H
+
+#include <QtGlobal>
+
+// What a job process used. Every figure only grows while the process
+// runs, so samples are combined by taking the larger value. -1 = unknown.
+struct RunUsage {
+    qint64 cpuMs = -1;          // User + system time
+    qint64 peakRssBytes = -1;
+    qint64 readBytes = -1;      // Storage I/O, not cache hits
+    qint64 writeBytes = -1;
+
+    bool isValid() const { return cpuMs >= 0 || peakRssBytes >= 0; }
+    void merge(const RunUsage& other) {
+        cpuMs = qMax(cpuMs, other.cpuMs);
+        peakRssBytes = qMax(peakRssBytes, other.peakRssBytes);
+        readBytes = qMax(readBytes, other.readBytes);
+        writeBytes = qMax(writeBytes, other.writeBytes);
+    }
+};
+
+// Resource figures for this process and its children, read from the OS
+class ProcessStats
+{
+public:
+    // Resident set size in bytes, or -1 where it cannot be read
+    static qint64 residentBytes();
+
+    // A running child, by process id (Linux /proc, Windows process APIs)
+    static RunUsage processUsage(qint64 pid);
+
+    // When a running process started, as a number that only means something
+    // compared with another call for the same pid; tells a process apart from
+    // a later one that reused its pid. -1 if no such process is running.
+    static qint64 processStartTime(qint64 pid);
+};
+
+#endif // PROCESSSTATS_H
@@ -0,0 +1,209 @@
+#include "runjournal.h"
+#include "processstats.h"
+#include "loopwatchdog.h"
+#include <QCoreApplication>
+#include <QDateTime>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QSaveFile>
+
+#ifdef Q_OS_WIN
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+namespace {
+const int ORPHAN_POLL_MS = 2000;
+const int COMPACT_AFTER_RECORDS = 1000;   // Rewrite even with runs open once it gets this long
+}
+
+RunJournal::RunJournal(const QString& path, QObject *parent)
+    : QObject(parent)
+    , m_file(path)
+    , m_orphanTimer(new QTimer(this))
+    , m_syncTimer(new QTimer(this))
+    , m_session(QString("%1.%2").arg(QDateTime::currentMSecsSinceEpoch()).arg(QCoreApplication::applicationPid()))
+    , m_seq(0)
+    , m_records(0)
+{
+    m_orphanTimer->setInterval(ORPHAN_POLL_MS);
+    connect(m_orphanTimer, &QTimer::timeout, this, &RunJournal::pollOrphans);
+    m_syncTimer->setSingleShot(true);
+    m_syncTimer->setInterval(0);
+    connect(m_syncTimer, &QTimer::timeout, this, &RunJournal::sync);
+
+    // Replay the previous session; a torn last line from a crash mid-write
+    // fails to parse and is skipped
+    if (m_file.open(QIODevice::ReadOnly)) {
+        QVector<QString> order;
+        while (!m_file.atEnd()) {
+            const QJsonObject record = QJsonDocument::fromJson(m_file.readLine()).object();
+            const QString runId = record["run"].toString();
+            const QString op = record["op"].toString();
+            if (runId.isEmpty()) {
+                continue;
+            }
+            if (op == "launch") {
+                OpenRun run;
+                run.runId = runId;
+                run.jobId = record["job"].toString();
+                run.launchedMs = qint64(record["at"].toDouble(-1));
+                run.previousLastRunMs = qint64(record["prevLastRun"].toDouble(-1));
+                m_open.insert(runId, run);
+                order.append(runId);
+            } else if (op == "started" && m_open.contains(runId)) {
+                m_open[runId].pid = qint64(record["pid"].toDouble());
+                m_open[runId].pidStart = qint64(record["pidStart"].toDouble(-1));
+            } else if (op == "end") {
+                m_open.remove(runId);
+            }
+        }
+        m_file.close();
+        for (const QString& runId : order) {
+            if (m_open.contains(runId)) {
+                m_recovered.append(m_open.value(runId));
+            }
+        }
+    }
+    compact();
+}
+
+QString RunJournal::launch(const QString& jobId, qint64 previousLastRunMs, qint64 nowMs)
+{
+    OpenRun run;
+    run.runId = QString("%1.%2").arg(m_session).arg(++m_seq);
+    run.jobId = jobId;
+    run.launchedMs = nowMs;
+    run.previousLastRunMs = previousLastRunMs;
+    m_open.insert(run.runId, run);
+    append(launchRecord(run));
+    return run.runId;
+}
+
+void RunJournal::started(const QString& runId, qint64 pid)
+{
+    auto it = m_open.find(runId);
+    if (it == m_open.end() || it->pid == pid) {
+        return;   // Unknown, or already recorded when the launch returned
+    }
+    it->pid = pid;
+    it->pidStart = ProcessStats::processStartTime(pid);
+    append(startedRecord(*it));
+}
+
+void RunJournal::ended(const QString& runId)
+{
+    if (!m_open.remove(runId)) {
+        return;
+    }
+    if (m_open.isEmpty() || m_records >= COMPACT_AFTER_RECORDS) {
+        compact();
+    } else {
+        QJsonObject record;
+        record["op"] = "end";
+        record["run"] = runId;
+        append(QJsonDocument(record).toJson(QJsonDocument::Compact));
+    }
+}
+
+void RunJournal::watchOrphan(const OpenRun& run)
+{
+    m_orphans.append(run);
+    if (!m_orphanTimer->isActive()) {
+        m_orphanTimer->start();
+    }
+}
+
+void RunJournal::pollOrphans()
+{
+    for (int i = m_orphans.size() - 1; i >= 0; --i) {
+        const OpenRun run = m_orphans[i];
+        // Not our child any more, so there is no exit status to collect;
+        // a changed start time means the pid now belongs to someone else
+        if (ProcessStats::processStartTime(run.pid) == run.pidStart) {
+            continue;
+        }
+        m_orphans.remove(i);
+        ended(run.runId);
+        emit orphanEnded(run.jobId, run.pid);
+    }
+    if (m_orphans.isEmpty()) {
+        m_orphanTimer->stop();
+    }
+}
+
+QByteArray RunJournal::launchRecord(const OpenRun& run)
+{
+    QJsonObject record;
+    record["op"] = "launch";
+    record["run"] = run.runId;
+    record["job"] = run.jobId;
+    record["at"] = run.launchedMs;
+    record["prevLastRun"] = run.previousLastRunMs;
+    return QJsonDocument(record).toJson(QJsonDocument::Compact);
+}
+
+QByteArray RunJournal::startedRecord(const OpenRun& run)
+{
+    QJsonObject record;
+    record["op"] = "started";
+    record["run"] = run.runId;
+    record["pid"] = run.pid;
+    record["pidStart"] = run.pidStart;
+    return QJsonDocument(record).toJson(QJsonDocument::Compact);
+}
+
+void RunJournal::append(const QByteArray& record)
+{
+    LoopWatchdog::Scope scope("RunJournal::append");
+    if (!m_file.isOpen() && !m_file.open(QIODevice::WriteOnly | QIODevice::Append)) {
+        return;
+    }
+    m_file.write(record + '\n');
+    m_file.flush();
+    ++m_records;
+    if (!m_syncTimer->isActive()) {
+        m_syncTimer->start();
+    }
+}
+
+void RunJournal::sync()
+{
+    LoopWatchdog::Scope scope("RunJournal::sync");
+    if (!m_file.isOpen()) {
+        return;
+    }
+    // One sync for all the launches and ends of this loop turn
+#ifdef Q_OS_WIN
+    _commit(m_file.handle());
+#else
+    ::fsync(m_file.handle());
+#endif
+}
+
+void RunJournal::compact()
+{
+    m_syncTimer->stop();   // Whatever is pending is rewritten below
+    m_file.close();
+    m_records = 0;
+    if (m_open.isEmpty()) {
+        m_file.open(QIODevice::WriteOnly | QIODevice::Truncate);
+        return;
+    }
+
+    // Write the open runs to a new file and swap it in, so a crash here
+    // leaves either the old journal or the new one
+    QSaveFile file(m_file.fileName());
+    if (!file.open(QIODevice::WriteOnly)) {
+        return;
+    }
+    for (const OpenRun& run : qAsConst(m_open)) {
+        file.write(launchRecord(run) + '\n');
+        if (run.pid > 0) {
+            file.write(startedRecord(run) + '\n');
+        }
+        m_records += run.pid > 0 ? 2 : 1;
+    }
+    file.commit();
+}
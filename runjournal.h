@@ -0,0 +1,69 @@
+#ifndef RUNJOURNAL_H
+#define RUNJOURNAL_H
+
+#include <QObject>
+#include <QFile>
+#include <QHash>
+#include <QTimer>
+#include <QVector>
+
+// Durable record of job processes in flight, so a run survives the app
+// dying under it. One JSON line is appended when a run is launched, when
+// its process is up (with pid and process start time) and when it ends.
+// Each line reaches the OS at once, which is all an app crash needs; the
+// sync to disk, against power loss, happens once per event loop turn for
+// everything appended in it. Runs left open by the previous session are read back on
+// construction; the file is compacted down to them whenever nothing else
+// is in flight.
+class RunJournal : public QObject
+{
+    Q_OBJECT
+
+public:
+    struct OpenRun {
+        QString runId;
+        QString jobId;
+        qint64 launchedMs = -1;
+        qint64 previousLastRunMs = -1;   // The job's lastRun before this run set it
+        qint64 pid = 0;                  // 0 if the process was never seen running
+        qint64 pidStart = -1;            // ProcessStats::processStartTime() of pid
+    };
+
+    explicit RunJournal(const QString& path, QObject *parent = nullptr);
+
+    // Runs the previous session launched but never saw end
+    QVector<OpenRun> recoveredRuns() const { return m_recovered; }
+
+    QString launch(const QString& jobId, qint64 previousLastRunMs, qint64 nowMs);
+    void started(const QString& runId, qint64 pid);   // Repeating the recorded pid is a no-op
+    void ended(const QString& runId);
+
+    // Polls a recovered run's process until it is gone, then ends the run
+    void watchOrphan(const OpenRun& run);
+    int orphanCount() const { return m_orphans.size(); }
+
+signals:
+    void orphanEnded(const QString& jobId, qint64 pid);
+
+private slots:
+    void pollOrphans();
+    void sync();
+
+private:
+    static QByteArray launchRecord(const OpenRun& run);
+    static QByteArray startedRecord(const OpenRun& run);
+    void append(const QByteArray& record);
+    void compact();
+
+    QFile m_file;
+    QHash<QString, OpenRun> m_open;   // Run id -> run without an end record
+    QVector<OpenRun> m_recovered;
+    QVector<OpenRun> m_orphans;
+    QTimer* m_orphanTimer;
+    QTimer* m_syncTimer;              // Zero-interval; pending while unsynced records exist
+    QString m_session;                // Prefix keeping run ids unique across sessions
+    qint64 m_seq;
+    int m_records;                    // Lines in the file, for deciding when to compact
+};
+
+#endif // RUNJOURNAL_H
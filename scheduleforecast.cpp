@@ -0,0 +1,200 @@
+#include "scheduleforecast.h"
+#include "scheduletable.h"
+#include <QPainter>
+#include <algorithm>
+
+QVector<ScheduleForecast::Chunk> ScheduleForecast::makeChunks(const QVector<CronJob>& jobs, const QDateTime& from,
+                                                              int days, int chunkCount, bool alignToSlots)
+{
+    // A few chunks per thread keeps the cores busy when some slices hold
+    // many more runs (short intervals) than others
+    chunkCount = qBound(1, chunkCount, qMax(1, jobs.size()));
+    QVector<Chunk> chunks;
+    chunks.reserve(chunkCount);
+    for (int i = 0; i < chunkCount; ++i) {
+        Chunk chunk;
+        chunk.jobs = &jobs;
+        chunk.begin = int(qint64(jobs.size()) * i / chunkCount);
+        chunk.end = int(qint64(jobs.size()) * (i + 1) / chunkCount);
+        chunk.fromMs = from.toMSecsSinceEpoch();
+        chunk.minutes = days * 1440;
+        chunk.alignToSlots = alignToSlots;
+        chunks.append(chunk);
+    }
+    return chunks;
+}
+
+ScheduleForecast::Partial ScheduleForecast::simulate(const Chunk& chunk)
+{
+    Partial partial;
+    partial.deltas.fill(0, chunk.minutes + 1);
+
+    // UTC keeps the date arithmetic free of time zone lookups
+    const QDateTime from = QDateTime::fromMSecsSinceEpoch(chunk.fromMs, Qt::UTC);
+    const qint64 toMs = chunk.fromMs + qint64(chunk.minutes) * 60000;
+    ScheduleTable table;
+    table.setEarlyStarts(!chunk.alignToSlots);   // As CronManager sets it
+
+    for (int i = chunk.begin; i < chunk.end; ++i) {
+        const CronJob& job = chunk.jobs->at(i);
+        if (!job.enabled || job.triggerType != CronJob::IntervalTrigger || job.intervalMinutes < 1) {
+            continue;
+        }
+
+        if (job.intervalSeconds > 0) {
+            // Runs every few seconds: busy for the whole forecast, as far as
+            // a per-minute count can tell
+            partial.deltas[0] += 1;
+            partial.deltas[chunk.minutes] -= 1;
+            partial.runs += qint64(chunk.minutes) * 60 / job.intervalSeconds;
+            continue;
+        }
+
+        CronJob sim = job;
+        sim.lastRun = sim.lastRun.toUTC();
+        sim.nextRun = sim.nextRun.isValid() ? sim.nextRun.toUTC() : from;
+        sim.pausedUntil = sim.pausedUntil.toUTC();
+        sim.retryAttempt = 0;
+        // Overdue jobs run as soon as the scheduler looks, as they would for real
+        qint64 fireMs = qMax(table.fireTime(sim), chunk.fromMs);
+        const int runMinutes = qMax(1, int((qint64(job.averageDurationMs) + 59999) / 60000));
+
+        while (fireMs < toMs) {
+            int start = int((fireMs - chunk.fromMs) / 60000);
+            partial.deltas[start] += 1;
+            partial.deltas[qMin(start + runMinutes, chunk.minutes)] -= 1;
+            ++partial.runs;
+
+            // Started at fireMs, which is ahead of nextRun for an early start
+            const QDateTime fire = from.addMSecs(fireMs - chunk.fromMs);
+            const qint64 dueMs = sim.nextRun.toMSecsSinceEpoch();
+            sim.lastRun = fire;
+            ScheduleTable::scheduleNextRun(sim, fire, dueMs > fireMs ? dueMs : -1, chunk.alignToSlots);
+            const qint64 nextFireMs = table.fireTime(sim);
+            if (nextFireMs == ScheduleTable::NEVER || nextFireMs <= fireMs) {
+                break;
+            }
+            fireMs = nextFireMs;
+        }
+    }
+    return partial;
+}
+
+void ScheduleForecast::merge(Partial& total, const Partial& part)
+{
+    if (total.deltas.isEmpty()) {
+        total = part;
+        return;
+    }
+    for (int i = 0; i < part.deltas.size(); ++i) {
+        total.deltas[i] += part.deltas[i];
+    }
+    total.runs += part.runs;
+}
+
+ScheduleForecast::Result ScheduleForecast::finish(const Partial& total, const QDateTime& from, int days)
+{
+    Result result;
+    result.from = from;
+    result.days = days;
+    result.runs = total.runs;
+
+    const int minutes = days * 1440;
+    result.concurrency.resize(minutes);
+    int running = 0;
+    for (int m = 0; m < minutes; ++m) {
+        running += total.deltas.value(m);
+        result.concurrency[m] = running;
+        if (running > result.peak) {
+            result.peak = running;
+            result.peakMinute = m;
+        }
+    }
+    return result;
+}
+
+QVector<int> ScheduleForecast::topMinutes(const Result& result, int count)
+{
+    QVector<int> hourPeaks;
+    for (int hourStart = 0; hourStart < result.concurrency.size(); hourStart += 60) {
+        int best = hourStart;
+        for (int m = hourStart; m < qMin(hourStart + 60, result.concurrency.size()); ++m) {
+            if (result.concurrency[m] > result.concurrency[best]) {
+                best = m;
+            }
+        }
+        if (result.concurrency[best] > 0) {
+            hourPeaks.append(best);
+        }
+    }
+    std::stable_sort(hourPeaks.begin(), hourPeaks.end(), [&result](int a, int b) {
+        return result.concurrency[a] > result.concurrency[b];
+    });
+    hourPeaks.resize(qMin(count, hourPeaks.size()));
+    return hourPeaks;
+}
+
+QImage ScheduleForecast::renderHeatMap(const Result& result, const QSize& size)
+{
+    QImage image(size, QImage::Format_RGB32);
+    image.fill(Qt::white);
+    if (result.concurrency.isEmpty() || size.width() < 100 || size.height() < 40) {
+        return image;
+    }
+
+    // Rows are calendar days in local time, so columns line up with the clock
+    const int leftMargin = 70;
+    const int topMargin = 16;
+    const QDate firstDay = result.from.date();
+    const int rows = firstDay.daysTo(result.from.addSecs(qint64(result.concurrency.size() - 1) * 60).date()) + 1;
+    QVector<int> grid(rows * 1440, -1);
+    const int startMinuteOfDay = result.from.time().hour() * 60 + result.from.time().minute();
+    for (int m = 0; m < result.concurrency.size(); ++m) {
+        // Minute offsets map straight onto the grid, ignoring DST shifts
+        int cell = startMinuteOfDay + m;
+        if (cell < grid.size()) {
+            grid[cell] = result.concurrency[m];
+        }
+    }
+
+    const int plotWidth = size.width() - leftMargin;
+    const int rowHeight = qMax(1, (size.height() - topMargin) / rows);
+    const double peak = qMax(1, result.peak);
+
+    QPainter painter(&image);
+    for (int row = 0; row < rows; ++row) {
+        const int y = topMargin + row * rowHeight;
+        for (int x = 0; x < plotWidth; ++x) {
+            int first = x * 1440 / plotWidth;
+            int last = qMax(first + 1, (x + 1) * 1440 / plotWidth);
+            int value = -1;
+            for (int minute = first; minute < last; ++minute) {
+                value = qMax(value, grid[row * 1440 + minute]);
+            }
+
+            QColor color;
+            if (value < 0) {
+                color = QColor(225, 225, 225);   // Outside the forecast
+            } else if (value == 0) {
+                color = QColor(250, 250, 250);
+            } else {
+                double t = value / peak;
+                color = QColor::fromHsvF((1.0 - t) * 60.0 / 360.0, 0.25 + 0.75 * t, 1.0);
+            }
+            painter.fillRect(leftMargin + x, y, 1, qMax(1, rowHeight - 1), color);
+        }
+        if (rowHeight >= 10) {
+            painter.setPen(Qt::black);
+            painter.drawText(QRect(0, y, leftMargin - 4, rowHeight), Qt::AlignRight | Qt::AlignVCenter,
+                             firstDay.addDays(row).toString("ddd MM-dd"));
+        }
+    }
+
+    painter.setPen(Qt::darkGray);
+    for (int hour = 0; hour < 24; hour += 3) {
+        int x = leftMargin + hour * plotWidth / 24;
+        painter.drawLine(x, topMargin - 3, x, topMargin);
+        painter.drawText(x + 2, topMargin - 4, QString("%1:00").arg(hour, 2, 10, QChar('0')));
+    }
+    return image;
+}
@@ -0,0 +1,56 @@
+#ifndef SCHEDULEFORECAST_H
+#define SCHEDULEFORECAST_H
+
+#include <QDateTime>
+#include <QImage>
+#include <QVector>
+#include "cronjob.h"
+
+// Replays the scheduler's next-run rule (ScheduleTable::scheduleNextRun,
+// with the early starts the scan makes for deadlines) on a simulated clock
+// to find every run of every interval job over the next few days, and
+// turns the result into a per-minute count of jobs running at once. Jobs are split into chunks that are simulated in parallel; each
+// chunk fills its own difference array, so merging is a plain sum.
+class ScheduleForecast
+{
+public:
+    // One parallel work item: a slice of the job list
+    struct Chunk {
+        const QVector<CronJob>* jobs = nullptr;
+        int begin = 0;
+        int end = 0;
+        qint64 fromMs = 0;
+        int minutes = 0;
+        bool alignToSlots = false;   // Clustered: runs snap to interval boundaries
+    };
+
+    // Starts minus ends per minute, plus the run count, for some jobs
+    struct Partial {
+        QVector<int> deltas;
+        qint64 runs = 0;
+    };
+
+    struct Result {
+        QDateTime from;
+        int days = 0;
+        QVector<int> concurrency;   // Jobs running during each minute from 'from'
+        qint64 runs = 0;
+        int peak = 0;
+        int peakMinute = -1;
+    };
+
+    static QVector<Chunk> makeChunks(const QVector<CronJob>& jobs, const QDateTime& from, int days, int chunkCount,
+                                     bool alignToSlots = false);
+    static Partial simulate(const Chunk& chunk);
+    static void merge(Partial& total, const Partial& part);
+    static Result finish(const Partial& total, const QDateTime& from, int days);
+
+    // The busiest minutes, at most one per hour so a long peak is listed once
+    static QVector<int> topMinutes(const Result& result, int count);
+
+    // Days as rows, time of day as columns; each pixel shows the busiest
+    // minute it covers, from white (idle) to red (the peak)
+    static QImage renderHeatMap(const Result& result, const QSize& size);
+};
+
+#endif // SCHEDULEFORECAST_H
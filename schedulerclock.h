@@ -0,0 +1,44 @@
+#ifndef SCHEDULERCLOCK_H
+#define SCHEDULERCLOCK_H
+
+#include <QDateTime>
+#include <atomic>
+
+// Where the scheduler gets the time. The system clock by default; a
+// VirtualClock lets a replay run the scheduler on simulated time, as fast
+// as it can and with the same result every time.
+class SchedulerClock
+{
+public:
+    virtual ~SchedulerClock() = default;
+
+    virtual qint64 nowMs() const { return QDateTime::currentMSecsSinceEpoch(); }
+    virtual QDateTime now() const { return QDateTime::currentDateTime(); }
+    virtual bool isVirtual() const { return false; }
+
+    static SchedulerClock* system()
+    {
+        static SchedulerClock clock;
+        return &clock;
+    }
+};
+
+// Time only moves when it is told to. Times are handed out in UTC, which
+// keeps date arithmetic free of time zone lookups. Set on the scheduler
+// thread; the output index reads it from its own.
+class VirtualClock : public SchedulerClock
+{
+public:
+    explicit VirtualClock(qint64 startMs = 0) : m_ms(startMs) {}
+
+    qint64 nowMs() const override { return m_ms; }
+    QDateTime now() const override { return QDateTime::fromMSecsSinceEpoch(m_ms, Qt::UTC); }
+    bool isVirtual() const override { return true; }
+
+    void setMs(qint64 ms) { m_ms = ms; }
+
+private:
+    std::atomic<qint64> m_ms;
+};
+
+#endif // SCHEDULERCLOCK_H
@@ -0,0 +1,56 @@
+#include "scheduletable.h"
+#include <algorithm>
+
+qint64 ScheduleTable::fireTime(const CronJob& job) const
+{
+    if (!job.enabled || !job.runsOnTimer() || !job.nextRun.isValid()) {
+        return NEVER;
+    }
+    const qint64 dueMs = job.nextRun.toMSecsSinceEpoch();
+    return m_earlyStarts ? dueMs - job.startLeadMs() : dueMs;
+}
+
+void ScheduleTable::scheduleNextRun(CronJob& job, const QDateTime& now, qint64 slotMs, bool alignToSlots)
+{
+    if (alignToSlots && job.triggerType == CronJob::IntervalTrigger) {
+        // Align to slot boundaries so every node agrees on the next run
+        const qint64 intervalMs = qMax<qint64>(1000, job.intervalMs());
+        const qint64 nowMs = now.toMSecsSinceEpoch();
+        job.nextRun = now.addMSecs((nowMs / intervalMs + 1) * intervalMs - nowMs);
+        return;
+    }
+    job.calculateNextRun(now);
+    if (slotMs > 0 && job.triggerType == CronJob::IntervalTrigger && job.nextRun.isValid()
+        && !job.isPaused(now)) {
+        // Started ahead of its slot; keep to the slots rather than creep earlier every run
+        job.nextRun = now.addMSecs(slotMs + job.intervalMs() - now.toMSecsSinceEpoch());
+    }
+}
+
+void ScheduleTable::rebuild(const QVector<CronJob>& jobs)
+{
+    m_nextFireMs.resize(jobs.size());
+    for (int i = 0; i < jobs.size(); ++i) {
+        m_nextFireMs[i] = fireTime(jobs[i]);
+    }
+}
+
+void ScheduleTable::collectDue(qint64 nowMs, QVector<int>& due) const
+{
+    due.clear();
+    const qint64* times = m_nextFireMs.constData();
+    const int count = m_nextFireMs.size();
+    for (int i = 0; i < count; ++i) {
+        if (times[i] <= nowMs) {
+            due.append(i);
+        }
+    }
+}
+
+qint64 ScheduleTable::earliestFireMs() const
+{
+    if (m_nextFireMs.isEmpty()) {
+        return NEVER;
+    }
+    return *std::min_element(m_nextFireMs.constBegin(), m_nextFireMs.constEnd());
+}
@@ -0,0 +1,50 @@
+#ifndef SCHEDULETABLE_H
+#define SCHEDULETABLE_H
+
+#include <QVector>
+#include <limits>
+#include "cronjob.h"
+
+// Dense copy of what the scheduler looks at on every tick: one int64
+// next-fire time (epoch ms) per job, indexed by the job's position in
+// CronManager's job list. Disabled and event-driven jobs hold NEVER, so a
+// scan is a straight pass over one array instead of a walk over whole
+// CronJob objects and their QDateTimes. The CronJob list stays the store
+// for everything else. Jobs with a deadline they are expected to miss fire
+// ahead of nextRun by their start lead, unless early starts are off.
+class ScheduleTable
+{
+public:
+    static constexpr qint64 NEVER = std::numeric_limits<qint64>::max();
+
+    ScheduleTable() : m_earlyStarts(true) {}
+
+    void setEarlyStarts(bool enabled) { m_earlyStarts = enabled; }
+    void rebuild(const QVector<CronJob>& jobs);
+    void append(const CronJob& job) { m_nextFireMs.append(fireTime(job)); }
+    void set(int handle, const CronJob& job) { m_nextFireMs[handle] = fireTime(job); }
+    // Moves the last entry into handle, as CronManager does with its jobs
+    void removeSwap(int handle) { m_nextFireMs[handle] = m_nextFireMs.last(); m_nextFireMs.removeLast(); }
+    int size() const { return m_nextFireMs.size(); }
+
+    qint64 nextFireMs(int handle) const { return m_nextFireMs[handle]; }
+    void collectDue(qint64 nowMs, QVector<int>& due) const;
+    qint64 earliestFireMs() const;
+
+    static qint64 bytesPerJob() { return sizeof(qint64); }
+
+    // When the scan will start the job: nextRun, less any start lead
+    qint64 fireTime(const CronJob& job) const;
+    // The scheduler's rule for job.nextRun once a run has started at now.
+    // slotMs is the run's due time if it started ahead of it, else -1.
+    // Cluster nodes snap to interval boundaries instead. The forecast
+    // steps jobs with the same rule.
+    static void scheduleNextRun(CronJob& job, const QDateTime& now, qint64 slotMs, bool alignToSlots);
+
+private:
+
+    QVector<qint64> m_nextFireMs;
+    bool m_earlyStarts;
+};
+
+#endif // SCHEDULETABLE_H
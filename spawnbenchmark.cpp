@@ -0,0 +1,134 @@
+#include "spawnbenchmark.h"
+#include <QStandardPaths>
+#include <algorithm>
+#include <cmath>
+
+SpawnBenchmark::SpawnBenchmark(int runs, int concurrency, QObject *parent)
+    : QObject(parent)
+    , m_runs(qBound(1, runs, 10000))
+    , m_concurrency(qBound(1, concurrency, 64))
+    , m_environment(QProcessEnvironment::systemEnvironment())
+    , m_backend(0)
+    , m_launched(0)
+    , m_ended(0)
+    , m_failures(0)
+{
+#ifdef Q_OS_WIN
+    m_program = "cmd.exe";
+    m_arguments << "/c" << "exit 0";
+#else
+    // Resolved once, so no backend pays for a PATH search
+    m_program = QStandardPaths::findExecutable("true");
+    if (m_program.isEmpty()) {
+        m_program = "/bin/true";
+    }
+#endif
+    for (JobProcess::Backend backend : {JobProcess::QProcessBackend, JobProcess::SpawnBackend}) {
+        if (JobProcess::isSupported(backend)) {
+            m_backends.append(backend);
+        }
+    }
+}
+
+void SpawnBenchmark::start()
+{
+    m_backend = 0;
+    startBackend();
+}
+
+void SpawnBenchmark::startBackend()
+{
+    if (m_backend >= m_backends.size()) {
+        QJsonObject result;
+        result["runs"] = m_runs;
+        result["concurrency"] = m_concurrency;
+        result["program"] = m_program;
+        result["default"] = JobProcess::backendName(JobProcess::defaultBackend());
+        result["backends"] = m_results;
+        emit finished(result);
+        return;
+    }
+    m_launched = 0;
+    m_ended = 0;
+    m_failures = 0;
+    m_startUs.clear();
+    m_blockedUs.clear();
+    m_startUs.reserve(m_runs);
+    m_blockedUs.reserve(m_runs);
+    m_wall.start();
+    for (int i = 0; i < m_concurrency && m_launched < m_runs; ++i) {
+        launchNext();
+    }
+}
+
+void SpawnBenchmark::launchNext()
+{
+    JobProcess* process = JobProcess::create(m_backends[m_backend], this);
+    connect(process, &JobProcess::started, this, [this, process]() {
+        auto it = m_pending.find(process);
+        if (it != m_pending.end()) {
+            m_startUs.append(it.value().nsecsElapsed() / 1000);
+            m_pending.erase(it);
+        }
+    });
+    connect(process, &JobProcess::finished, this, [this, process](int exitCode, bool crashed) {
+        runEnded(process, exitCode == 0 && !crashed);
+    });
+    connect(process, &JobProcess::failedToStart, this, [this, process]() {
+        runEnded(process, false);
+    });
+
+    ++m_launched;
+    QElapsedTimer timer;
+    timer.start();
+    m_pending.insert(process, timer);
+    process->start(m_program, m_arguments, QString(), m_environment);
+    m_blockedUs.append(timer.nsecsElapsed() / 1000);
+}
+
+void SpawnBenchmark::runEnded(JobProcess* process, bool success)
+{
+    m_pending.remove(process);
+    process->deleteLater();
+    if (!success) {
+        ++m_failures;
+    }
+    ++m_ended;
+    if (m_launched < m_runs) {
+        launchNext();
+        return;
+    }
+    if (m_ended < m_runs) {
+        return;
+    }
+
+    const qint64 wallUs = qMax<qint64>(1, m_wall.nsecsElapsed() / 1000);
+    QJsonObject result;
+    result["backend"] = JobProcess::backendName(m_backends[m_backend]);
+    result["spawnsPerSec"] = m_runs * 1e6 / wallUs;
+    result["failures"] = m_failures;
+    result["startUs"] = percentiles(m_startUs);
+    result["blockedUs"] = percentiles(m_blockedUs);
+    m_results.append(result);
+
+    ++m_backend;
+    startBackend();
+}
+
+QJsonObject SpawnBenchmark::percentiles(QVector<qint64> samplesUs)
+{
+    QJsonObject obj;
+    if (samplesUs.isEmpty()) {
+        return obj;
+    }
+    std::sort(samplesUs.begin(), samplesUs.end());
+    auto at = [&samplesUs](double p) {
+        const int rank = int(std::ceil(p * samplesUs.size())) - 1;
+        return samplesUs[qBound(0, rank, samplesUs.size() - 1)];
+    };
+    obj["p50"] = at(0.50);
+    obj["p90"] = at(0.90);
+    obj["p99"] = at(0.99);
+    obj["max"] = samplesUs.last();
+    return obj;
+}
@@ -0,0 +1,54 @@
+#ifndef SPAWNBENCHMARK_H
+#define SPAWNBENCHMARK_H
+
+#include <QObject>
+#include <QElapsedTimer>
+#include <QHash>
+#include <QJsonArray>
+#include <QJsonObject>
+#include <QProcessEnvironment>
+#include <QStringList>
+#include <QVector>
+#include "jobprocess.h"
+
+// Launches a program that exits at once (true, or cmd /c exit on Windows)
+// a number of times through each supported launcher backend, a few at a
+// time, and reports spawns per second plus the spread of start latency:
+// from the start() call to started(), and the part of it spent blocked
+// inside start(). Runs on the calling thread's event loop.
+class SpawnBenchmark : public QObject
+{
+    Q_OBJECT
+
+public:
+    SpawnBenchmark(int runs, int concurrency, QObject *parent = nullptr);
+
+    void start();
+
+signals:
+    void finished(const QJsonObject& result);
+
+private:
+    void startBackend();
+    void launchNext();
+    void runEnded(JobProcess* process, bool success);
+    static QJsonObject percentiles(QVector<qint64> samplesUs);
+
+    int m_runs;
+    int m_concurrency;
+    QString m_program;
+    QStringList m_arguments;
+    QProcessEnvironment m_environment;
+    QVector<JobProcess::Backend> m_backends;
+    int m_backend;                              // Index into m_backends
+    int m_launched;
+    int m_ended;
+    int m_failures;
+    QHash<JobProcess*, QElapsedTimer> m_pending;   // Launched, not started yet
+    QVector<qint64> m_startUs;
+    QVector<qint64> m_blockedUs;
+    QElapsedTimer m_wall;
+    QJsonArray m_results;
+};
+
+#endif // SPAWNBENCHMARK_H
@@ -0,0 +1,259 @@
+#include "tracerecorder.h"
+#include "loopwatchdog.h"
+#include <QCoreApplication>
+#include <QDateTime>
+#include <QFile>
+
+namespace {
+const int FLUSH_INTERVAL_MS = 1000;
+const int FLUSH_BYTES = 256 * 1024;
+const qint64 MAX_FILE_BYTES = 64 * 1024 * 1024;   // A trace file is rotated at this size
+const int KEEP_FILES = 3;                          // Rotated files kept next to the current one
+}
+
+// Owns the file; every call runs on the writer thread, in the order queued
+class TraceWriter : public QObject
+{
+public:
+    bool open(const QString& path, QString& error)
+    {
+        // An earlier trace under this name is rotated away, not overwritten
+        rotateFiles(path);
+        m_file.setFileName(path);
+        if (!m_file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+            error = m_file.errorString();
+            return false;
+        }
+        return true;
+    }
+
+    void write(const QByteArray& data)
+    {
+        m_file.write(data);
+        m_file.flush();
+    }
+
+    void rotate()
+    {
+        const QString path = m_file.fileName();
+        m_file.close();
+        rotateFiles(path);
+        m_file.open(QIODevice::WriteOnly | QIODevice::Truncate);
+    }
+
+private:
+    static void rotateFiles(const QString& path)
+    {
+        if (!QFile::exists(path)) {
+            return;
+        }
+        QFile::remove(QString("%1.%2").arg(path).arg(KEEP_FILES));
+        for (int i = KEEP_FILES - 1; i >= 1; --i) {
+            QFile::rename(QString("%1.%2").arg(path).arg(i), QString("%1.%2").arg(path).arg(i + 1));
+        }
+        QFile::rename(path, path + ".1");
+    }
+
+    QFile m_file;
+};
+
+TraceRecorder::TraceRecorder(QObject *parent)
+    : QObject(parent)
+    , m_writer(nullptr)
+    , m_fileBytes(0)
+    , m_flushTimer(new QTimer(this))
+    , m_baseUs(0)
+    , m_pid(QCoreApplication::applicationPid())
+{
+    m_flushTimer->setInterval(FLUSH_INTERVAL_MS);
+    connect(m_flushTimer, &QTimer::timeout, this, &TraceRecorder::flush);
+}
+
+TraceRecorder::~TraceRecorder()
+{
+    if (m_writer) {
+        // The last event carries no trailing comma, so the file is strict JSON
+        m_buffer += "{\"name\":\"trace end\",\"ph\":\"i\",\"s\":\"g\",\"pid\":" + QByteArray::number(m_pid)
+                  + ",\"tid\":0,\"ts\":" + QByteArray::number(nowUs()) + "}\n]\n";
+        flush();
+        m_writerThread.quit();   // Writes out what is queued first
+        m_writerThread.wait();
+    }
+}
+
+bool TraceRecorder::open(const QString& path)
+{
+    m_path = path;
+    TraceWriter* writer = new TraceWriter;
+    if (!writer->open(path, m_error)) {
+        delete writer;
+        return false;
+    }
+    m_writer = writer;
+    m_writer->moveToThread(&m_writerThread);
+    connect(&m_writerThread, &QThread::finished, m_writer, &QObject::deleteLater);
+    m_writerThread.setObjectName("Trace writer");
+    m_writerThread.start(QThread::LowPriority);
+
+    m_clock.start();
+    m_baseUs = QDateTime::currentMSecsSinceEpoch() * 1000;
+    appendHeader();
+    m_flushTimer->start();
+    return true;
+}
+
+void TraceRecorder::appendHeader()
+{
+    // Each file, rotated or not, names its process and tracks itself
+    m_buffer += "[\n";
+    appendEvent("M", "process_name", 0, 0,
+                ",\"args\":{\"name\":" + jsonString(QCoreApplication::applicationName()) + "}");
+    for (int slot = 0; slot < m_slotFreeSince.size(); ++slot) {
+        appendEvent("M", "thread_name", slot + 1, 0,
+                    ",\"args\":{\"name\":\"Slot " + QByteArray::number(slot + 1) + "\"}");
+        appendEvent("M", "thread_sort_index", slot + 1, 0,
+                    ",\"args\":{\"sort_index\":" + QByteArray::number(slot + 1) + "}");
+    }
+}
+
+qint64 TraceRecorder::nowUs() const
+{
+    return m_baseUs + m_clock.nsecsElapsed() / 1000;
+}
+
+int TraceRecorder::beginRun(const QString& jobId, const QString& jobName, qint64 dueMs)
+{
+    const qint64 now = nowUs();
+
+    int slot = -1;
+    for (int i = 0; i < m_slotFreeSince.size(); ++i) {
+        if (m_slotFreeSince[i] >= 0) {
+            slot = i;
+            break;
+        }
+    }
+    if (slot < 0) {
+        slot = m_slotFreeSince.size();
+        m_slotFreeSince.append(now);
+        m_slotJobs.append(QString());
+        // Track names, and tracks sorted by slot number rather than by first use
+        appendEvent("M", "thread_name", slot + 1, 0,
+                    ",\"args\":{\"name\":\"Slot " + QByteArray::number(slot + 1) + "\"}");
+        appendEvent("M", "thread_sort_index", slot + 1, 0,
+                    ",\"args\":{\"sort_index\":" + QByteArray::number(slot + 1) + "}");
+    }
+
+    const QByteArray args = ",\"args\":{\"job\":" + jsonString(jobId) + "}";
+    if (dueMs >= 0) {
+        // The wait is drawn from when the slot came free, so runs on one track don't overlap
+        qint64 dueUs = dueMs * 1000;
+        qint64 shownFromUs = qMin(now, qMax(dueUs, m_slotFreeSince[slot]));
+        appendEvent("X", "queued", slot + 1, shownFromUs,
+                    ",\"dur\":" + QByteArray::number(now - shownFromUs)
+                    + ",\"args\":{\"job\":" + jsonString(jobName) + ",\"queueDelayMs\":"
+                    + QByteArray::number(qMax<qint64>(0, now - dueUs) / 1000) + "}");
+    }
+    appendEvent("B", jobName, slot + 1, now, args);
+    appendEvent("B", "spawn", slot + 1, now);
+
+    m_slotFreeSince[slot] = -1;
+    m_slotJobs[slot] = jobName;
+    return slot;
+}
+
+void TraceRecorder::started(int slot)
+{
+    const qint64 now = nowUs();
+    appendEvent("E", "spawn", slot + 1, now);
+    appendEvent("B", "run", slot + 1, now);
+}
+
+void TraceRecorder::firstOutput(int slot)
+{
+    appendEvent("i", "first output", slot + 1, nowUs(), ",\"s\":\"t\"");
+}
+
+void TraceRecorder::finished(int slot, bool success, int exitCode)
+{
+    const qint64 now = nowUs();
+    appendEvent("E", "run", slot + 1, now,
+                ",\"args\":{\"exitCode\":" + QByteArray::number(exitCode)
+                + ",\"success\":" + (success ? "true" : "false") + "}");
+    appendEvent("E", m_slotJobs.value(slot), slot + 1, now);
+    freeSlot(slot);
+}
+
+void TraceRecorder::failedToStart(int slot, const QString& error)
+{
+    const qint64 now = nowUs();
+    appendEvent("E", "spawn", slot + 1, now, ",\"args\":{\"error\":" + jsonString(error) + "}");
+    appendEvent("E", m_slotJobs.value(slot), slot + 1, now);
+    freeSlot(slot);
+}
+
+void TraceRecorder::freeSlot(int slot)
+{
+    if (slot >= 0 && slot < m_slotFreeSince.size()) {
+        m_slotFreeSince[slot] = nowUs();
+        m_slotJobs[slot].clear();
+    }
+}
+
+void TraceRecorder::appendEvent(const char* phase, const QString& name, int slot, qint64 tsUs,
+                                const QByteArray& extra)
+{
+    if (!m_writer) {
+        return;
+    }
+    m_buffer += "{\"name\":";
+    m_buffer += jsonString(name);
+    m_buffer += ",\"ph\":\"";
+    m_buffer += phase;
+    m_buffer += "\",\"pid\":" + QByteArray::number(m_pid)
+              + ",\"tid\":" + QByteArray::number(slot)
+              + ",\"ts\":" + QByteArray::number(tsUs);
+    m_buffer += extra;
+    m_buffer += "},\n";
+    if (m_buffer.size() >= FLUSH_BYTES) {
+        flush();
+    }
+}
+
+void TraceRecorder::flush()
+{
+    LoopWatchdog::Scope scope("TraceRecorder::flush");
+    if (m_buffer.isEmpty() || !m_writer) {
+        return;
+    }
+    // The file is written on the writer thread; this only hands the block over
+    TraceWriter* writer = m_writer;
+    const QByteArray block = m_buffer;
+    m_buffer.clear();
+    QMetaObject::invokeMethod(writer, [writer, block]() { writer->write(block); }, Qt::QueuedConnection);
+
+    m_fileBytes += block.size();
+    if (m_fileBytes >= MAX_FILE_BYTES) {
+        QMetaObject::invokeMethod(writer, [writer]() { writer->rotate(); }, Qt::QueuedConnection);
+        m_fileBytes = 0;
+        appendHeader();
+    }
+}
+
+QByteArray TraceRecorder::jsonString(const QString& text)
+{
+    QByteArray out = "\"";
+    const QByteArray utf8 = text.toUtf8();
+    for (char c : utf8) {
+        if (c == '"' || c == '\\') {
+            out += '\\';
+            out += c;
+        } else if (static_cast<unsigned char>(c) < 0x20) {
+            out += "\\u00";
+            out += QByteArray::number(static_cast<unsigned char>(c), 16).rightJustified(2, '0');
+        } else {
+            out += c;
+        }
+    }
+    out += '"';
+    return out;
+}
@@ -0,0 +1,67 @@
+#ifndef TRACERECORDER_H
+#define TRACERECORDER_H
+
+#include <QObject>
+#include <QByteArray>
+#include <QElapsedTimer>
+#include <QThread>
+#include <QTimer>
+#include <QVector>
+
+class TraceWriter;
+
+// Writes job runs as Chrome trace events (JSON array format), which
+// chrome://tracing and ui.perfetto.dev open directly. Each run is drawn on
+// a concurrency slot track, so overlapping runs stack up: "queued" from the
+// due time to the launch, "spawn" until the process is up, "run" until it
+// exits, and an instant "first output" mark. Events are appended to a
+// memory buffer by the scheduler thread alone, so no locking is needed,
+// and handed to a writer thread in blocks about once a second. Once a file
+// reaches MAX_FILE_BYTES it is rotated to FILE.1 (then .2, ...) and a new
+// one is started with the track names repeated. The closing bracket is
+// optional in this format, so a trace cut short is still readable.
+class TraceRecorder : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit TraceRecorder(QObject *parent = nullptr);
+    ~TraceRecorder();
+
+    bool open(const QString& path);
+    QString fileName() const { return m_path; }
+    QString errorString() const { return m_error; }
+
+    // Returns the slot the run is drawn on; pass it to the calls below.
+    // dueMs is when the run fell due (epoch ms), or -1 if it wasn't scheduled.
+    int beginRun(const QString& jobId, const QString& jobName, qint64 dueMs);
+    void started(int slot);
+    void firstOutput(int slot);
+    void finished(int slot, bool success, int exitCode);
+    void failedToStart(int slot, const QString& error);
+
+    void flush();
+
+private:
+    qint64 nowUs() const;
+    void appendHeader();
+    void appendEvent(const char* phase, const QString& name, int slot, qint64 tsUs,
+                     const QByteArray& extra = QByteArray());
+    void freeSlot(int slot);
+    static QByteArray jsonString(const QString& text);
+
+    QString m_path;
+    QString m_error;
+    TraceWriter* m_writer;            // Lives on m_writerThread; null until open() succeeds
+    QThread m_writerThread;
+    qint64 m_fileBytes;               // Handed to the writer for the current file
+    QByteArray m_buffer;
+    QTimer* m_flushTimer;
+    QElapsedTimer m_clock;
+    qint64 m_baseUs;                  // Epoch time of m_clock's start, in microseconds
+    qint64 m_pid;
+    QVector<qint64> m_slotFreeSince;  // Per slot: when it became free (us), or -1 while busy
+    QVector<QString> m_slotJobs;      // Per slot: name of the job running on it
+};
+
+#endif // TRACERECORDER_H
@@ -0,0 +1,138 @@
+#include "traynotifier.h"
+
+namespace {
+const int MIN_GAP_MS = 4000;         // At most one bubble per this period
+const int MAX_LISTED_NAMES = 3;
+}
+
+TrayNotifier::TrayNotifier(QSystemTrayIcon* trayIcon, QObject *parent)
+    : QObject(parent)
+    , m_trayIcon(trayIcon)
+    , m_summaryTimer(new QTimer(this))
+    , m_rateTimer(new QTimer(this))
+    , m_summaryInterval(10)
+    , m_completed(0)
+    , m_failed(0)
+{
+    m_summaryTimer->setSingleShot(true);
+    m_rateTimer->setSingleShot(true);
+    connect(m_summaryTimer, &QTimer::timeout, this, &TrayNotifier::flushSummary);
+    connect(m_rateTimer, &QTimer::timeout, this, &TrayNotifier::flushPending);
+}
+
+void TrayNotifier::setSummaryInterval(int seconds)
+{
+    m_summaryInterval = seconds;
+    if (m_summaryTimer->isActive()) {
+        m_summaryTimer->stop();
+        flushSummary();
+    }
+}
+
+void TrayNotifier::jobFinished(const QString& jobName, bool success, const QString& detail, bool immediate)
+{
+    Message message;
+    message.title = success ? "Job Completed" : "Job Failed";
+    message.text = QString("%1: %2").arg(jobName, detail);
+    message.icon = success ? QSystemTrayIcon::Information : QSystemTrayIcon::Warning;
+    message.timeoutMs = 3000;
+
+    if (immediate) {
+        showMessage(message.title, message.text, message.icon, message.timeoutMs);
+        return;
+    }
+    if (m_summaryInterval < 0) {
+        return;
+    }
+
+    ++m_completed;
+    if (!success) {
+        ++m_failed;
+        if (m_failedNames.size() < MAX_LISTED_NAMES) {
+            m_failedNames.append(jobName);
+        }
+    }
+    m_lastCompletion = message;
+
+    if (m_summaryInterval == 0) {
+        flushSummary();
+    } else if (!m_summaryTimer->isActive()) {
+        m_summaryTimer->start(m_summaryInterval * 1000);
+    }
+}
+
+void TrayNotifier::flushSummary()
+{
+    if (m_completed == 0) {
+        return;
+    }
+
+    if (m_completed == 1) {
+        showMessage(m_lastCompletion.title, m_lastCompletion.text, m_lastCompletion.icon, m_lastCompletion.timeoutMs);
+    } else {
+        QString title = QString("%1 jobs completed").arg(m_completed);
+        QString text;
+        if (m_failed > 0) {
+            title += QString(", %1 failed").arg(m_failed);
+            text = "Failed: " + m_failedNames.join(", ");
+            if (m_failed > m_failedNames.size()) {
+                text += QString(" and %1 more").arg(m_failed - m_failedNames.size());
+            }
+        } else {
+            text = "All succeeded";
+        }
+        showMessage(title, text, m_failed > 0 ? QSystemTrayIcon::Warning : QSystemTrayIcon::Information);
+    }
+
+    m_completed = 0;
+    m_failed = 0;
+    m_failedNames.clear();
+}
+
+void TrayNotifier::showMessage(const QString& title, const QString& text,
+                               QSystemTrayIcon::MessageIcon icon, int timeoutMs)
+{
+    m_pending.append({title, text, icon, timeoutMs});
+    if (m_rateTimer->isActive()) {
+        return;
+    }
+
+    qint64 sinceLast = m_sinceLastShown.isValid() ? m_sinceLastShown.elapsed() : MIN_GAP_MS;
+    if (sinceLast >= MIN_GAP_MS) {
+        flushPending();
+    } else {
+        m_rateTimer->start(static_cast<int>(MIN_GAP_MS - sinceLast));
+    }
+}
+
+void TrayNotifier::flushPending()
+{
+    if (m_pending.isEmpty()) {
+        return;
+    }
+
+    // Everything that queued up during the gap goes out as one bubble
+    Message message = m_pending.first();
+    if (m_pending.size() > 1) {
+        QStringList lines;
+        message.icon = QSystemTrayIcon::Information;
+        for (const Message& pending : m_pending) {
+            if (lines.size() < MAX_LISTED_NAMES) {
+                lines.append(pending.title + " - " + pending.text);
+            }
+            if (pending.icon == QSystemTrayIcon::Warning || pending.icon == QSystemTrayIcon::Critical) {
+                message.icon = QSystemTrayIcon::Warning;
+            }
+        }
+        if (m_pending.size() > lines.size()) {
+            lines.append(QString("...and %1 more").arg(m_pending.size() - lines.size()));
+        }
+        message.title = QString("%1 notifications").arg(m_pending.size());
+        message.text = lines.join("\n");
+        message.timeoutMs = 5000;
+    }
+    m_pending.clear();
+
+    m_trayIcon->showMessage(message.title, message.text, message.icon, message.timeoutMs);
+    m_sinceLastShown.start();
+}
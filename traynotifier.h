@@ -0,0 +1,57 @@
+#ifndef TRAYNOTIFIER_H
+#define TRAYNOTIFIER_H
+
+#include <QObject>
+#include <QSystemTrayIcon>
+#include <QTimer>
+#include <QElapsedTimer>
+#include <QStringList>
+#include <QVector>
+
+// Sits between the window and the tray icon so that busy schedules don't
+// flood the desktop notification service. Job completions are summed up
+// over a window ("37 jobs completed, 2 failed"); jobs marked for immediate
+// alerts skip the summary. Every bubble, summary or not, is rate limited.
+class TrayNotifier : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit TrayNotifier(QSystemTrayIcon* trayIcon, QObject *parent = nullptr);
+
+    // Seconds to collect completions for; 0 reports each one, -1 none at all
+    void setSummaryInterval(int seconds);
+    int summaryInterval() const { return m_summaryInterval; }
+
+    void jobFinished(const QString& jobName, bool success, const QString& detail, bool immediate);
+    void showMessage(const QString& title, const QString& text,
+                     QSystemTrayIcon::MessageIcon icon = QSystemTrayIcon::Information, int timeoutMs = 3000);
+
+private slots:
+    void flushSummary();
+    void flushPending();
+
+private:
+    struct Message {
+        QString title;
+        QString text;
+        QSystemTrayIcon::MessageIcon icon;
+        int timeoutMs;
+    };
+
+    QSystemTrayIcon* m_trayIcon;
+    QTimer* m_summaryTimer;
+    QTimer* m_rateTimer;
+    int m_summaryInterval;
+
+    // Current summary window
+    int m_completed;
+    int m_failed;
+    QStringList m_failedNames;
+    Message m_lastCompletion;      // Shown as is when it is the only one
+
+    QVector<Message> m_pending;    // Held back by the rate limit
+    QElapsedTimer m_sinceLastShown;
+};
+
+#endif // TRAYNOTIFIER_H